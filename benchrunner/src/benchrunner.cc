@@ -0,0 +1,29 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include "util/logger.h"
+
+namespace {
+
+// Benchmarks measure hot paths, so keep logging quiet unless something goes wrong
+const char* kLogConfig =
+    R"(
+log4cplus.appender.STDOUT=log4cplus::ConsoleAppender
+log4cplus.appender.STDOUT.layout=log4cplus::PatternLayout
+log4cplus.appender.STDOUT.layout.ConversionPattern=%D{%H:%M:%S,%q} [%t]%x[%5p][%c]: %m [%l]%n
+log4cplus.rootLogger=ERROR, STDOUT
+)";
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::stringstream log_config(kLogConfig);
+  INIT_LOGGER(log_config);
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
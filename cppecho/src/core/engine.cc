@@ -1,7 +1,9 @@
 // Copyright [2018] <Malinovsky Rodion>
 
 #include "core/engine.h"
+#include <algorithm>
 #include <cassert>
+#include <thread>
 #include <utility>
 
 #include "core/async.h"
@@ -9,18 +11,25 @@
 #include "core/iengine_config.h"
 #include "core/sequential_scheduler.h"
 #include "net/alias.h"
+#include "net/metrics_server.h"
 #include "net/tcp_server.h"
+#include "util/metrics.h"
 
 using rms::net::BufferType;
+using rms::net::MetricsServer;
 using rms::net::TcpServer;
 using rms::net::TcpServerIdType;
 
 namespace {
 
-const int MAX_CONNECTIONS_COUNT = 100;
 const char SERVER_ECHO_PREFIX[] = "echo: ";
 const char main_sequential_scheduler_name[] = "main_sequential";
 
+// Sequential scheduler per core, clients are processed in parallel while every client stays ordered
+std::size_t GetConnectionSchedulerCount() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
 }  // namespace
 
 rms::core::Engine::Engine(std::unique_ptr<core::IEngineConfig> engine_config)
@@ -47,7 +56,9 @@ bool rms::core::Engine::Start() {
 
   RunAsync(
       [&]() {
-        tcp_server_ = std::make_unique<TcpServer>(MAX_CONNECTIONS_COUNT);
+        tcp_server_ = std::make_unique<TcpServer>(engine_config_->GetMaxConnections());
+        // Server lifetime stays on main sequential scheduler, clients are not funneled through it
+        tcp_server_->SetConnectionSchedulerCount(GetConnectionSchedulerCount());
 
         tcp_server_->SubscribeOnListening([&]() {
           LOG_INFO("Listenig on " << engine_config_->GetServerAddress() << ":" << engine_config_->GetServerPort());
@@ -61,10 +72,9 @@ bool rms::core::Engine::Start() {
 
         tcp_server_->SubscribeOnData([&](TcpServerIdType id, const BufferType& data) {
           LOG_DEBUG("Received data: " << data);
-          BufferType snd_buffer{SERVER_ECHO_PREFIX};
-          snd_buffer += data;
-          LOG_DEBUG("Sending data: " << snd_buffer);
-          tcp_server_->Write(id, snd_buffer);
+          LOG_DEBUG("Sending data: " << SERVER_ECHO_PREFIX << data);
+          // Prefix and payload go out in one gathered write, nothing is copied
+          tcp_server_->Write(id, {SERVER_ECHO_PREFIX, data});
         });
 
         tcp_server_->SubscribeOnDisconnected([&](TcpServerIdType id) {
@@ -78,6 +88,11 @@ bool rms::core::Engine::Start() {
         });
 
         tcp_server_->Start(engine_config_->GetServerAddress(), engine_config_->GetServerPort());
+
+        if (engine_config_->GetMetricsPort() != 0u) {
+          metrics_server_ = std::make_unique<MetricsServer>(rms::util::GetMetricsRegistryInstance());
+          metrics_server_->Start(engine_config_->GetServerAddress(), engine_config_->GetMetricsPort());
+        }
       },
       *main_sequential_scheduler_);
 
@@ -97,7 +112,14 @@ bool rms::core::Engine::Stop() {
 
   stopped_ = true;
 
-  RunAsync([&]() { tcp_server_->Stop(); }, *main_sequential_scheduler_);
+  RunAsync(
+      [&]() {
+        if (metrics_server_) {
+          metrics_server_->Stop();
+        }
+        tcp_server_->Stop();
+      },
+      *main_sequential_scheduler_);
 
   return true;
 }
@@ -110,6 +132,20 @@ bool rms::core::Engine::Init() {
   return initiated_;
 }
 
+void rms::core::Engine::SetMaxConnections(std::size_t max_connections) {
+  LOG_AUTO_TRACE();
+  // Serialized with Start, so the limit is not lost if server is being created
+  RunAsync(
+      [&, max_connections]() {
+        LOG_INFO("Max connections: " << max_connections);
+        engine_config_->SetMaxConnections(max_connections);
+        if (tcp_server_) {
+          tcp_server_->SetMaxConnections(max_connections);
+        }
+      },
+      *main_sequential_scheduler_);
+}
+
 boost::signals2::connection rms::core::Engine::SubscribeOnStarted(const OnStartedSubsriberType& subscriber) {
   LOG_AUTO_TRACE();
   return on_started_.connect(subscriber);
@@ -20,6 +20,7 @@ class SequentialScheduler;
 namespace rms {
 namespace net {
 
+class MetricsServer;
 class TcpServer;
 
 }  // namespace net
@@ -65,6 +66,12 @@ class Engine : public IEngine {
    */
   bool Init() override;
 
+  /**
+   * Change limit of client connections. Non-blocking, applied asynchronously.
+   * @param max_connections Maximum count of connected clients.
+   */
+  void SetMaxConnections(std::size_t max_connections) override;
+
   /**
    * Subscribe for event when Engine has been stated and become fully operable.
    * @param subscriber Observer to trigger when event occurs.
@@ -90,6 +97,8 @@ class Engine : public IEngine {
 
   std::unique_ptr<net::TcpServer> tcp_server_;
 
+  std::unique_ptr<net::MetricsServer> metrics_server_;
+
   std::atomic_bool stopped_{false};
 
   OnStartedType on_started_;
@@ -6,10 +6,15 @@ namespace {
 
 const char* const kDefaultListenAddress = "0.0.0.0";
 const rms::core::PortType kDefaultListenPort = 8088u;
+// Connection slots are allocated on demand, so the default limit costs nothing until clients connect
+const std::size_t kDefaultMaxConnections = 10000u;
 
 }  // namespace
 
-rms::core::EngineConfig::EngineConfig() : server_address_(kDefaultListenAddress), server_port_(kDefaultListenPort) {}
+rms::core::EngineConfig::EngineConfig()
+    : server_address_(kDefaultListenAddress)
+    , server_port_(kDefaultListenPort)
+    , max_connections_(kDefaultMaxConnections) {}
 
 const std::string& rms::core::EngineConfig::GetServerAddress() const {
   return server_address_;
@@ -26,3 +31,19 @@ void rms::core::EngineConfig::SetServerAddress(const std::string& value) {
 void rms::core::EngineConfig::SetServerPort(PortType value) {
   server_port_ = value;
 }
+
+std::size_t rms::core::EngineConfig::GetMaxConnections() const {
+  return max_connections_;
+}
+
+void rms::core::EngineConfig::SetMaxConnections(std::size_t value) {
+  max_connections_ = value;
+}
+
+rms::core::PortType rms::core::EngineConfig::GetMetricsPort() const {
+  return metrics_port_;
+}
+
+void rms::core::EngineConfig::SetMetricsPort(PortType value) {
+  metrics_port_ = value;
+}
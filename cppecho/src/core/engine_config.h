@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include "core/alias.h"
 #include "core/iengine_config.h"
@@ -43,10 +44,38 @@ class EngineConfig : public IEngineConfig {
    */
   void SetServerPort(PortType value) override;
 
+  /**
+   * Get limit of client connections stored in configuration.
+   * @return Maximum count of connected clients.
+   */
+  std::size_t GetMaxConnections() const override;
+
+  /**
+   * Set limit of client connections for configuration.
+   * @param value Maximum count of connected clients.
+   */
+  void SetMaxConnections(std::size_t value) override;
+
+  /**
+   * Get port of the metrics endpoint stored in configuration.
+   * @return Port, 0 if metrics are not exposed.
+   */
+  PortType GetMetricsPort() const override;
+
+  /**
+   * Set port of the metrics endpoint for configuration.
+   * @param value Port, 0 to not expose metrics.
+   */
+  void SetMetricsPort(PortType value) override;
+
  private:
   std::string server_address_;
 
   PortType server_port_ = 0u;
+
+  std::size_t max_connections_ = 0u;
+
+  PortType metrics_port_ = 0u;
 };
 
 }  // namespace core
@@ -4,6 +4,7 @@
 #include <boost/asio/signal_set.hpp>
 #include <boost/system/error_code.hpp>
 #include <csignal>
+#include <functional>
 #include <iostream>
 #include <thread>
 #include <utility>
@@ -13,6 +14,7 @@
 #include "core/engine_config.h"
 #include "core/general_error.h"
 #include "core/iioservice.h"
+#include "core/scheduler_stats.h"
 #include "core/startup_config.h"
 #include "core/version.h"
 #include "net/util.h"
@@ -27,6 +29,8 @@ rms::core::EngineLauncher::EngineLauncher(std::unique_ptr<StartupConfig> startup
 std::error_code rms::core::EngineLauncher::Init() {
   LOG_AUTO_TRACE();
 
+  SchedulerStats::SetIsEnabled(startup_config_->GetIsSchedulerStatsEnabled());
+
   const auto hardware_threads_count = std::thread::hardware_concurrency();
   const int thread_pool_size = hardware_threads_count >= 2 ? hardware_threads_count : 2;
 
@@ -45,6 +49,12 @@ std::error_code rms::core::EngineLauncher::Init() {
   if (startup_config_->GetPort() != 0) {
     engine_config->SetServerPort(startup_config_->GetPort());
   }
+  if (startup_config_->GetMaxConnections() != 0) {
+    engine_config->SetMaxConnections(startup_config_->GetMaxConnections());
+  }
+  if (startup_config_->GetMetricsPort() != 0) {
+    engine_config->SetMetricsPort(startup_config_->GetMetricsPort());
+  }
 
   engine_ = std::make_unique<Engine>(std::move(engine_config));
 
@@ -85,12 +95,36 @@ std::error_code rms::core::EngineLauncher::DoRun() {
     }
   });
 
+  // Reload of config file, re-armed after every signal
+  boost::asio::signal_set reload_signals(asio_service, SIGHUP);
+  std::function<void(const boost::system::error_code&, int)> on_reload_signal =
+      [&](const boost::system::error_code& error, int signal_number) {
+        if (error) {
+          return;
+        }
+        LOG_INFO("Reload request received: " << signal_number);
+        Reload();
+        reload_signals.async_wait(on_reload_signal);
+      };
+  reload_signals.async_wait(on_reload_signal);
+
   LOG_INFO("Waiting for termination request");
   WaitAll();
 
   return {};
 }
 
+void rms::core::EngineLauncher::Reload() {
+  LOG_AUTO_TRACE();
+  if (!startup_config_->Reload()) {
+    LOG_ERROR("Failed to reload configuration. Keeping current one");
+    return;
+  }
+  if (startup_config_->GetMaxConnections() != 0) {
+    engine_->SetMaxConnections(startup_config_->GetMaxConnections());
+  }
+}
+
 std::error_code rms::core::EngineLauncher::Run() {
   LOG_AUTO_TRACE();
 
@@ -43,6 +43,8 @@ class EngineLauncher {
 
   std::error_code DoRun();
 
+  void Reload();
+
   std::unique_ptr<StartupConfig> startup_config_;
 
   std::unique_ptr<IEngine> engine_;
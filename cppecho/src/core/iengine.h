@@ -3,6 +3,7 @@
 #pragma once
 
 #include <boost/signals2.hpp>
+#include <cstddef>
 
 namespace rms {
 namespace core {
@@ -35,6 +36,13 @@ class IEngine {
    */
   virtual bool Init() = 0;
 
+  /**
+   * Change limit of client connections. Can be called while Engine is running. Connected clients over the lowered
+   * limit are kept, new ones are refused until count drops below it.
+   * @param max_connections Maximum count of connected clients.
+   */
+  virtual void SetMaxConnections(std::size_t max_connections) = 0;
+
   using OnStartedType = boost::signals2::signal<void()>;
   using OnStartedSubsriberType = OnStartedType::slot_type;
   /**
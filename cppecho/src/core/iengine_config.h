@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include "core/alias.h"
 
@@ -41,6 +42,30 @@ class IEngineConfig {
    * @param value Port.
    */
   virtual void SetServerPort(PortType value) = 0;
+
+  /**
+   * Get limit of client connections.
+   * @return Maximum count of connected clients.
+   */
+  virtual std::size_t GetMaxConnections() const = 0;
+
+  /**
+   * Set limit of client connections.
+   * @param value Maximum count of connected clients.
+   */
+  virtual void SetMaxConnections(std::size_t value) = 0;
+
+  /**
+   * Get port of the metrics endpoint.
+   * @return Port, 0 if metrics are not exposed.
+   */
+  virtual PortType GetMetricsPort() const = 0;
+
+  /**
+   * Set port of the metrics endpoint.
+   * @param value Port, 0 to not expose metrics.
+   */
+  virtual void SetMetricsPort(PortType value) = 0;
 };
 
 }  // namespace core
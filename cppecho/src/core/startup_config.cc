@@ -4,25 +4,78 @@
 #include <boost/cstdint.hpp>
 #include <boost/program_options.hpp>
 #include <exception>
+#include <fstream>
 #include <iostream>
+#include <utility>
+
+namespace {
+
+namespace po = boost::program_options;
+
+/**
+ * Options allowed both on command line and in config file.
+ */
+po::options_description MakeServerOptions() {
+  po::options_description desc("Server");
+  desc.add_options()("address,a", po::value<std::string>(), "Set listen address")(
+      "port,p", po::value<std::uint32_t>(), "Set listen port")(
+      "max-connections,m", po::value<std::size_t>(), "Set limit of client connections, reloaded on SIGHUP")(
+      "metrics-port", po::value<std::uint32_t>(), "Expose metrics over HTTP on this port at /metrics")(
+      "scheduler-stats", po::bool_switch(), "Record queue wait and run time of tasks of schedulers to metrics");
+  return desc;
+}
+
+}  // namespace
 
 bool rms::core::StartupConfig::Parse(int argc, char** argv) {
-  namespace po = boost::program_options;
+  arguments_.clear();
+  for (int i = 1; i < argc; ++i) {
+    arguments_.emplace_back(argv[i]);
+  }
+  return ParseArguments();
+}
+
+bool rms::core::StartupConfig::Reload() {
+  StartupConfig reloaded;
+  reloaded.arguments_ = arguments_;
+  if (!reloaded.ParseArguments()) {
+    return false;
+  }
+  *this = std::move(reloaded);
+  return true;
+}
 
+bool rms::core::StartupConfig::ParseArguments() {
   is_show_help_ = false;
   is_show_version_ = false;
   address_ = "";
   port_ = 0u;
+  max_connections_ = 0u;
+  metrics_port_ = 0u;
+  is_scheduler_stats_enabled_ = false;
+  config_path_.clear();
 
   help_.clear();
   po::options_description desc("Options");
 
   try {
+    const auto server_options = MakeServerOptions();
     desc.add_options()("help,h", "Print help")("version,v", "Print version")(
-        "address,a", po::value<std::string>(), "Set listen address")(
-        "port,p", po::value<std::uint32_t>(), "Set listen port");
+        "config,c", po::value<std::string>(), "Read server options from config file");
+    desc.add(server_options);
     po::variables_map vm;
-    po::store(po::parse_command_line(argc, argv, desc), vm);
+    // Values stored first take precedence, so command line overrides config file
+    po::store(po::command_line_parser(arguments_).options(desc).run(), vm);
+
+    if (vm.count("config") != 0u) {
+      config_path_ = vm["config"].as<std::string>();
+      std::ifstream config_file(config_path_);
+      if (!config_file) {
+        std::cerr << "Failed to open config file: " << config_path_ << std::endl;
+        return false;
+      }
+      po::store(po::parse_config_file(config_file, server_options), vm);
+    }
     po::notify(vm);
 
     std::stringstream desc_sstream;
@@ -49,6 +102,20 @@ bool rms::core::StartupConfig::Parse(int argc, char** argv) {
     if (vm.count("port") != 0u) {
       port_ = vm["port"].as<std::uint32_t>();
     }
+
+    if (vm.count("max-connections") != 0u) {
+      max_connections_ = vm["max-connections"].as<std::size_t>();
+      if (max_connections_ == 0u) {
+        std::cerr << "Max connections must be positive" << std::endl;
+        return false;
+      }
+    }
+
+    if (vm.count("metrics-port") != 0u) {
+      metrics_port_ = vm["metrics-port"].as<std::uint32_t>();
+    }
+
+    is_scheduler_stats_enabled_ = vm["scheduler-stats"].as<bool>();
   } catch (std::exception const& e) {
     std::cerr << "Failed to parse command line options: " << e.what() << std::endl;
     std::cerr << "Pass --help to get more information" << std::endl;
@@ -73,6 +140,22 @@ std::uint32_t rms::core::StartupConfig::GetPort() const {
   return port_;
 }
 
+std::size_t rms::core::StartupConfig::GetMaxConnections() const {
+  return max_connections_;
+}
+
+std::uint32_t rms::core::StartupConfig::GetMetricsPort() const {
+  return metrics_port_;
+}
+
+bool rms::core::StartupConfig::GetIsSchedulerStatsEnabled() const {
+  return is_scheduler_stats_enabled_;
+}
+
+const std::string& rms::core::StartupConfig::GetConfigPath() const {
+  return config_path_;
+}
+
 const std::string& rms::core::StartupConfig::GetHelp() const {
   return help_;
 }
@@ -3,13 +3,16 @@
 #pragma once
 
 #include <stdint.h>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace rms {
 namespace core {
 
 /**
- * Command line parameters parser.
+ * Command line parameters parser. Server parameters can also be read from config file, parameters passed on command
+ * line take precedence over the file.
  */
 class StartupConfig {
  public:
@@ -21,6 +24,12 @@ class StartupConfig {
    */
   bool Parse(int argc, char** argv);
 
+  /**
+   * Parse command line parameters passed to Parse and config file again. Keeps previous values on failure.
+   * @return True if parsed, False otherwise.
+   */
+  bool Reload();
+
   /**
    * Get parsed "ShowHelp" parameter.
    * @return True if show help was requested. False otherwise.
@@ -45,6 +54,30 @@ class StartupConfig {
    */
   std::uint32_t GetPort() const;
 
+  /**
+   * Get parsed "Max Connections" parameter.
+   * @return Limit of client connections, 0 if not set.
+   */
+  std::size_t GetMaxConnections() const;
+
+  /**
+   * Get parsed "Metrics Port" parameter.
+   * @return Port of the metrics endpoint, 0 if not set.
+   */
+  std::uint32_t GetMetricsPort() const;
+
+  /**
+   * Get parsed "Scheduler Stats" parameter.
+   * @return True if queue wait and run time of tasks should be recorded.
+   */
+  bool GetIsSchedulerStatsEnabled() const;
+
+  /**
+   * Get parsed "Config" parameter.
+   * @return Path to config file, empty if not set.
+   */
+  const std::string& GetConfigPath() const;
+
   /**
    * Get help string with description of command line parameters.
    * @return Help string.
@@ -52,6 +85,10 @@ class StartupConfig {
   const std::string& GetHelp() const;
 
  private:
+  bool ParseArguments();
+
+  std::vector<std::string> arguments_;
+
   bool is_show_help_ = false;
 
   bool is_show_version_ = false;
@@ -60,6 +97,14 @@ class StartupConfig {
 
   std::uint32_t port_ = 0u;
 
+  std::size_t max_connections_ = 0u;
+
+  std::uint32_t metrics_port_ = 0u;
+
+  bool is_scheduler_stats_enabled_ = false;
+
+  std::string config_path_;
+
   std::string help_;
 };
 
@@ -0,0 +1,120 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "loadgen/load_config.h"
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+namespace po = boost::program_options;
+
+const char kDefaultAddress[] = "127.0.0.1";
+
+const std::uint32_t kDefaultPort = 8088u;
+
+const std::size_t kDefaultConnectionCount = 100u;
+
+const std::size_t kDefaultMessageSize = 64u;
+
+const std::size_t kDefaultPipelineDepth = 1u;
+
+const int kDefaultDurationSec = 10;
+
+}  // namespace
+
+bool rms::loadgen::LoadConfig::Parse(int argc, char** argv) {
+  help_.clear();
+  po::options_description desc("Options");
+
+  try {
+    const auto default_thread_count = static_cast<std::size_t>(std::max(1u, std::thread::hardware_concurrency()));
+    desc.add_options()("help,h", "Print help")(
+        "address,a", po::value<std::string>()->default_value(kDefaultAddress), "Set server address")(
+        "port,p", po::value<std::uint32_t>()->default_value(kDefaultPort), "Set server port")(
+        "connections,c", po::value<std::size_t>()->default_value(kDefaultConnectionCount),
+        "Set count of concurrent connections")(
+        "message-size,s", po::value<std::size_t>()->default_value(kDefaultMessageSize),
+        "Set size of a message in bytes, including trailing newline")(
+        "pipeline,d", po::value<std::size_t>()->default_value(kDefaultPipelineDepth),
+        "Set max count of messages in flight per connection")(
+        "rate,r", po::value<double>()->default_value(0.0),
+        "Set total messages per second (open loop), 0 sends next message on reply (closed loop)")(
+        "duration,t", po::value<int>()->default_value(kDefaultDurationSec), "Set duration of the test in seconds")(
+        "threads,j", po::value<std::size_t>()->default_value(default_thread_count), "Set count of worker threads");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    std::stringstream desc_sstream;
+    desc_sstream << desc << std::endl;
+    help_ = desc_sstream.str();
+
+    is_show_help_ = vm.count("help") != 0u;
+    address_ = vm["address"].as<std::string>();
+    port_ = vm["port"].as<std::uint32_t>();
+    connection_count_ = vm["connections"].as<std::size_t>();
+    message_size_ = vm["message-size"].as<std::size_t>();
+    pipeline_depth_ = vm["pipeline"].as<std::size_t>();
+    rate_ = vm["rate"].as<double>();
+    duration_ = std::chrono::seconds(vm["duration"].as<int>());
+    thread_count_ = vm["threads"].as<std::size_t>();
+
+    if (connection_count_ == 0u || message_size_ == 0u || pipeline_depth_ == 0u || thread_count_ == 0u) {
+      std::cerr << "Connections, message size, pipeline and threads must be positive" << std::endl;
+      return false;
+    }
+    if (rate_ < 0.0 || duration_.count() <= 0) {
+      std::cerr << "Rate must not be negative, duration must be positive" << std::endl;
+      return false;
+    }
+  } catch (std::exception const& e) {
+    std::cerr << "Failed to parse command line options: " << e.what() << std::endl;
+    std::cerr << "Pass --help to get more information" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool rms::loadgen::LoadConfig::GetIsShowHelp() const {
+  return is_show_help_;
+}
+
+const std::string& rms::loadgen::LoadConfig::GetAddress() const {
+  return address_;
+}
+
+std::uint32_t rms::loadgen::LoadConfig::GetPort() const {
+  return port_;
+}
+
+std::size_t rms::loadgen::LoadConfig::GetConnectionCount() const {
+  return connection_count_;
+}
+
+std::size_t rms::loadgen::LoadConfig::GetMessageSize() const {
+  return message_size_;
+}
+
+std::size_t rms::loadgen::LoadConfig::GetPipelineDepth() const {
+  return pipeline_depth_;
+}
+
+double rms::loadgen::LoadConfig::GetRate() const {
+  return rate_;
+}
+
+std::chrono::seconds rms::loadgen::LoadConfig::GetDuration() const {
+  return duration_;
+}
+
+std::size_t rms::loadgen::LoadConfig::GetThreadCount() const {
+  return thread_count_;
+}
+
+const std::string& rms::loadgen::LoadConfig::GetHelp() const {
+  return help_;
+}
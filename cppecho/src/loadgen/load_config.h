@@ -0,0 +1,109 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rms {
+namespace loadgen {
+
+/**
+ * Command line parameters of the load generator.
+ */
+class LoadConfig {
+ public:
+  /**
+   * Parse specified command line parameters.
+   * @param argc Count command line of parameters.
+   * @param argv Command line parameters.
+   * @return True if parsed, False otherwise.
+   */
+  bool Parse(int argc, char** argv);
+
+  /**
+   * Get parsed "ShowHelp" parameter.
+   * @return True if show help was requested. False otherwise.
+   */
+  bool GetIsShowHelp() const;
+
+  /**
+   * Get address of the server.
+   * @return Server address string.
+   */
+  const std::string& GetAddress() const;
+
+  /**
+   * Get port of the server.
+   * @return Server port.
+   */
+  std::uint32_t GetPort() const;
+
+  /**
+   * Get count of concurrent connections.
+   * @return Count of connections.
+   */
+  std::size_t GetConnectionCount() const;
+
+  /**
+   * Get size of a message including the trailing newline.
+   * @return Message size in bytes.
+   */
+  std::size_t GetMessageSize() const;
+
+  /**
+   * Get max count of messages sent by a connection without waiting for their replies.
+   * @return Pipeline depth.
+   */
+  std::size_t GetPipelineDepth() const;
+
+  /**
+   * Get total rate of messages of all connections.
+   * @return Messages per second, 0 for closed loop where next message is sent as soon as a reply is received.
+   */
+  double GetRate() const;
+
+  /**
+   * Get duration of the measurement.
+   * @return Duration.
+   */
+  std::chrono::seconds GetDuration() const;
+
+  /**
+   * Get count of threads of the pool which runs connections.
+   * @return Count of threads.
+   */
+  std::size_t GetThreadCount() const;
+
+  /**
+   * Get help string with description of command line parameters.
+   * @return Help string.
+   */
+  const std::string& GetHelp() const;
+
+ private:
+  bool is_show_help_ = false;
+
+  std::string address_;
+
+  std::uint32_t port_ = 0u;
+
+  std::size_t connection_count_ = 0u;
+
+  std::size_t message_size_ = 0u;
+
+  std::size_t pipeline_depth_ = 0u;
+
+  double rate_ = 0.0;
+
+  std::chrono::seconds duration_{0};
+
+  std::size_t thread_count_ = 0u;
+
+  std::string help_;
+};
+
+}  // namespace loadgen
+}  // namespace rms
@@ -0,0 +1,181 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "loadgen/load_generator.h"
+#include <boost/asio/steady_timer.hpp>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <utility>
+#include "core/async.h"
+#include "core/iioservice.h"
+#include "net/alias.h"
+#include "net/tcp_socket.h"
+#include "net/util.h"
+
+using rms::core::RunAsync;
+using rms::net::BufferViewType;
+using rms::net::IoHandlerType;
+using rms::net::TcpSocket;
+
+namespace {
+
+// Latencies above are counted as this one
+const std::uint64_t kHighestLatencyUs = 60u * 1000u * 1000u;
+
+// Time given to connections to finish replies in flight at the end of the run before they are closed
+const std::chrono::seconds kShutdownGracePeriod{5};
+
+const std::chrono::milliseconds kPollInterval{10};
+
+std::string MakeMessages(std::size_t message_size, std::size_t count) {
+  std::string message(message_size - 1u, 'x');
+  message += '\n';
+  std::string messages;
+  messages.reserve(message_size * count);
+  for (std::size_t i = 0u; i < count; ++i) {
+    messages += message;
+  }
+  return messages;
+}
+
+}  // namespace
+
+rms::loadgen::LoadGenerator::LoadGenerator(const LoadConfig& config)
+    : config_(config),
+      messages_(MakeMessages(config.GetMessageSize(), config.GetPipelineDepth())),
+      latency_histogram_(kHighestLatencyUs) {}
+
+rms::loadgen::LoadGenerator::~LoadGenerator() = default;
+
+rms::loadgen::LoadGenerator::Report rms::loadgen::LoadGenerator::Run() {
+  LOG_AUTO_TRACE();
+  const auto connection_count = config_.GetConnectionCount();
+  latency_histogram_.Reset();
+  sent_count_ = 0u;
+  received_count_ = 0u;
+  failed_count_ = 0u;
+  finished_count_ = 0u;
+
+  LOG_INFO("Connecting " << connection_count << " clients to " << config_.GetAddress() << ":" << config_.GetPort());
+  sockets_.clear();
+  sockets_.resize(connection_count);
+  std::atomic<std::size_t> connected_count{0u};
+  for (auto& socket : sockets_) {
+    RunAsync([&] {
+      socket = TcpSocket::Create();
+      socket->Connect(config_.GetAddress(), static_cast<int>(config_.GetPort()));
+      ++connected_count;
+    });
+  }
+  WaitFor(connected_count, connection_count, ClockType::time_point::max());
+
+  LOG_INFO("Running load for " << config_.GetDuration().count() << "s");
+  const auto start = ClockType::now();
+  const auto deadline = start + config_.GetDuration();
+  for (std::size_t index = 0u; index < connection_count; ++index) {
+    RunAsync([this, index, start, deadline] { RunConnection(index, start, deadline); });
+  }
+  if (!WaitFor(finished_count_, connection_count, deadline + kShutdownGracePeriod)) {
+    LOG_WARN("Closing connections which still wait for replies");
+    for (auto& socket : sockets_) {
+      RunAsync([socket] { socket->Stop(); });
+    }
+    WaitFor(finished_count_, connection_count, ClockType::time_point::max());
+  }
+
+  Report report;
+  report.elapsed = ClockType::now() - start;
+  report.connection_count = connection_count;
+  report.failed_connection_count = failed_count_;
+  report.sent_count = sent_count_;
+  report.received_count = received_count_;
+  sockets_.clear();
+  return report;
+}
+
+const rms::util::HdrHistogram& rms::loadgen::LoadGenerator::GetLatencyHistogram() const {
+  return latency_histogram_;
+}
+
+void rms::loadgen::LoadGenerator::RunConnection(std::size_t index,
+                                                ClockType::time_point start,
+                                                ClockType::time_point deadline) {
+  auto& socket = *sockets_[index];
+  const auto message_size = config_.GetMessageSize();
+  const auto pipeline_depth = config_.GetPipelineDepth();
+  const auto is_open_loop = config_.GetRate() > 0.0;
+  // Every connection sends its share of the rate, first sends of connections are spread over the interval
+  const auto interval = std::chrono::duration_cast<ClockType::duration>(std::chrono::duration<double>(
+      is_open_loop ? static_cast<double>(config_.GetConnectionCount()) / config_.GetRate() : 0.0));
+  auto next_send = start + interval * static_cast<ClockType::rep>(index) /
+                               static_cast<ClockType::rep>(config_.GetConnectionCount());
+
+  // Due time of the messages waiting for reply, oldest first
+  std::deque<ClockType::time_point> in_flight;
+  boost::asio::steady_timer timer(core::GetCurrentThreadIoService().GetAsioService());
+  auto is_failed = false;
+  while (!is_failed) {
+    const auto now = ClockType::now();
+    if (now >= deadline) {
+      break;
+    }
+
+    std::size_t send_count = 0u;
+    while (in_flight.size() < pipeline_depth && (!is_open_loop || next_send <= now)) {
+      // In open loop messages which are late are sent at once and keep their due time
+      in_flight.push_back(is_open_loop ? next_send : now);
+      next_send += interval;
+      ++send_count;
+    }
+    if (send_count != 0u) {
+      if (socket.Write(BufferViewType(messages_.data(), send_count * message_size))) {
+        is_failed = true;
+        break;
+      }
+      sent_count_ += send_count;
+    }
+
+    if (in_flight.empty()) {
+      // Open loop ahead of schedule
+      timer.expires_at(std::min(next_send, deadline));
+      net::DeferIo([&](IoHandlerType proceed) { timer.async_wait(std::move(proceed)); });
+      continue;
+    }
+
+    const auto read_result = socket.ReadPartial();
+    if (read_result.second || read_result.first.IsEmpty()) {
+      is_failed = true;
+      break;
+    }
+    const auto received_time = ClockType::now();
+    std::size_t reply_count = 0u;
+    for (const auto& slice : read_result.first.GetSlices()) {
+      reply_count += static_cast<std::size_t>(std::count(slice.GetData(), slice.GetData() + slice.GetSize(), '\n'));
+    }
+    for (; reply_count != 0u && !in_flight.empty(); --reply_count) {
+      const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(received_time - in_flight.front());
+      latency_histogram_.Record(static_cast<std::uint64_t>(latency.count()));
+      in_flight.pop_front();
+      ++received_count_;
+    }
+  }
+
+  if (is_failed) {
+    LOG_DEBUG("Connection " << index << " has failed");
+    ++failed_count_;
+  }
+  socket.Stop();
+  ++finished_count_;
+}
+
+bool rms::loadgen::LoadGenerator::WaitFor(const std::atomic<std::size_t>& count,
+                                          std::size_t value,
+                                          ClockType::time_point deadline) {
+  while (count.load() < value) {
+    if (ClockType::now() >= deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(kPollInterval);
+  }
+  return true;
+}
@@ -0,0 +1,104 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "loadgen/load_config.h"
+#include "util/hdr_histogram.h"
+#include "util/logger.h"
+
+namespace rms {
+namespace net {
+class TcpSocket;
+}  // namespace net
+}  // namespace rms
+
+namespace rms {
+namespace loadgen {
+
+/**
+ * Load generator for echo servers. Opens connections with TcpSocket and sends newline terminated messages, every
+ * newline received back completes the oldest message in flight, so replies may be prefixed or split by the server.
+ * Closed loop sends next message as soon as a reply is received. Open loop sends messages at the configured rate
+ * and measures latency from the time the message was due rather than sent, so stalls of the server are not hidden by
+ * the sender waiting for it (coordinated omission).
+ */
+class LoadGenerator {
+ public:
+  using ClockType = std::chrono::steady_clock;
+
+  /**
+   * Result of the run.
+   */
+  struct Report {
+    std::size_t connection_count = 0u;
+
+    // Connections which failed or were closed by the server before the end of the run
+    std::size_t failed_connection_count = 0u;
+
+    std::uint64_t sent_count = 0u;
+
+    std::uint64_t received_count = 0u;
+
+    std::chrono::duration<double> elapsed{0.0};
+  };
+
+  /**
+   * Create load generator.
+   * @param config Parameters of the load.
+   */
+  explicit LoadGenerator(const LoadConfig& config);
+
+  ~LoadGenerator();
+
+  LoadGenerator& operator=(const LoadGenerator&) = delete;
+  LoadGenerator(const LoadGenerator&) = delete;
+
+  /**
+   * Connect to the server and run the load for the configured duration. Blocking call, must be made outside of async
+   * tasks. Default and network schedulers must be attached. Returns when all connections have finished, closing of
+   * the sockets might still be pending.
+   * @return Counters of the run.
+   */
+  Report Run();
+
+  /**
+   * Get latencies of the messages received during the last run.
+   * @return Histogram of latencies in microseconds.
+   */
+  const util::HdrHistogram& GetLatencyHistogram() const;
+
+ private:
+  DECLARE_GET_LOGGER("LoadGen.Generator")
+
+  void RunConnection(std::size_t index, ClockType::time_point start, ClockType::time_point deadline);
+
+  // Returns when count reaches value or at the deadline
+  static bool WaitFor(const std::atomic<std::size_t>& count, std::size_t value, ClockType::time_point deadline);
+
+  const LoadConfig& config_;
+
+  // Messages of the whole pipeline written back to back, so a batch of sends is a single write
+  const std::string messages_;
+
+  std::vector<std::shared_ptr<net::TcpSocket>> sockets_;
+
+  util::HdrHistogram latency_histogram_;
+
+  std::atomic<std::uint64_t> sent_count_{0u};
+
+  std::atomic<std::uint64_t> received_count_{0u};
+
+  std::atomic<std::size_t> failed_count_{0u};
+
+  std::atomic<std::size_t> finished_count_{0u};
+};
+
+}  // namespace loadgen
+}  // namespace rms
@@ -0,0 +1,98 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <system_error>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/general_error.h"
+#include "core/thread_pool.h"
+#include "loadgen/load_config.h"
+#include "loadgen/load_generator.h"
+#include "net/util.h"
+#include "util/logger.h"
+#include "util/scope_guard.h"
+
+DECLARE_GLOBAL_GET_LOGGER("LoadGen.Main")
+
+namespace {
+
+void PrintReport(const rms::loadgen::LoadConfig& config,
+                 const rms::loadgen::LoadGenerator::Report& report,
+                 const rms::util::HdrHistogram& latencies) {
+  const auto elapsed_sec = report.elapsed.count();
+  const auto throughput = elapsed_sec > 0.0 ? static_cast<double>(report.received_count) / elapsed_sec : 0.0;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "Mode:        " << (config.GetRate() > 0.0 ? "open loop" : "closed loop")
+            << ", pipeline " << config.GetPipelineDepth() << ", message " << config.GetMessageSize() << " bytes"
+            << std::endl;
+  std::cout << "Connections: " << report.connection_count << " (" << report.failed_connection_count << " failed)"
+            << std::endl;
+  std::cout << "Messages:    " << report.sent_count << " sent, " << report.received_count << " received in "
+            << elapsed_sec << "s" << std::endl;
+  std::cout << "Throughput:  " << throughput << " msg/s, "
+            << throughput * static_cast<double>(config.GetMessageSize()) / (1024.0 * 1024.0) << " MiB/s" << std::endl;
+  std::cout << "Latency us:  p50 " << latencies.GetValueAtPercentile(50.0) << ", p99 "
+            << latencies.GetValueAtPercentile(99.0) << ", p99.9 " << latencies.GetValueAtPercentile(99.9) << ", max "
+            << latencies.GetMax() << ", mean " << latencies.GetMean() << std::endl;
+  if (config.GetRate() <= 0.0) {
+    std::cout << "Closed loop latencies are not corrected for coordinated omission, set --rate to measure them"
+              << std::endl;
+  }
+}
+
+}  // namespace
+
+/**
+ * Entry point of the load generator.
+ * @param argc Count of command line arguments.
+ * @param argv Command line arguments.
+ * @return Error code.
+ */
+int main(int argc, char** argv) {
+  using rms::core::GeneralError;
+  using rms::core::GetDefaultIoServiceAccessorInstance;
+  using rms::core::GetDefaultSchedulerAccessorInstance;
+  using rms::core::ThreadPool;
+  using rms::loadgen::LoadConfig;
+  using rms::loadgen::LoadGenerator;
+  using rms::net::GetNetworkSchedulerAccessorInstance;
+  using rms::net::GetNetworkServiceAccessorInstance;
+
+  INIT_LOGGER("logger.cfg");
+
+  try {
+    LoadConfig config;
+    if (!config.Parse(argc, argv)) {
+      return make_error_condition(GeneralError::WrongCommandLine).value();
+    }
+    if (config.GetIsShowHelp()) {
+      std::cout << config.GetHelp();
+      return 0;
+    }
+
+    ThreadPool thread_pool{config.GetThreadCount(), "loadgen", ThreadPool::Mode::Sharded};
+    GetDefaultIoServiceAccessorInstance().Attach(thread_pool);
+    GetDefaultSchedulerAccessorInstance().Attach(thread_pool);
+    GetNetworkServiceAccessorInstance().Attach(thread_pool);
+    GetNetworkSchedulerAccessorInstance().Attach(thread_pool);
+    const auto detach_guard = rms::util::MakeScopeGuard([] {
+      GetNetworkSchedulerAccessorInstance().Detach();
+      GetNetworkServiceAccessorInstance().Detach();
+      GetDefaultSchedulerAccessorInstance().Detach();
+      GetDefaultIoServiceAccessorInstance().Detach();
+    });
+
+    LoadGenerator load_generator(config);
+    const auto report = load_generator.Run();
+    rms::core::WaitAll();
+    PrintReport(config, report, load_generator.GetLatencyHistogram());
+    return report.failed_connection_count == 0u ? 0 : make_error_condition(GeneralError::InternalError).value();
+  } catch (std::exception& e) {
+    LOG_FATAL("Exception has occurred: " << e.what());
+  } catch (...) {
+    LOG_FATAL("Unknown exception has occurred");
+  }
+  return make_error_condition(GeneralError::InternalError).value();
+}
@@ -25,7 +25,6 @@ using rms::core::GetDefaultIoServiceAccessorInstance;
 using rms::core::GetDefaultSchedulerAccessorInstance;
 using rms::core::ThreadPool;
 using rms::core::WaitAll;
-using rms::net::BufferType;
 using rms::net::GetNetworkSchedulerAccessorInstance;
 using rms::net::GetNetworkServiceAccessorInstance;
 using rms::net::TcpSocket;
@@ -69,7 +68,7 @@ TEST(TestEngine, EngineEchoTest) {
     socket->Connect(SERVER_ADDRESS, SERVER_PORT);
     ++execution_step;
 
-    BufferType snd_buffer{GREETING};
+    const std::string snd_buffer{GREETING};
     socket->Write(snd_buffer);
     ++execution_step;
 
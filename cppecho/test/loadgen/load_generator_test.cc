@@ -0,0 +1,110 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "loadgen/load_generator.h"
+#include <gtest/gtest.h>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/engine.h"
+#include "core/engine_config.h"
+#include "core/thread_pool.h"
+#include "loadgen/load_config.h"
+#include "net/util.h"
+#include "util/logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+DECLARE_GLOBAL_GET_LOGGER("Test.LoadGen.LoadGenerator")
+
+namespace {
+
+using rms::core::Engine;
+using rms::core::EngineConfig;
+using rms::core::GetDefaultIoServiceAccessorInstance;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+using rms::loadgen::LoadConfig;
+using rms::loadgen::LoadGenerator;
+using rms::net::GetNetworkSchedulerAccessorInstance;
+using rms::net::GetNetworkServiceAccessorInstance;
+
+const char SERVER_ADDRESS[] = "127.0.0.1";
+
+const int SERVER_PORT = 10126;
+
+// Run load generator with given command line against cppecho engine
+LoadGenerator::Report RunLoad(std::vector<std::string> arguments, std::uint64_t& latency_count) {
+  LOG_AUTO_TRACE();
+
+  ThreadPool thread_pool(2u, "net", ThreadPool::Mode::Sharded);
+  GetDefaultIoServiceAccessorInstance().Attach(thread_pool);
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool);
+  GetNetworkServiceAccessorInstance().Attach(thread_pool);
+  GetNetworkSchedulerAccessorInstance().Attach(thread_pool);
+
+  auto engine_config = std::make_unique<EngineConfig>();
+  engine_config->SetServerAddress(SERVER_ADDRESS);
+  engine_config->SetServerPort(SERVER_PORT);
+  auto engine = std::make_unique<Engine>(std::move(engine_config));
+  EXPECT_TRUE(engine->Init());
+  std::atomic_bool started{false};
+  std::atomic_bool stopped{false};
+  engine->SubscribeOnStarted([&]() { started = true; });
+  engine->SubscribeOnStopped([&]() { stopped = true; });
+  engine->Start();
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  arguments.insert(arguments.begin(), {"cppecho_bench", "-p", std::to_string(SERVER_PORT), "-t", "1"});
+  std::vector<char*> argv;
+  for (auto& argument : arguments) {
+    argv.push_back(&argument[0]);
+  }
+  LoadConfig config;
+  EXPECT_TRUE(config.Parse(static_cast<int>(argv.size()), argv.data()));
+
+  LoadGenerator load_generator(config);
+  const auto report = load_generator.Run();
+  latency_count = load_generator.GetLatencyHistogram().GetCount();
+
+  engine->Stop();
+  WaitAll();
+  EXPECT_TRUE(stopped);
+  engine.reset();
+
+  GetNetworkSchedulerAccessorInstance().Detach();
+  GetNetworkServiceAccessorInstance().Detach();
+  GetDefaultSchedulerAccessorInstance().Detach();
+  GetDefaultIoServiceAccessorInstance().Detach();
+  return report;
+}
+
+}  // namespace
+
+TEST(TestLoadGenerator, ClosedLoopPipelined) {
+  std::uint64_t latency_count = 0u;
+  const auto report = RunLoad({"-c", "8", "-d", "4", "-s", "100"}, latency_count);
+  ASSERT_EQ(8u, report.connection_count);
+  ASSERT_EQ(0u, report.failed_connection_count);
+  ASSERT_GT(report.received_count, 0u);
+  ASSERT_LE(report.received_count, report.sent_count);
+  // Replies of the messages in flight at the end are not awaited
+  ASSERT_LE(report.sent_count - report.received_count, 8u * 4u);
+  ASSERT_EQ(report.received_count, latency_count);
+}
+
+TEST(TestLoadGenerator, OpenLoop) {
+  std::uint64_t latency_count = 0u;
+  const auto report = RunLoad({"-c", "4", "-r", "400"}, latency_count);
+  ASSERT_EQ(0u, report.failed_connection_count);
+  // Rate is kept by the schedule, not by the speed of the server
+  ASSERT_GE(report.sent_count, 300u);
+  ASSERT_LE(report.sent_count, 404u);
+  ASSERT_EQ(report.received_count, latency_count);
+}
@@ -0,0 +1,241 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/async.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "core/alias.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/helper.h"
+#include "core/sequential_scheduler.h"
+#include "core/thread_pool.h"
+#include "core/timer_wheel.h"
+
+using rms::core::CallbackType;
+using rms::core::CountDownLatch;
+using rms::core::DeferProceed;
+using rms::core::GetDefaultIoServiceAccessorInstance;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::GetTimeoutServiceAccessorInstance;
+using rms::core::GetTimerWheelAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::RunAsyncAnyWait;
+using rms::core::RunAsyncWait;
+using rms::core::SequentialScheduler;
+using rms::core::SwitchTo;
+using rms::core::ThreadCountArguments;
+using rms::core::ThreadPool;
+using rms::core::Timeout;
+using rms::core::TimerWheel;
+using rms::core::WaitAll;
+using rms::core::Waiter;
+
+namespace {
+
+// Operations made by every task per iteration, a task runs per thread of the pool
+const int kOperationsPerTask = 1000;
+
+// Timeouts never fire during the benchmark
+const int kTimeoutMs = 3600 * 1000;
+
+const char sequential_scheduler_name[] = "bench_sequential";
+
+/**
+ * Pool of range(0) threads attached as default scheduler and io service for the duration of the benchmark.
+ */
+class PoolScope {
+ public:
+  explicit PoolScope(const benchmark::State& state)
+      : thread_count_(static_cast<std::size_t>(state.range(0))), thread_pool_{thread_count_, "bench"} {
+    GetDefaultIoServiceAccessorInstance().Attach(thread_pool_);
+    GetDefaultSchedulerAccessorInstance().Attach(thread_pool_);
+    GetTimeoutServiceAccessorInstance().Attach(thread_pool_);
+  }
+
+  ~PoolScope() {
+    WaitAll();
+    GetTimeoutServiceAccessorInstance().Detach();
+    GetDefaultSchedulerAccessorInstance().Detach();
+    GetDefaultIoServiceAccessorInstance().Detach();
+  }
+
+  PoolScope& operator=(const PoolScope&) = delete;
+  PoolScope(const PoolScope&) = delete;
+
+  std::size_t GetThreadCount() const {
+    return thread_count_;
+  }
+
+  ThreadPool& GetThreadPool() {
+    return thread_pool_;
+  }
+
+ private:
+  const std::size_t thread_count_;
+
+  ThreadPool thread_pool_;
+};
+
+// Run task per thread which makes kOperationsPerTask operations and wait for all of them
+template <typename Operation>
+void RunTasks(std::size_t task_count, Operation operation) {
+  CountDownLatch done{task_count};
+  for (std::size_t i = 0u; i < task_count; ++i) {
+    RunAsync([&] {
+      for (int j = 0; j < kOperationsPerTask; ++j) {
+        operation();
+      }
+      done.CountDown();
+    });
+  }
+  done.Wait();
+}
+
+void SetOperationsProcessed(benchmark::State& state, std::size_t task_count) {
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(task_count) *
+                          kOperationsPerTask);
+}
+
+struct DeadlineTimerBackend {
+  void Attach() {}
+
+  void Detach() {}
+};
+
+struct TimerWheelBackend {
+  void Attach() {
+    GetTimerWheelAccessorInstance().Attach(timer_wheel);
+  }
+
+  void Detach() {
+    GetTimerWheelAccessorInstance().Detach();
+  }
+
+  TimerWheel timer_wheel;
+};
+
+}  // namespace
+
+// Spawn of a coroutine task from a task, including its run and completion
+void BM_RunAsyncSpawn(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  for (auto _ : state) {
+    std::atomic<std::size_t> remaining{task_count * kOperationsPerTask};
+    CountDownLatch children_done{1u};
+    RunTasks(task_count, [&] {
+      RunAsync([&] {
+        if (--remaining == 0u) {
+          children_done.CountDown();
+        }
+      });
+    });
+    children_done.Wait();
+  }
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK(BM_RunAsyncSpawn)->Apply(ThreadCountArguments)->UseRealTime();
+
+// Task yields and is resumed at once: suspend, schedule of the continuation and resume
+void BM_DeferProceedRoundTrip(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  for (auto _ : state) {
+    RunTasks(task_count, [] { DeferProceed([](CallbackType proceed) { proceed(); }); });
+  }
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK(BM_DeferProceedRoundTrip)->Apply(ThreadCountArguments)->UseRealTime();
+
+// Task moves to another pool and back
+void BM_SwitchToRoundTrip(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  ThreadPool other_thread_pool{task_count, "bench_other"};
+  auto& thread_pool = pool_scope.GetThreadPool();
+  for (auto _ : state) {
+    RunTasks(task_count, [&] {
+      SwitchTo(other_thread_pool);
+      SwitchTo(thread_pool);
+    });
+  }
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK(BM_SwitchToRoundTrip)->Apply(ThreadCountArguments)->UseRealTime();
+
+// Handlers scheduled to a single sequential scheduler by a task per thread
+void BM_SequentialSchedulerSchedule(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  SequentialScheduler sequential_scheduler{pool_scope.GetThreadPool(), sequential_scheduler_name};
+  for (auto _ : state) {
+    // Runs sequentially, no atomic is needed
+    std::size_t remaining = task_count * kOperationsPerTask;
+    CountDownLatch handlers_done{1u};
+    RunTasks(task_count, [&] {
+      sequential_scheduler.Schedule([&] {
+        if (--remaining == 0u) {
+          handlers_done.CountDown();
+        }
+      });
+    });
+    handlers_done.Wait();
+  }
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK(BM_SequentialSchedulerSchedule)->Apply(ThreadCountArguments)->UseRealTime();
+
+// Fan-out to 4 tasks and wait for all of them
+void BM_RunAsyncWaitFanOut(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  for (auto _ : state) {
+    RunTasks(task_count, [] { RunAsyncWait({[] {}, [] {}, [] {}, [] {}}); });
+  }
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK(BM_RunAsyncWaitFanOut)->Apply(ThreadCountArguments)->UseRealTime();
+
+// Fan-out to 4 tasks and wait for the first one
+void BM_RunAsyncAnyWaitFanOut(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  for (auto _ : state) {
+    RunTasks(task_count, [] { benchmark::DoNotOptimize(RunAsyncAnyWait({[] {}, [] {}, [] {}, [] {}})); });
+  }
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK(BM_RunAsyncAnyWaitFanOut)->Apply(ThreadCountArguments)->UseRealTime();
+
+// Waiter with 2 tasks
+void BM_WaiterFanOut(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  for (auto _ : state) {
+    RunTasks(task_count, [] {
+      Waiter waiter;
+      waiter.RunAsync([] {}).RunAsync([] {});
+      waiter.Wait();
+    });
+  }
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK(BM_WaiterFanOut)->Apply(ThreadCountArguments)->UseRealTime();
+
+// Timeout armed and cancelled by a task per thread
+template <typename Backend>
+void BM_TimeoutArmCancel(benchmark::State& state) {
+  PoolScope pool_scope{state};
+  const auto task_count = pool_scope.GetThreadCount();
+  Backend backend;
+  backend.Attach();
+  for (auto _ : state) {
+    RunTasks(task_count, [] { Timeout timeout{kTimeoutMs}; });
+  }
+  WaitAll();
+  backend.Detach();
+  SetOperationsProcessed(state, task_count);
+}
+BENCHMARK_TEMPLATE(BM_TimeoutArmCancel, DeadlineTimerBackend)->Apply(ThreadCountArguments)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TimeoutArmCancel, TimerWheelBackend)->Apply(ThreadCountArguments)->UseRealTime();
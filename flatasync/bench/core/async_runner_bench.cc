@@ -0,0 +1,80 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/helper.h"
+#include "core/thread_pool.h"
+#include "util/sharded_counter.h"
+
+using rms::core::CountDownLatch;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::ThreadPool;
+using rms::util::ShardedCounter;
+
+namespace {
+
+const int kMaxThreadCount = 64;
+
+// Length of the RunAsync chain started by every worker
+const int kChainLength = 1000;
+
+class BenchCounterTag;
+
+std::atomic<int> global_counter{0};
+
+struct GlobalCounter {
+  static void Run() {
+    // Same pattern as the former runner count: increment in ctor, decrement in dtor
+    benchmark::DoNotOptimize(++global_counter);
+    benchmark::DoNotOptimize(--global_counter);
+  }
+};
+
+struct ShardedCounterPolicy {
+  static void Run() {
+    auto& slot = ShardedCounter<BenchCounterTag>::Increment();
+    benchmark::DoNotOptimize(ShardedCounter<BenchCounterTag>::Decrement(slot));
+  }
+};
+
+void RunChain(int remaining, CountDownLatch& latch) {
+  if (remaining == 0) {
+    latch.CountDown();
+    return;
+  }
+  RunAsync([remaining, &latch] { RunChain(remaining - 1, latch); });
+}
+
+}  // namespace
+
+template <typename Counter>
+void BM_RunnerCounter(benchmark::State& state) {
+  for (auto _ : state) {
+    Counter::Run();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_RunnerCounter, GlobalCounter)->ThreadRange(1, kMaxThreadCount)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RunnerCounter, ShardedCounterPolicy)->ThreadRange(1, kMaxThreadCount)->UseRealTime();
+
+// Every worker runs its own chain of async tasks, so runners are created and destroyed on all threads at once
+void BM_RunAsyncChains(benchmark::State& state) {
+  const auto thread_count = static_cast<std::size_t>(state.range(0));
+  ThreadPool thread_pool{thread_count, "bench", ThreadPool::Mode::WorkStealing};
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool);
+  for (auto _ : state) {
+    CountDownLatch latch{thread_count};
+    for (std::size_t i = 0u; i < thread_count; ++i) {
+      RunAsync([&latch] { RunChain(kChainLength, latch); });
+    }
+    latch.Wait();
+  }
+  GetDefaultSchedulerAccessorInstance().Detach();
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(thread_count) * (kChainLength + 1));
+}
+BENCHMARK(BM_RunAsyncChains)->RangeMultiplier(2)->Range(1, kMaxThreadCount)->UseRealTime();
@@ -0,0 +1,91 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/helper.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+namespace {
+
+thread_local std::size_t thrd_allocation_count = 0u;
+
+std::atomic<bool> is_counting_allocations{false};
+
+std::atomic<std::size_t> allocation_count{0u};
+
+void* CountingAllocate(std::size_t size) {
+  ++thrd_allocation_count;
+  if (is_counting_allocations.load(std::memory_order_relaxed)) {
+    allocation_count.fetch_add(1u, std::memory_order_relaxed);
+  }
+  void* ptr = std::malloc(size == 0u ? 1u : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  return CountingAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return CountingAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void rms::core::ThreadCountArguments(benchmark::internal::Benchmark* benchmark) {
+  const int max_thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  int thread_count = 1;
+  for (; thread_count < max_thread_count; thread_count *= 2) {
+    benchmark->Arg(thread_count);
+  }
+  benchmark->Arg(max_thread_count);
+}
+
+std::size_t rms::core::GetThreadAllocationCount() {
+  return thrd_allocation_count;
+}
+
+void rms::core::StartAllocationCounting() {
+  allocation_count.store(0u, std::memory_order_relaxed);
+  is_counting_allocations.store(true, std::memory_order_seq_cst);
+}
+
+std::size_t rms::core::StopAllocationCounting() {
+  is_counting_allocations.store(false, std::memory_order_seq_cst);
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+rms::core::CountDownLatch::CountDownLatch(std::size_t count) : count_(count) {}
+
+void rms::core::CountDownLatch::CountDown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (count_ != 0u && --count_ == 0u) {
+    awaiter_.notify_all();
+  }
+}
+
+void rms::core::CountDownLatch::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  awaiter_.wait(lock, [this] { return count_ == 0u; });
+}
@@ -0,0 +1,58 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace rms {
+namespace core {
+
+/**
+ * Register thread count arguments for benchmark: 1, 2, 4, ... up to hardware concurrency (inclusive).
+ * @param benchmark Benchmark to add arguments to.
+ */
+void ThreadCountArguments(benchmark::internal::Benchmark* benchmark);
+
+/**
+ * Get count of global heap allocations (operator new) made by current thread since its start. Benchmark runner
+ * replaces global operator new to count them.
+ * @return Count of allocations.
+ */
+std::size_t GetThreadAllocationCount();
+
+/**
+ * Start counting global heap allocations made by all threads. Counter is shared, so it is meant for a dedicated
+ * measurement pass rather than for the timed loop.
+ */
+void StartAllocationCounting();
+
+/**
+ * Stop counting allocations made by all threads.
+ * @return Count of allocations since the last StartAllocationCounting.
+ */
+std::size_t StopAllocationCounting();
+
+/**
+ * Simple countdown latch. Allows benchmark thread to wait for completion of the tasks running in the pool.
+ */
+class CountDownLatch {
+ public:
+  explicit CountDownLatch(std::size_t count);
+
+  void CountDown();
+
+  void Wait();
+
+ private:
+  std::size_t count_;
+
+  std::mutex mutex_;
+
+  std::condition_variable awaiter_;
+};
+
+}  // namespace core
+}  // namespace rms
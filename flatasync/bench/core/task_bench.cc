@@ -0,0 +1,104 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <boost/asio.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include "core/alias.h"
+#include "core/helper.h"
+
+using rms::core::CallbackType;
+using rms::core::GetThreadAllocationCount;
+using rms::core::Task;
+
+namespace {
+
+const int kChainLength = 1000;
+
+struct Context {
+  boost::asio::io_service asio_service;
+
+  std::shared_ptr<int> owner = std::make_shared<int>(1);
+
+  int remaining = 0;
+
+  int value = 0;
+};
+
+// Typical capture of the scheduled task: shared owner plus a couple of references
+template <typename Function>
+Function MakeTypicalTask(Context& context);
+
+// Capture of the net layer: copyable continuation (as returned by AsyncRunner::ProceedHandler) plus references
+template <typename Function>
+Function MakeNestedTask(Context& context);
+
+template <typename Function, Function (*Make)(Context&)>
+void PostNext(Context& context) {
+  if (--context.remaining > 0) {
+    boost::asio::post(context.asio_service, Make(context));
+  }
+}
+
+template <typename Function>
+Function MakeTypicalTask(Context& context) {
+  return Function([owner = context.owner, &context, &value = context.value] {
+    benchmark::DoNotOptimize(value += *owner);
+    PostNext<Function, MakeTypicalTask<Function>>(context);
+  });
+}
+
+template <typename Function>
+Function MakeNestedTask(Context& context) {
+  CallbackType proceed = [&context] { benchmark::DoNotOptimize(++context.value); };
+  return Function([proceed, &context, &value = context.value] {
+    proceed();
+    benchmark::DoNotOptimize(value);
+    PostNext<Function, MakeNestedTask<Function>>(context);
+  });
+}
+
+template <typename Function, Function (*Make)(Context&)>
+void BM_TaskCreateMoveInvoke(benchmark::State& state) {
+  Context context;
+  const auto allocation_count = GetThreadAllocationCount();
+  for (auto _ : state) {
+    // Nothing is posted: remaining drops to 0 on invocation
+    context.remaining = 1;
+    auto task = Make(context);
+    auto moved = std::move(task);
+    moved();
+  }
+  state.counters["allocs_per_task"] =
+      static_cast<double>(GetThreadAllocationCount() - allocation_count) / static_cast<double>(state.iterations());
+}
+
+template <typename Function, Function (*Make)(Context&)>
+void BM_TaskPostChain(benchmark::State& state) {
+  Context context;
+  const auto allocation_count = GetThreadAllocationCount();
+  for (auto _ : state) {
+    // Each task posts the next one, io service recycles handler memory as it does in ThreadPool workers
+    context.remaining = kChainLength;
+    boost::asio::post(context.asio_service, Make(context));
+    context.asio_service.run();
+    context.asio_service.reset();
+  }
+  const auto task_count = state.iterations() * kChainLength;
+  state.SetItemsProcessed(task_count);
+  state.counters["allocs_per_task"] =
+      static_cast<double>(GetThreadAllocationCount() - allocation_count) / static_cast<double>(task_count);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_TaskCreateMoveInvoke, std::function<void()>, MakeTypicalTask<std::function<void()>>);
+BENCHMARK_TEMPLATE(BM_TaskCreateMoveInvoke, Task, MakeTypicalTask<Task>);
+BENCHMARK_TEMPLATE(BM_TaskCreateMoveInvoke, std::function<void()>, MakeNestedTask<std::function<void()>>);
+BENCHMARK_TEMPLATE(BM_TaskCreateMoveInvoke, Task, MakeNestedTask<Task>);
+BENCHMARK_TEMPLATE(BM_TaskPostChain, std::function<void()>, MakeTypicalTask<std::function<void()>>);
+BENCHMARK_TEMPLATE(BM_TaskPostChain, Task, MakeTypicalTask<Task>);
+BENCHMARK_TEMPLATE(BM_TaskPostChain, std::function<void()>, MakeNestedTask<std::function<void()>>);
+BENCHMARK_TEMPLATE(BM_TaskPostChain, Task, MakeNestedTask<Task>);
@@ -0,0 +1,81 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/thread_pool.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include "core/helper.h"
+
+using rms::core::CountDownLatch;
+using rms::core::ThreadCountArguments;
+using rms::core::ThreadPool;
+
+namespace {
+
+// Tree of tasks: each task schedules two children. 2^15 - 1 tasks per iteration.
+const int kTreeDepth = 14;
+
+const std::size_t kTaskCount = (std::size_t{1} << (kTreeDepth + 1)) - 1u;
+
+// Short piece of work so scheduling overhead dominates
+void DoWork() {
+  int value = 0;
+  for (int i = 0; i < 64; ++i) {
+    benchmark::DoNotOptimize(value += i);
+  }
+}
+
+void SpawnTree(ThreadPool& thread_pool, int depth, std::atomic<std::size_t>& remaining, CountDownLatch& latch) {
+  DoWork();
+  if (depth > 0) {
+    for (int i = 0; i < 2; ++i) {
+      thread_pool.Schedule(
+          [&thread_pool, depth, &remaining, &latch] { SpawnTree(thread_pool, depth - 1, remaining, latch); });
+    }
+  }
+  if (--remaining == 0u) {
+    latch.CountDown();
+  }
+}
+
+}  // namespace
+
+template <ThreadPool::Mode mode>
+void BM_ThreadPoolTaskTree(benchmark::State& state) {
+  ThreadPool thread_pool{static_cast<std::size_t>(state.range(0)), "bench", mode};
+  for (auto _ : state) {
+    std::atomic<std::size_t> remaining{kTaskCount};
+    CountDownLatch latch{1u};
+    thread_pool.Schedule([&] { SpawnTree(thread_pool, kTreeDepth, remaining, latch); });
+    latch.Wait();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kTaskCount));
+}
+BENCHMARK_TEMPLATE(BM_ThreadPoolTaskTree, ThreadPool::Mode::Shared)->Apply(ThreadCountArguments)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ThreadPoolTaskTree, ThreadPool::Mode::WorkStealing)->Apply(ThreadCountArguments)->UseRealTime();
+
+template <ThreadPool::Mode mode>
+void BM_ThreadPoolExternalSchedule(benchmark::State& state) {
+  ThreadPool thread_pool{static_cast<std::size_t>(state.range(0)), "bench", mode};
+  for (auto _ : state) {
+    std::atomic<std::size_t> remaining{kTaskCount};
+    CountDownLatch latch{1u};
+    for (std::size_t i = 0u; i < kTaskCount; ++i) {
+      thread_pool.Schedule([&remaining, &latch] {
+        DoWork();
+        if (--remaining == 0u) {
+          latch.CountDown();
+        }
+      });
+    }
+    latch.Wait();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kTaskCount));
+}
+BENCHMARK_TEMPLATE(BM_ThreadPoolExternalSchedule, ThreadPool::Mode::Shared)
+    ->Apply(ThreadCountArguments)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ThreadPoolExternalSchedule, ThreadPool::Mode::WorkStealing)
+    ->Apply(ThreadCountArguments)
+    ->UseRealTime();
@@ -0,0 +1,71 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/timer_wheel.h"
+#include <benchmark/benchmark.h>
+#include <boost/asio/deadline_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "core/alias.h"
+#include "core/async_op_state.h"
+
+using rms::core::AsioServiceType;
+using rms::core::AsyncOpState;
+using rms::core::TimerWheel;
+
+namespace {
+
+// Outstanding timers never fire during the benchmark
+const int kLongTimeoutMs = 3600 * 1000;
+
+const int kTimeoutMs = 1000;
+
+void OutstandingArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->RangeMultiplier(10)->Range(1000, 1000 * 1000);
+}
+
+}  // namespace
+
+// Arm and cancel of timeout as done by Timeout on the timeout io service
+void BM_TimeoutArmCancelDeadlineTimer(benchmark::State& state) {
+  AsioServiceType asio_service;
+  const auto handler = [](const boost::system::error_code&) {};
+  std::vector<std::unique_ptr<boost::asio::deadline_timer>> outstanding;
+  for (int i = 0; i < state.range(0); ++i) {
+    outstanding.emplace_back(
+        std::make_unique<boost::asio::deadline_timer>(asio_service, boost::posix_time::milliseconds(kLongTimeoutMs)));
+    outstanding.back()->async_wait(handler);
+  }
+  AsyncOpState op_state;
+  for (auto _ : state) {
+    boost::asio::deadline_timer timer{asio_service, boost::posix_time::milliseconds(kTimeoutMs)};
+    timer.async_wait([op_state](const boost::system::error_code&) {});
+    boost::system::error_code error_code;
+    timer.cancel_one(error_code);
+    // Run cancelled handler, as the timeout io service would do
+    asio_service.poll_one();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimeoutArmCancelDeadlineTimer)->Apply(OutstandingArguments);
+
+void BM_TimeoutArmCancelTimerWheel(benchmark::State& state) {
+  TimerWheel timer_wheel;
+  std::vector<std::unique_ptr<TimerWheel::Entry>> outstanding;
+  for (int i = 0; i < state.range(0); ++i) {
+    outstanding.emplace_back(std::make_unique<TimerWheel::Entry>());
+    timer_wheel.Arm(*outstanding.back(), std::chrono::milliseconds(kLongTimeoutMs + i), AsyncOpState());
+  }
+  AsyncOpState op_state;
+  for (auto _ : state) {
+    TimerWheel::Entry entry;
+    timer_wheel.Arm(entry, std::chrono::milliseconds(kTimeoutMs), op_state);
+    benchmark::DoNotOptimize(timer_wheel.Cancel(entry));
+  }
+  for (auto& entry : outstanding) {
+    timer_wheel.Cancel(*entry);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimeoutArmCancelTimerWheel)->Apply(OutstandingArguments);
@@ -0,0 +1,88 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "util/slot_map.h"
+
+using rms::util::SlotMap;
+
+namespace {
+
+// Stands for the accepted socket, only ownership is moved in and out of the slot
+using ConnectionType = std::shared_ptr<int>;
+
+// Former TcpServer layout: vector of all slots, new connection takes the first empty one
+class LinearScanSlots {
+ public:
+  explicit LinearScanSlots(std::size_t capacity) : connections_(capacity) {}
+
+  std::size_t Insert(ConnectionType connection) {
+    const auto iter = std::find_if(
+        connections_.begin(), connections_.end(), [](const ConnectionType& item) { return !static_cast<bool>(item); });
+    *iter = std::move(connection);
+    return static_cast<std::size_t>(std::distance(connections_.begin(), iter)) + 1u;
+  }
+
+  void Erase(std::size_t id) {
+    connections_[id - 1u].reset();
+  }
+
+  std::size_t GetSize() const {
+    return static_cast<std::size_t>(std::count_if(
+        connections_.begin(), connections_.end(), [](const ConnectionType& item) { return static_cast<bool>(item); }));
+  }
+
+ private:
+  std::vector<ConnectionType> connections_;
+};
+
+class SlotMapSlots {
+ public:
+  explicit SlotMapSlots(std::size_t capacity) : connections_(capacity) {}
+
+  SlotMap<ConnectionType>::IdType Insert(ConnectionType connection) {
+    return *connections_.Insert(std::move(connection));
+  }
+
+  void Erase(SlotMap<ConnectionType>::IdType id) {
+    connections_.Erase(id);
+  }
+
+  std::size_t GetSize() const {
+    return connections_.GetSize();
+  }
+
+ private:
+  SlotMap<ConnectionType> connections_;
+};
+
+void LiveConnectionsArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Arg(1000)->Arg(10 * 1000)->Arg(100 * 1000);
+}
+
+}  // namespace
+
+// Accept and disconnect of one client while range(0) clients stay connected, as done by TcpServer
+template <typename Slots>
+void BM_ConnectionSlotAcceptRelease(benchmark::State& state) {
+  const auto live_count = static_cast<std::size_t>(state.range(0));
+  // Headroom, as the limit is configured above the expected count of clients
+  Slots slots{live_count * 2u};
+  const auto connection = std::make_shared<int>(0);
+  for (std::size_t i = 0u; i < live_count; ++i) {
+    slots.Insert(connection);
+  }
+  for (auto _ : state) {
+    const auto id = slots.Insert(connection);
+    slots.Erase(id);
+    // Connected count is checked on every disconnect during shutdown
+    benchmark::DoNotOptimize(slots.GetSize());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ConnectionSlotAcceptRelease, LinearScanSlots)->Apply(LiveConnectionsArguments);
+BENCHMARK_TEMPLATE(BM_ConnectionSlotAcceptRelease, SlotMapSlots)->Apply(LiveConnectionsArguments);
@@ -0,0 +1,147 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "core/alias.h"
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/helper.h"
+#include "core/thread_pool.h"
+#include "net/alias.h"
+#include "net/tcp_server.h"
+#include "net/util.h"
+
+using rms::core::AsioServiceType;
+using rms::core::CountDownLatch;
+using rms::core::GetDefaultIoServiceAccessorInstance;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+using rms::net::GetNetworkSchedulerAccessorInstance;
+using rms::net::GetNetworkServiceAccessorInstance;
+using rms::net::TcpServer;
+using rms::net::TcpServerIdType;
+
+namespace {
+
+const int kServerPort = 10142;
+
+// Connections opened at once by every iteration
+const int kStormSize = 256;
+
+const int kClientThreadCount = 4;
+
+const std::size_t kMaxConnections = 1024u * 1024u;
+
+const int kBatchSize = 64;
+
+int GetThreadCount() {
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Acceptor count, accepts per acceptor, accept batch size
+void StormArguments(benchmark::internal::Benchmark* benchmark) {
+  // Single acceptor with single outstanding accept against a listening socket per shard with several accepts each,
+  // both with an async accept per connection and with draining of the backlog
+  for (const auto batch_size : {1, kBatchSize}) {
+    benchmark->Args({1, 1, batch_size})->Args({GetThreadCount(), 4, batch_size});
+  }
+}
+
+// Clients connect with plain blocking sockets, so the client side doesn't compete for the server pool
+void ConnectClients(std::vector<AsioServiceType>& asio_services,
+                    std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>>& clients,
+                    int count) {
+  const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), kServerPort);
+  std::vector<std::thread> threads;
+  clients.resize(static_cast<std::size_t>(count));
+  for (int thread_index = 0; thread_index < kClientThreadCount; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      for (int i = thread_index; i < count; i += kClientThreadCount) {
+        auto& client = clients[static_cast<std::size_t>(i)];
+        client = std::make_unique<boost::asio::ip::tcp::socket>(asio_services[static_cast<std::size_t>(thread_index)]);
+        client->connect(endpoint);
+        // Reset on close, so storms don't leave client ports in TIME_WAIT
+        client->set_option(boost::asio::socket_base::linger(true, 0));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void WaitFor(const std::atomic<std::int64_t>& counter, std::int64_t value) {
+  while (counter.load() < value) {
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace
+
+// Connects per second accepted and registered by TcpServer. Iteration ends when the server has reported all clients
+// of the storm as connected.
+void BM_TcpServerConnectionStorm(benchmark::State& state) {
+  TcpServer::AcceptOptions accept_options;
+  accept_options.acceptor_count = static_cast<std::size_t>(state.range(0));
+  accept_options.accepts_per_acceptor = static_cast<std::size_t>(state.range(1));
+  accept_options.accept_batch_size = static_cast<std::size_t>(state.range(2));
+  accept_options.listen_backlog = kStormSize;
+
+  ThreadPool thread_pool{static_cast<std::size_t>(GetThreadCount()), "net", ThreadPool::Mode::Sharded};
+  GetDefaultIoServiceAccessorInstance().Attach(thread_pool);
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool);
+  GetNetworkServiceAccessorInstance().Attach(thread_pool);
+  GetNetworkSchedulerAccessorInstance().Attach(thread_pool);
+
+  std::unique_ptr<TcpServer> tcp_server;
+  std::atomic<std::int64_t> connected_count{0};
+  std::atomic<std::int64_t> disconnected_count{0};
+  CountDownLatch listening{1u};
+  CountDownLatch stopped{1u};
+  RunAsync([&] {
+    tcp_server = std::make_unique<TcpServer>(kMaxConnections);
+    tcp_server->SetAcceptOptions(accept_options);
+    tcp_server->SubscribeOnConnected([&](TcpServerIdType) { ++connected_count; });
+    tcp_server->SubscribeOnDisconnected([&](TcpServerIdType) { ++disconnected_count; });
+    tcp_server->SubscribeOnListening([&] { listening.CountDown(); });
+    tcp_server->SubscribeOnStopped([&] { stopped.CountDown(); });
+    tcp_server->Start(kServerPort);
+  });
+  listening.Wait();
+
+  // Outlive client sockets
+  std::vector<AsioServiceType> asio_services(kClientThreadCount);
+  std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> clients;
+  for (auto _ : state) {
+    const auto target_count = connected_count.load() + kStormSize;
+    ConnectClients(asio_services, clients, kStormSize);
+    WaitFor(connected_count, target_count);
+
+    state.PauseTiming();
+    clients.clear();
+    WaitFor(disconnected_count, target_count);
+    state.ResumeTiming();
+  }
+
+  RunAsync([&] { tcp_server->Stop(); });
+  stopped.Wait();
+  WaitAll();
+  tcp_server.reset();
+
+  GetNetworkSchedulerAccessorInstance().Detach();
+  GetNetworkServiceAccessorInstance().Detach();
+  GetDefaultSchedulerAccessorInstance().Detach();
+  GetDefaultIoServiceAccessorInstance().Detach();
+
+  state.SetItemsProcessed(state.iterations() * kStormSize);
+}
+BENCHMARK(BM_TcpServerConnectionStorm)->Apply(StormArguments)->UseRealTime();
@@ -0,0 +1,145 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/helper.h"
+#include "core/thread_pool.h"
+#include "net/acceptor.h"
+#include "net/tcp_socket.h"
+#include "net/util.h"
+
+using rms::core::CountDownLatch;
+using rms::core::GetDefaultIoServiceAccessorInstance;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::StartAllocationCounting;
+using rms::core::StopAllocationCounting;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+using rms::net::Acceptor;
+using rms::net::BufferType;
+using rms::net::GetNetworkSchedulerAccessorInstance;
+using rms::net::GetNetworkServiceAccessorInstance;
+using rms::net::TcpSocket;
+
+namespace {
+
+const int kServerPort = 10141;
+
+const int kRoundTripsPerIteration = 100;
+
+const std::size_t kMessageSize = 32u;
+
+// Former TcpSocket::Start: every received packet is handled by a new runner which schedules the next read via
+// another runner
+void ServePerPacket(std::shared_ptr<TcpSocket> socket) {
+  RunAsync([socket] {
+    const auto read_result = socket->ReadPartial();
+    if (read_result.second || read_result.first.IsEmpty()) {
+      return;
+    }
+    socket->Write(read_result.first);
+    RunAsync([socket] { ServePerPacket(socket); });
+  });
+}
+
+struct PerPacketReadLoop {
+  static void Serve(std::shared_ptr<TcpSocket> socket) {
+    ServePerPacket(std::move(socket));
+  }
+};
+
+struct PersistentReadLoop {
+  static void Serve(std::shared_ptr<TcpSocket> socket) {
+    socket->SubscribeOnData([](TcpSocket& socket, const BufferType& data) { socket.Write(data); });
+    socket->Start();
+  }
+};
+
+void RunRoundTrips(std::vector<std::shared_ptr<TcpSocket>>& clients, const std::string& message) {
+  CountDownLatch done{clients.size()};
+  for (auto& client : clients) {
+    RunAsync([&] {
+      for (int i = 0; i < kRoundTripsPerIteration; ++i) {
+        client->Write(message);
+        client->ReadExact(message.size());
+      }
+      done.CountDown();
+    });
+  }
+  done.Wait();
+}
+
+}  // namespace
+
+// Echo server which reads with the given design. Clients wait for the echo before sending next message, so every
+// message is a separate read on the server side.
+template <typename ReadLoop>
+void BM_TcpSocketReadLoop(benchmark::State& state) {
+  const auto connection_count = static_cast<int>(state.range(0));
+
+  ThreadPool thread_pool{1u, "net", ThreadPool::Mode::Shared};
+  GetDefaultIoServiceAccessorInstance().Attach(thread_pool);
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool);
+  GetNetworkServiceAccessorInstance().Attach(thread_pool);
+  GetNetworkSchedulerAccessorInstance().Attach(thread_pool);
+
+  CountDownLatch listening{1u};
+  RunAsync([&] {
+    Acceptor acceptor(kServerPort);
+    listening.CountDown();
+    for (int i = 0; i < connection_count; ++i) {
+      acceptor.DoAccept([](std::shared_ptr<TcpSocket> socket) { ReadLoop::Serve(std::move(socket)); });
+    }
+  });
+  listening.Wait();
+
+  std::vector<std::shared_ptr<TcpSocket>> clients(connection_count);
+  {
+    CountDownLatch connected{static_cast<std::size_t>(connection_count)};
+    for (auto& client : clients) {
+      RunAsync([&] {
+        client = TcpSocket::Create();
+        client->Connect("127.0.0.1", kServerPort);
+        connected.CountDown();
+      });
+    }
+    connected.Wait();
+  }
+
+  const std::string message(kMessageSize, 'x');
+  for (auto _ : state) {
+    RunRoundTrips(clients, message);
+  }
+
+  // Separate pass, counting slows down the allocator of all threads. Includes allocations of the clients, which are
+  // the same for both designs.
+  StartAllocationCounting();
+  RunRoundTrips(clients, message);
+  const auto allocation_count = StopAllocationCounting();
+
+  for (auto& client : clients) {
+    RunAsync([&] { client->Stop(); });
+  }
+  WaitAll();
+  clients.clear();
+
+  GetNetworkSchedulerAccessorInstance().Detach();
+  GetNetworkServiceAccessorInstance().Detach();
+  GetDefaultSchedulerAccessorInstance().Detach();
+  GetDefaultIoServiceAccessorInstance().Detach();
+
+  const auto messages_per_iteration = static_cast<std::int64_t>(connection_count * kRoundTripsPerIteration);
+  state.SetItemsProcessed(state.iterations() * messages_per_iteration);
+  state.counters["allocs_per_msg"] =
+      static_cast<double>(allocation_count) / static_cast<double>(messages_per_iteration);
+}
+BENCHMARK_TEMPLATE(BM_TcpSocketReadLoop, PerPacketReadLoop)->Arg(1)->Arg(64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TcpSocketReadLoop, PersistentReadLoop)->Arg(1)->Arg(64)->UseRealTime();
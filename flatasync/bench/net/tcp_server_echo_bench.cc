@@ -0,0 +1,135 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/helper.h"
+#include "core/sequential_scheduler.h"
+#include "core/thread_pool.h"
+#include "net/alias.h"
+#include "net/tcp_server.h"
+#include "net/tcp_socket.h"
+#include "net/util.h"
+
+using rms::core::CountDownLatch;
+using rms::core::GetDefaultIoServiceAccessorInstance;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::SequentialScheduler;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+using rms::net::BufferType;
+using rms::net::GetNetworkSchedulerAccessorInstance;
+using rms::net::GetNetworkServiceAccessorInstance;
+using rms::net::TcpServer;
+using rms::net::TcpServerIdType;
+using rms::net::TcpSocket;
+
+namespace {
+
+const int kServerPort = 10143;
+
+const int kConnectionCount = 64;
+
+const int kRoundTripsPerIteration = 100;
+
+const std::size_t kMessageSize = 32u;
+
+const char server_scheduler_name[] = "server_sequential";
+
+// Thread count, count of connection schedulers: 0 keeps all clients on the scheduler of the server, as cppecho engine
+// used to do, otherwise a scheduler per thread
+void EchoArguments(benchmark::internal::Benchmark* benchmark) {
+  const int max_thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  for (int thread_count = 1;; thread_count = std::min(thread_count * 2, max_thread_count)) {
+    benchmark->Args({thread_count, 0})->Args({thread_count, thread_count});
+    if (thread_count == max_thread_count) {
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+// Echo round trips per second served by TcpServer started on a sequential scheduler. Shows whether throughput scales
+// with threads when clients are not funneled through the scheduler of the server.
+void BM_TcpServerEcho(benchmark::State& state) {
+  const auto thread_count = static_cast<std::size_t>(state.range(0));
+  const auto connection_scheduler_count = static_cast<std::size_t>(state.range(1));
+
+  ThreadPool thread_pool{thread_count, "net", ThreadPool::Mode::Sharded};
+  GetDefaultIoServiceAccessorInstance().Attach(thread_pool);
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool);
+  GetNetworkServiceAccessorInstance().Attach(thread_pool);
+  GetNetworkSchedulerAccessorInstance().Attach(thread_pool);
+
+  auto server_scheduler =
+      std::make_unique<SequentialScheduler>(GetDefaultIoServiceAccessorInstance().GetRef(), server_scheduler_name);
+  std::unique_ptr<TcpServer> tcp_server;
+  CountDownLatch listening{1u};
+  CountDownLatch stopped{1u};
+  RunAsync(
+      [&] {
+        tcp_server = std::make_unique<TcpServer>(kConnectionCount);
+        tcp_server->SetConnectionSchedulerCount(connection_scheduler_count);
+        tcp_server->SubscribeOnData([&](TcpServerIdType id, const BufferType& data) { tcp_server->Write(id, data); });
+        tcp_server->SubscribeOnListening([&] { listening.CountDown(); });
+        tcp_server->SubscribeOnStopped([&] { stopped.CountDown(); });
+        tcp_server->Start(kServerPort);
+      },
+      *server_scheduler);
+  listening.Wait();
+
+  std::vector<std::shared_ptr<TcpSocket>> clients(kConnectionCount);
+  {
+    CountDownLatch connected{static_cast<std::size_t>(kConnectionCount)};
+    for (auto& client : clients) {
+      RunAsync([&] {
+        client = TcpSocket::Create();
+        client->Connect("127.0.0.1", kServerPort);
+        connected.CountDown();
+      });
+    }
+    connected.Wait();
+  }
+
+  const std::string message(kMessageSize, 'x');
+  for (auto _ : state) {
+    CountDownLatch done{static_cast<std::size_t>(kConnectionCount)};
+    for (auto& client : clients) {
+      RunAsync([&] {
+        for (int i = 0; i < kRoundTripsPerIteration; ++i) {
+          client->Write(message);
+          client->ReadExact(message.size());
+        }
+        done.CountDown();
+      });
+    }
+    done.Wait();
+  }
+
+  for (auto& client : clients) {
+    RunAsync([&] { client->Stop(); });
+  }
+  RunAsync([&] { tcp_server->Stop(); }, *server_scheduler);
+  stopped.Wait();
+  WaitAll();
+  clients.clear();
+  tcp_server.reset();
+  server_scheduler.reset();
+
+  GetNetworkSchedulerAccessorInstance().Detach();
+  GetNetworkServiceAccessorInstance().Detach();
+  GetDefaultSchedulerAccessorInstance().Detach();
+  GetDefaultIoServiceAccessorInstance().Detach();
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kConnectionCount * kRoundTripsPerIteration));
+}
+BENCHMARK(BM_TcpServerEcho)->Apply(EchoArguments)->UseRealTime();
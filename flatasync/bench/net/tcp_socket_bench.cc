@@ -0,0 +1,148 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/helper.h"
+#include "core/thread_pool.h"
+#include "net/acceptor.h"
+#include "net/tcp_socket.h"
+#include "net/util.h"
+
+using rms::core::CountDownLatch;
+using rms::core::GetDefaultIoServiceAccessorInstance;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+using rms::net::Acceptor;
+using rms::net::GetNetworkSchedulerAccessorInstance;
+using rms::net::GetNetworkServiceAccessorInstance;
+using rms::net::TcpSocket;
+
+namespace {
+
+const int kServerPort = 10140;
+
+const int kConnectionCount = 64;
+
+const int kRoundTripsPerIteration = 100;
+
+const std::size_t kMessageSize = 32u;
+
+using ClockType = std::chrono::steady_clock;
+
+void EchoArguments(benchmark::internal::Benchmark* benchmark) {
+  const int max_thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  for (int thread_count = 1; thread_count < max_thread_count; thread_count *= 2) {
+    benchmark->Args({thread_count, kConnectionCount});
+  }
+  benchmark->Args({max_thread_count, kConnectionCount});
+}
+
+double GetPercentile(std::vector<double>& samples, double percentile) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  const auto index = static_cast<std::size_t>(percentile * static_cast<double>(samples.size() - 1u));
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+}  // namespace
+
+template <ThreadPool::Mode mode>
+void BM_TcpSocketEchoRoundTrip(benchmark::State& state) {
+  const auto thread_count = static_cast<std::size_t>(state.range(0));
+  const auto connection_count = static_cast<int>(state.range(1));
+
+  ThreadPool thread_pool{thread_count, "net", mode};
+  GetDefaultIoServiceAccessorInstance().Attach(thread_pool);
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool);
+  GetNetworkServiceAccessorInstance().Attach(thread_pool);
+  GetNetworkSchedulerAccessorInstance().Attach(thread_pool);
+
+  // Server: echo everything back
+  CountDownLatch listening{1u};
+  RunAsync([&] {
+    Acceptor acceptor(kServerPort);
+    listening.CountDown();
+    for (int i = 0; i < connection_count; ++i) {
+      acceptor.DoAccept([](std::shared_ptr<TcpSocket> socket) {
+        while (true) {
+          const auto read_result = socket->ReadPartial();
+          if (read_result.second || read_result.first.IsEmpty()) {
+            break;
+          }
+          socket->Write(read_result.first);
+        }
+      });
+    }
+  });
+  listening.Wait();
+
+  std::vector<std::shared_ptr<TcpSocket>> clients(connection_count);
+  {
+    CountDownLatch connected{static_cast<std::size_t>(connection_count)};
+    for (auto& client : clients) {
+      RunAsync([&] {
+        client = TcpSocket::Create();
+        client->Connect("127.0.0.1", kServerPort);
+        connected.CountDown();
+      });
+    }
+    connected.Wait();
+  }
+
+  const std::string message(kMessageSize, 'x');
+  std::mutex mutex;
+  std::vector<double> latencies;
+  for (auto _ : state) {
+    CountDownLatch done{static_cast<std::size_t>(connection_count)};
+    for (auto& client : clients) {
+      RunAsync([&] {
+        std::vector<double> local_latencies;
+        local_latencies.reserve(kRoundTripsPerIteration);
+        for (int i = 0; i < kRoundTripsPerIteration; ++i) {
+          const auto start = ClockType::now();
+          client->Write(message);
+          client->ReadExact(message.size());
+          local_latencies.push_back(std::chrono::duration<double, std::micro>(ClockType::now() - start).count());
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          latencies.insert(latencies.end(), local_latencies.begin(), local_latencies.end());
+        }
+        done.CountDown();
+      });
+    }
+    done.Wait();
+  }
+
+  for (auto& client : clients) {
+    RunAsync([&] { client->Stop(); });
+  }
+  WaitAll();
+  clients.clear();
+
+  GetNetworkSchedulerAccessorInstance().Detach();
+  GetNetworkServiceAccessorInstance().Detach();
+  GetDefaultSchedulerAccessorInstance().Detach();
+  GetDefaultIoServiceAccessorInstance().Detach();
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * connection_count * kRoundTripsPerIteration));
+  state.counters["p50_us"] = GetPercentile(latencies, 0.5);
+  state.counters["p99_us"] = GetPercentile(latencies, 0.99);
+}
+BENCHMARK_TEMPLATE(BM_TcpSocketEchoRoundTrip, ThreadPool::Mode::Shared)->Apply(EchoArguments)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TcpSocketEchoRoundTrip, ThreadPool::Mode::WorkStealing)->Apply(EchoArguments)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TcpSocketEchoRoundTrip, ThreadPool::Mode::Sharded)->Apply(EchoArguments)->UseRealTime();
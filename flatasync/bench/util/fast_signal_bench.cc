@@ -0,0 +1,60 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include <benchmark/benchmark.h>
+#include <boost/signals2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include "core/helper.h"
+#include "util/fast_signal.h"
+
+using rms::core::GetThreadAllocationCount;
+using rms::util::FastSignal;
+
+namespace {
+
+// Same shape as OnData: receiver and data by reference
+using DataSignature = void(std::int64_t& total, const std::int64_t& data);
+
+struct Boost {
+  using SignalType = boost::signals2::signal<DataSignature>;
+
+  static void Connect(SignalType& signal) {
+    signal.connect([](std::int64_t& total, const std::int64_t& data) { total += data; });
+  }
+};
+
+struct Fast {
+  using SignalType = FastSignal<DataSignature>;
+
+  static void Connect(SignalType& signal) {
+    signal.Connect([](std::int64_t& total, const std::int64_t& data) { total += data; });
+  }
+};
+
+void SubscriberCountArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Arg(1)->Arg(4);
+}
+
+}  // namespace
+
+// Cost of a single emission with range(0) connected slots. Received chunk is dispatched by TcpSocket and then by
+// TcpServer, so it is paid twice per read.
+template <typename Signal>
+void BM_SignalDispatch(benchmark::State& state) {
+  typename Signal::SignalType signal;
+  for (int i = 0; i < state.range(0); ++i) {
+    Signal::Connect(signal);
+  }
+  std::int64_t total = 0;
+  const std::int64_t data = 1;
+  const auto allocation_count = GetThreadAllocationCount();
+  for (auto _ : state) {
+    signal(total, data);
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocs_per_event"] = static_cast<double>(GetThreadAllocationCount() - allocation_count) /
+                                       static_cast<double>(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SignalDispatch, Boost)->Apply(SubscriberCountArguments);
+BENCHMARK_TEMPLATE(BM_SignalDispatch, Fast)->Apply(SubscriberCountArguments);
@@ -0,0 +1,29 @@
+// Copyright [2018] <Malinovsky Rodion>  // NOLINT(build/header_guard)
+
+// Body of the logger benchmarks. Included by several translation units, each of them defines its own
+// FLATASYNC_MIN_LOG_LEVEL before the include, so no include guard.
+
+#include <benchmark/benchmark.h>
+#include "util/logger.h"
+
+namespace {
+
+DECLARE_GET_LOGGER("Bench.Logger")
+
+// Typical hot path function: traces enter\exit and logs a debug line with arguments
+[[gnu::noinline]] int TracedFunction(int value) {
+  LOG_AUTO_TRACE();
+  LOG_DEBUG("Processing value=" << value);
+  return value + 1;
+}
+
+template <typename Setting>
+void BM_LogMacrosOverhead(benchmark::State& state) {
+  int value = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(value = TracedFunction(value));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
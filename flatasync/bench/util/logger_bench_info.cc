@@ -0,0 +1,10 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+// Log lines below INFO are compiled out. Runtime level of benchrunner is ERROR
+#define FLATASYNC_MIN_LOG_LEVEL FLATASYNC_LOG_LEVEL_INFO
+
+#include "util/logger_bench.h"
+
+struct MinLogLevelInfo;
+
+BENCHMARK_TEMPLATE(BM_LogMacrosOverhead, MinLogLevelInfo);
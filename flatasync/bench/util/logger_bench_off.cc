@@ -0,0 +1,28 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+// All log lines are compiled out. Runtime level of benchrunner is ERROR
+#define FLATASYNC_MIN_LOG_LEVEL FLATASYNC_LOG_LEVEL_OFF
+
+#include "util/logger_bench.h"
+
+struct MinLogLevelOff;
+
+BENCHMARK_TEMPLATE(BM_LogMacrosOverhead, MinLogLevelOff);
+
+namespace {
+
+[[gnu::noinline]] int PlainFunction(int value) {
+  return value + 1;
+}
+
+}  // namespace
+
+// Function without log macros, the lower bound for all settings
+void BM_LogMacrosBaseline(benchmark::State& state) {
+  int value = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(value = PlainFunction(value));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogMacrosBaseline);
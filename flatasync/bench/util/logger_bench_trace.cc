@@ -0,0 +1,10 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+// Log lines below TRACE are compiled out. Runtime level of benchrunner is ERROR
+#define FLATASYNC_MIN_LOG_LEVEL FLATASYNC_LOG_LEVEL_TRACE
+
+#include "util/logger_bench.h"
+
+struct MinLogLevelTrace;
+
+BENCHMARK_TEMPLATE(BM_LogMacrosOverhead, MinLogLevelTrace);
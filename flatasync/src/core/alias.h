@@ -5,6 +5,7 @@
 #include <boost/asio.hpp>
 #include <cstdint>
 #include <functional>
+#include "util/inplace_function.h"
 
 namespace rms {
 namespace core {
@@ -13,8 +14,22 @@ using AsioServiceType = boost::asio::io_service;
 using AsioServiceWorkType = boost::asio::io_service::work;
 using AsioServiceStrandType = boost::asio::io_service::strand;
 
-using HandlerType = std::function<void()>;
-using ProceedHandlerType = std::function<void(HandlerType)>;
+#if !defined(FLATASYNC_TASK_INLINE_SIZE)
+#define FLATASYNC_TASK_INLINE_SIZE 64
+#endif
+
+/**
+ * One-shot unit of work: async task body, scheduled handler, deferred operation. Move-only, callables up to
+ * FLATASYNC_TASK_INLINE_SIZE bytes are stored without heap allocation.
+ */
+using Task = util::InplaceFunction<void(), FLATASYNC_TASK_INLINE_SIZE>;
+using HandlerType = Task;
+
+/**
+ * Copyable callback, e.g. continuation of the async task which might be shared between several operations.
+ */
+using CallbackType = std::function<void()>;
+using ProceedHandlerType = util::InplaceFunction<void(CallbackType), FLATASYNC_TASK_INLINE_SIZE>;
 
 using PortType = uint32_t;
 
@@ -8,11 +8,22 @@
 #include "core/async_runner.h"
 #include "core/default_scheduler_accessor.h"
 #include "core/iioservice.h"
+#include "util/metrics.h"
 
 DECLARE_GLOBAL_GET_LOGGER("Core.Async")
 
 using rms::core::AsyncOpState;
 
+namespace {
+
+rms::util::MetricCounter& GetFiredTimeoutCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter(
+      "flatasync_timeouts_fired_total", "Timeouts of async tasks which have expired", {{"backend", "deadline_timer"}});
+  return counter;
+}
+
+}  // namespace
+
 AsyncOpState rms::core::RunAsync(HandlerType handler, IScheduler& scheduler) {
   return AsyncRunner::Create(std::move(handler), scheduler);
 }
@@ -23,7 +34,7 @@ AsyncOpState rms::core::RunAsync(HandlerType handler) {
   return RunAsync(std::move(handler), scheduler);
 }
 
-void rms::core::RunAsyncTimes(int32_t n, HandlerType handler) {
+void rms::core::RunAsyncTimes(int32_t n, CallbackType handler) {
   assert(n > 0);
   RunAsync(n == 1 ? handler : [n, handler = std::move(handler)] {
     for (int32_t i = 0; i < n; ++i) {
@@ -60,6 +71,10 @@ void rms::core::WaitAll() {
   AsyncRunner::WaitAll();
 }
 
+bool rms::core::WaitAll(std::chrono::milliseconds timeout) {
+  return AsyncRunner::WaitAll(timeout);
+}
+
 void rms::core::Defer(HandlerType handler) {
   GetCurrentThreadAsyncRunner().Defer(std::move(handler));
 }
@@ -68,8 +83,8 @@ void rms::core::DeferProceed(ProceedHandlerType proceed) {
   GetCurrentThreadAsyncRunner().DeferProceed(std::move(proceed));
 }
 
-void rms::core::RunAsyncWait(std::initializer_list<HandlerType> handlers) {
-  DeferProceed([handlers](HandlerType proceed) {
+void rms::core::RunAsyncWait(std::initializer_list<CallbackType> handlers) {
+  DeferProceed([handlers](CallbackType proceed) {
     std::shared_ptr<void> proceeder(nullptr, [proceed](void*) { proceed(); });
     for (auto&& handler : handlers) {
       RunAsync([proceeder, handler] { handler(); });
@@ -87,7 +102,7 @@ rms::core::Waiter::~Waiter() {
 
 rms::core::Waiter& rms::core::Waiter::RunAsync(HandlerType handler) {
   auto& holder = proceeder_;
-  core::RunAsync([holder, handler = std::move(handler)] { handler(); });
+  core::RunAsync([holder, handler = std::move(handler)]() mutable { handler(); });
   return *this;
 }
 
@@ -109,11 +124,11 @@ void rms::core::Waiter::init() {
   });
 }
 
-std::size_t rms::core::RunAsyncAnyWait(std::initializer_list<HandlerType> handlers) {
+std::size_t rms::core::RunAsyncAnyWait(std::initializer_list<CallbackType> handlers) {
   assert(handlers.size() >= 1 && "Handlers count must be positive");
 
   std::size_t index = std::numeric_limits<std::size_t>::max();
-  DeferProceed([&handlers, &index](HandlerType proceed) {
+  DeferProceed([&handlers, &index](CallbackType proceed) {
     std::shared_ptr<std::atomic_int> counter = std::make_shared<std::atomic_int>();
     std::size_t i = 0u;
     for (const auto& handler : handlers) {
@@ -131,15 +146,22 @@ std::size_t rms::core::RunAsyncAnyWait(std::initializer_list<HandlerType> handle
   return index;
 }
 
-rms::core::Timeout::Timeout(int ms)
-    : timer_(GetTimeoutServiceAccessorInstance().GetRef().GetAsioService(), boost::posix_time::milliseconds(ms)) {
+rms::core::Timeout::Timeout(int ms) {
   LOG_AUTO_TRACE();
   auto op_state = GetCurrentThreadAsyncRunner().GetOpState();
-  timer_.async_wait([op_state](const boost::system::error_code& error) mutable {
+  auto& timer_wheel_accessor = GetTimerWheelAccessorInstance();
+  if (timer_wheel_accessor.GetIsAttached()) {
+    timer_wheel_ = &timer_wheel_accessor.GetRef();
+    timer_wheel_->Arm(timer_wheel_entry_, std::chrono::milliseconds(ms), std::move(op_state));
+    return;
+  }
+  timer_.emplace(GetTimeoutServiceAccessorInstance().GetRef().GetAsioService(), boost::posix_time::milliseconds(ms));
+  timer_->async_wait([op_state](const boost::system::error_code& error) mutable {
     // mutable, because we change captured state
     LOG_TRACE("Handling timeout. Status: " << error.message());
     if (!error) {
       LOG_TRACE("Operation timedout");
+      GetFiredTimeoutCounter().Increment();
       op_state.Timedout();
     }
   });
@@ -147,9 +169,13 @@ rms::core::Timeout::Timeout(int ms)
 
 rms::core::Timeout::~Timeout() {
   LOG_AUTO_TRACE();
+  if (timer_wheel_ != nullptr) {
+    timer_wheel_->Cancel(timer_wheel_entry_);
+    return;
+  }
   // Use cancel_one with explicit error code to prevent potentian throw from another version of cancel_one
   boost::system::error_code error_code;
-  timer_.cancel_one(error_code);
+  timer_->cancel_one(error_code);
 }
 
 rms::core::IScheduler& rms::core::GetCurrentThreadScheduler() {
@@ -159,3 +185,7 @@ rms::core::IScheduler& rms::core::GetCurrentThreadScheduler() {
 rms::core::IIoService& rms::core::GetCurrentThreadIoService() {
   return GetCurrentThreadAsyncRunner().GetIoService();
 }
+
+rms::core::AsyncOpStateView rms::core::GetCurrentThreadOpStateView() {
+  return GetCurrentThreadAsyncRunner().GetOpStateView();
+}
@@ -5,6 +5,7 @@
 #include <memory>
 
 #include <atomic>
+#include <chrono>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/optional/optional.hpp>
 #include <cstdint>
@@ -14,6 +15,7 @@
 
 #include "core/alias.h"
 #include "core/async_op_state.h"
+#include "core/timer_wheel.h"
 #include "util/logger.h"
 
 namespace rms {
@@ -42,7 +44,7 @@ AsyncOpState RunAsync(HandlerType handler);
  * @param n Exectution count. Must be grate that 0.
  * @param handler Operation to run. Any callable.
  */
-void RunAsyncTimes(int32_t n, HandlerType handler);
+void RunAsyncTimes(int32_t n, CallbackType handler);
 
 /**
  * Switch current execution contect to the new one. Must be called within async operation.
@@ -64,6 +66,13 @@ IScheduler& GetCurrentThreadScheduler();
  */
 IIoService& GetCurrentThreadIoService();
 
+/**
+ * Get view of the state of async operation running on current thread. Gets information from current AsyncRunner.
+ * Assert if no runner is attached.
+ * @return Non-owning view of the state, valid until the async operation finishes.
+ */
+AsyncOpStateView GetCurrentThreadOpStateView();
+
 /**
  * Process pending event in AsyncRunner attached to current thread.
  */
@@ -84,6 +93,13 @@ void EnableEvents();
  */
 void WaitAll();
 
+/**
+ * Block current thread until all async tasks will finish or timeout expires.
+ * @param timeout Max time to wait.
+ * @return True if all async tasks have finished. False on timeout.
+ */
+bool WaitAll(std::chrono::milliseconds timeout);
+
 /**
  * Scope guard for async event. In ctor disables events and automatically enables events on exit.
  */
@@ -101,7 +117,6 @@ class AsyncOpStateGuard {
  */
 void Defer(HandlerType handler);
 
-using ProceedHandlerType = std::function<void(HandlerType)>;
 /**
  * Wraps Defer to execute continuation after current async task is done.
  * @param proceed Operation to execute after current async task will be finished.
@@ -112,7 +127,7 @@ void DeferProceed(ProceedHandlerType proceed);
  * Runs the list of async tasks and waits until all of them will be finished.
  * @param handlers List of async tasks.
  */
-void RunAsyncWait(std::initializer_list<HandlerType> handlers);
+void RunAsyncWait(std::initializer_list<CallbackType> handlers);
 
 /**
  * Helper class which allows to run async task and wait when required until task is finished.
@@ -139,7 +154,7 @@ class Waiter {
 
   void init();
 
-  HandlerType proceed_;
+  CallbackType proceed_;
 
   std::shared_ptr<Waiter> proceeder_;
 };
@@ -149,7 +164,7 @@ class Waiter {
  * @param handlers
  * @return Index of the fist finished async operation.
  */
-std::size_t RunAsyncAnyWait(std::initializer_list<HandlerType> handlers);
+std::size_t RunAsyncAnyWait(std::initializer_list<CallbackType> handlers);
 
 /**
  * Runs the list of async operations, waits and returns result of the first finished operation.
@@ -180,7 +195,7 @@ boost::optional<T> RunAsyncAnyResult(std::initializer_list<std::function<boost::
   };
 
   ResultType result;
-  DeferProceed([handlers = std::move(handlers), &result](HandlerType proceed) {
+  DeferProceed([handlers = std::move(handlers), &result](CallbackType proceed) {
     std::shared_ptr<Counter> counter = std::make_shared<Counter>([&result, proceed](ResultType&& res) {
       result = std::move(res);
       proceed();
@@ -198,17 +213,25 @@ boost::optional<T> RunAsyncAnyResult(std::initializer_list<std::function<boost::
 }
 
 /**
- * Allows to specify timeout for async operation in which it was created.
+ * Allows to specify timeout for async operation in which it was created. Timeout is tracked by the timer wheel if one
+ * is attached (see GetTimerWheelAccessorInstance), by deadline timer on timeout io service otherwise.
  */
 class Timeout {
  public:
   explicit Timeout(int ms);
   ~Timeout();
 
+  Timeout(const Timeout&) = delete;
+  Timeout& operator=(const Timeout&) = delete;
+
  private:
   DECLARE_GET_LOGGER("Core.Async.Timeout")
 
-  boost::asio::deadline_timer timer_;
+  TimerWheel* timer_wheel_ = nullptr;
+
+  TimerWheel::Entry timer_wheel_entry_;
+
+  boost::optional<boost::asio::deadline_timer> timer_;
 };
 
 }  // namespace core
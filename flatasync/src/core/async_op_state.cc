@@ -2,7 +2,10 @@
 
 #include "core/async_op_state.h"
 #include <cassert>
+#include <thread>
+#include <utility>
 #include "util/enum_util.h"
+#include "util/thread_local_pool.h"
 
 using rms::core::AsyncOpStatus;
 using rms::util::enum_util::EnumToString;
@@ -18,39 +21,99 @@ AsyncOpStatus rms::core::AsyncOpStatusException::GetStatus() {
   return status_;
 }
 
-rms::core::AsyncOpState::AsyncOpState() : state_(std::make_shared<State>()) {}
+rms::core::AsyncOpState::AsyncOpState() : state_(new State()) {}
+
+void* rms::core::AsyncOpState::State::operator new(std::size_t size) {
+  assert(size == sizeof(State));
+  static_cast<void>(size);
+  return util::ThreadLocalPool<State>::Allocate();
+}
+
+void rms::core::AsyncOpState::State::operator delete(void* ptr) noexcept {
+  util::ThreadLocalPool<State>::Deallocate(ptr);
+}
+
+void rms::core::AsyncOpState::State::LockCancelHandler() {
+  while (is_cancel_handler_locked.exchange(true, std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+void rms::core::AsyncOpState::State::UnlockCancelHandler() {
+  is_cancel_handler_locked.store(false, std::memory_order_release);
+}
 
 AsyncOpStatus rms::core::AsyncOpState::Reset() {
-  const auto status = GetState().status;
-  GetState().status = AsyncOpStatus::Normal;
-  return status;
+  assert(state_ != nullptr && "Internal state is null");
+  return state_->status.exchange(AsyncOpStatus::Normal, std::memory_order_acq_rel);
 }
 
 bool rms::core::AsyncOpState::Cancel() {
-  return SetStatus(AsyncOpStatus::Cancelled);
+  assert(state_ != nullptr && "Internal state is null");
+  return SetStatus(*state_, AsyncOpStatus::Cancelled);
 }
 
 bool rms::core::AsyncOpState::Timedout() {
-  return SetStatus(AsyncOpStatus::Timedout);
+  assert(state_ != nullptr && "Internal state is null");
+  return SetStatus(*state_, AsyncOpStatus::Timedout);
 }
 
-bool rms::core::AsyncOpState::SetStatus(AsyncOpStatus status) {
-  auto& current_status = GetState().status;
-  if (current_status != AsyncOpStatus::Normal) {
+bool rms::core::AsyncOpState::SetStatus(State& state, AsyncOpStatus status) {
+  auto current_status = AsyncOpStatus::Normal;
+  if (!state.status.compare_exchange_strong(current_status, status, std::memory_order_acq_rel)) {
     LOG_TRACE("Skipping changing status since alredy not Normal: " << EnumToString(current_status));
     return false;
   }
-  LOG_TRACE("Changing status from " << EnumToString(current_status) << " to " << EnumToString(status));
-  current_status = status;
+  LOG_TRACE("Changed status from " << EnumToString(current_status) << " to " << EnumToString(status));
+  state.LockCancelHandler();
+  if (state.cancel_handler) {
+    // Invoked under the lock: owner can't reset handler and destroy its captures meanwhile
+    LOG_TRACE("Invoking cancel handler");
+    state.cancel_handler();
+  }
+  state.UnlockCancelHandler();
   return true;
 }
 
-rms::core::AsyncOpState::State& rms::core::AsyncOpState::GetState() {
+rms::core::AsyncOpStatus rms::core::AsyncOpState::GetStatus() const {
   assert(state_ != nullptr && "Internal state is null");
-  return *state_;
+  return state_->status.load(std::memory_order_acquire);
 }
 
-rms::core::AsyncOpStatus rms::core::AsyncOpState::GetStatus() const {
+rms::core::AsyncOpStateView rms::core::AsyncOpState::GetView() const {
   assert(state_ != nullptr && "Internal state is null");
-  return state_->status;
+  return AsyncOpStateView(*state_);
+}
+
+rms::core::AsyncOpStatus rms::core::AsyncOpStateView::GetStatus() const {
+  return state_->status.load(std::memory_order_acquire);
+}
+
+bool rms::core::AsyncOpStateView::Cancel() const {
+  return AsyncOpState::SetStatus(*state_, AsyncOpStatus::Cancelled);
+}
+
+void rms::core::AsyncOpStateView::SetCancelHandler(CancelHandlerType handler) const {
+  state_->LockCancelHandler();
+  state_->cancel_handler = std::move(handler);
+  state_->UnlockCancelHandler();
+  // Status might have been changed before handler was set: nobody else will invoke it
+  InvokeCancelHandler();
+}
+
+bool rms::core::AsyncOpStateView::InvokeCancelHandler() const {
+  state_->LockCancelHandler();
+  const bool is_invoked = state_->cancel_handler && GetStatus() != AsyncOpStatus::Normal;
+  if (is_invoked) {
+    state_->cancel_handler();
+  }
+  state_->UnlockCancelHandler();
+  return is_invoked;
+}
+
+void rms::core::AsyncOpStateView::ResetCancelHandler() const {
+  CancelHandlerType handler;
+  state_->LockCancelHandler();
+  handler = std::move(state_->cancel_handler);
+  state_->UnlockCancelHandler();
 }
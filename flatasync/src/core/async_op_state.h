@@ -2,8 +2,11 @@
 
 #pragma once
 
-#include <memory>
+#include <boost/intrusive_ptr.hpp>
+#include <atomic>
+#include <cstddef>
 #include <stdexcept>
+#include "core/alias.h"
 #include "util/logger.h"
 
 namespace rms {
@@ -35,8 +38,16 @@ class AsyncOpStatusException : public std::runtime_error {
   AsyncOpStatus status_;
 };
 
+class AsyncOpStateView;
+
+/**
+ * Handler invoked when async operation gets Cancelled or Timedout. Used to abort pending io of the operation.
+ */
+using CancelHandlerType = Task;
+
 /**
- * Class allows to control async operation: Cancel, Timeout etc.
+ * Class allows to control async operation: Cancel, Timeout etc. Status transitions are atomic, so the state can be
+ * changed from any thread while the operation checks it on its own.
  */
 class AsyncOpState {
  public:
@@ -66,18 +77,96 @@ class AsyncOpState {
    */
   AsyncOpStatus GetStatus() const;
 
+  /**
+   * Get non-owning view of the state. View is valid as long as this object is alive.
+   * @return View of the state.
+   */
+  AsyncOpStateView GetView() const;
+
  private:
+  friend class AsyncOpStateView;
+
   DECLARE_GET_LOGGER("Core.Async.AsyncOpState")
 
+  // Intrusively ref counted, memory is taken from per thread pool
   struct State {
-    AsyncOpStatus status = AsyncOpStatus::Normal;
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* ptr) noexcept;
+
+    friend void intrusive_ptr_add_ref(State* state) {
+      state->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    friend void intrusive_ptr_release(State* state) {
+      if (state->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete state;
+      }
+    }
+
+    void LockCancelHandler();
+
+    void UnlockCancelHandler();
+
+    std::atomic<int> ref_count{0};
+
+    std::atomic<AsyncOpStatus> status{AsyncOpStatus::Normal};
+
+    // Spin lock: handler is set and reset around every io operation, contention is rare and short
+    std::atomic<bool> is_cancel_handler_locked{false};
+
+    CancelHandlerType cancel_handler;
   };
 
-  bool SetStatus(AsyncOpStatus status);
+  static bool SetStatus(State& state, AsyncOpStatus status);
+
+  boost::intrusive_ptr<State> state_;
+};
+
+/**
+ * Non-owning view of AsyncOpState. Cheap to copy: does not touch the reference counter.
+ */
+class AsyncOpStateView {
+ public:
+  /**
+   * Get current status
+   * @return Current status.
+   */
+  AsyncOpStatus GetStatus() const;
+
+  /**
+   * Set async operation status to Canceled
+   * @return True if status has been changed, false otherwise.
+   */
+  bool Cancel() const;
+
+  /**
+   * Set handler which is invoked on the thread which changes status from Normal (Cancel, Timedout), e.g. to abort
+   * pending io. If status is not Normal already, handler is invoked immediately. Handler must not set or reset cancel
+   * handler of the same state.
+   * @param handler Handler to be invoked.
+   */
+  void SetCancelHandler(CancelHandlerType handler) const;
+
+  /**
+   * Invoke cancel handler if it is still set and status is not Normal, e.g. to abort io which has been started after
+   * status changed. Handler is invoked under the same lock as ResetCancelHandler, so it never runs after the owner has
+   * removed it.
+   * @return True if handler has been invoked.
+   */
+  bool InvokeCancelHandler() const;
+
+  /**
+   * Remove cancel handler. Waits until handler finishes if it is running, so handler never runs after return.
+   */
+  void ResetCancelHandler() const;
+
+ private:
+  friend class AsyncOpState;
 
-  State& GetState();
+  explicit AsyncOpStateView(AsyncOpState::State& state) : state_(&state) {}
 
-  std::shared_ptr<State> state_;
+  AsyncOpState::State* state_;
 };
 
 }  // namespace core
@@ -3,12 +3,16 @@
 #include "core/async_runner.h"
 #include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <exception>
 #include <functional>
-#include <thread>
+#include <mutex>
 #include <utility>
 #include "core/ischeduler.h"
 #include "util/enum_util.h"
+#include "util/metrics.h"
+#include "util/sharded_counter.h"
+#include "util/thread_local_pool.h"
 #include "util/thread_util.h"
 
 namespace {
@@ -17,18 +21,64 @@ thread_local rms::core::AsyncRunner* thrd_ptr_async_runner = nullptr;
 
 class RunnerCountTag;
 
+using RunnerCounter = rms::util::ShardedCounter<RunnerCountTag>;
+
+// Signalled when the last runner is destroyed
+std::mutex all_done_mutex;
+std::condition_variable all_done_awaiter;
+
+// Runners check aggregated count only if somebody waits for it
+std::atomic<int> all_done_waiters_count{0};
+
+bool IsAllDone() {
+  return RunnerCounter::GetCount() == 0;
+}
+
+rms::util::MetricCounter& GetCreatedRunnerCounter() {
+  static auto& counter = []() -> rms::util::MetricCounter& {
+    auto& registry = rms::util::GetMetricsRegistryInstance();
+    // Live count is aggregated from the sharded counter on scrape only
+    registry.SetGaugeCallback("flatasync_async_runners", "Alive async tasks (coroutines)",
+                              [] { return RunnerCounter::GetCount(); });
+    return registry.GetCounter("flatasync_async_runners_created_total", "Async tasks (coroutines) created");
+  }();
+  return counter;
+}
+
 }  // namespace
 
 rms::core::AsyncRunner::AsyncRunner(IScheduler& scheduler)
-    : is_events_allowed_(true), scheduler_(&scheduler), count_(++util::GetAtomicInstance<RunnerCountTag>()) {
+    : is_events_allowed_(true), scheduler_(&scheduler), counter_slot_(RunnerCounter::Increment()) {
   LOG_AUTO_TRACE();
-  LOG_DEBUG("Created runner. Count=" << count_);
+  GetCreatedRunnerCounter().Increment();
+  LOG_DEBUG("Created runner. Count=" << GetCount());
 }
 
 rms::core::AsyncRunner::~AsyncRunner() {
   LOG_AUTO_TRACE();
-  const auto count = --util::GetAtomicInstance<RunnerCountTag>();
-  LOG_DEBUG("Destroying runner. Count=" << count);
+  const bool is_slot_drained = RunnerCounter::Decrement(counter_slot_);
+  LOG_DEBUG("Destroying runner. Count=" << GetCount());
+  // The last runner always drains its slot. Pairs with the fence in WaitAll: either this runner sees the waiter or
+  // the waiter sees the decrement. Of runners drained concurrently at least one sees decrements of the others, so the
+  // count is aggregated and the waiter is woken up only when all runners are actually done
+  if (is_slot_drained) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (all_done_waiters_count.load(std::memory_order_relaxed) > 0 && IsAllDone()) {
+      // Waiter checks the count under the mutex, thus locking here guarantees the wake up is not lost
+      std::lock_guard<std::mutex> lock(all_done_mutex);
+      all_done_awaiter.notify_all();
+    }
+  }
+}
+
+void* rms::core::AsyncRunner::operator new(std::size_t size) {
+  assert(size == sizeof(AsyncRunner));
+  static_cast<void>(size);
+  return util::ThreadLocalPool<AsyncRunner>::Allocate();
+}
+
+void rms::core::AsyncRunner::operator delete(void* ptr) noexcept {
+  util::ThreadLocalPool<AsyncRunner>::Deallocate(ptr);
 }
 
 void rms::core::AsyncRunner::Proceed() {
@@ -36,7 +86,7 @@ void rms::core::AsyncRunner::Proceed() {
   Schedule([this] { ProceedInternal(); });
 }
 
-rms::core::HandlerType rms::core::AsyncRunner::ProceedHandler() {
+rms::core::CallbackType rms::core::AsyncRunner::ProceedHandler() {
   LOG_AUTO_TRACE();
   return [this] { Proceed(); };
 }
@@ -53,7 +103,13 @@ void rms::core::AsyncRunner::Defer(HandlerType handler) {
 
 void rms::core::AsyncRunner::DeferProceed(ProceedHandlerType proceed) {
   LOG_AUTO_TRACE();
-  Defer([this, proceed = std::move(proceed)] { proceed(ProceedHandler()); });
+  // Kept by the runner, so deferred handler captures this only and fits into Task inline buffer
+  defer_proceed_ = std::move(proceed);
+  Defer([this] {
+    // Coroutine might be resumed and defer again while proceed is running: move it out first
+    auto proceed = std::move(defer_proceed_);
+    proceed(ProceedHandler());
+  });
 }
 
 void rms::core::AsyncRunner::SwitchTo(IScheduler& dst) {
@@ -110,6 +166,14 @@ rms::core::AsyncOpState rms::core::AsyncRunner::GetOpState() const {
   return op_state_;
 }
 
+rms::core::AsyncOpStateView rms::core::AsyncRunner::GetOpStateView() const {
+  return op_state_.GetView();
+}
+
+bool rms::core::AsyncRunner::GetIsEventsAllowed() const {
+  return is_events_allowed_;
+}
+
 rms::core::AsyncOpState rms::core::AsyncRunner::Create(HandlerType handler, IScheduler& scheduler) {
   LOG_AUTO_TRACE();
   // This is not a leak. Start will schedule handler and create
@@ -120,33 +184,39 @@ rms::core::AsyncOpState rms::core::AsyncRunner::Create(HandlerType handler, ISch
 
 void rms::core::AsyncRunner::WaitAll() {
   LOG_AUTO_TRACE();
+  std::unique_lock<std::mutex> lock(all_done_mutex);
+  ++all_done_waiters_count;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  all_done_awaiter.wait(lock, IsAllDone);
+  --all_done_waiters_count;
+  LOG_TRACE("Wait done");
+}
 
-  const auto is_can_break = [&]() {
-    const auto counter = util::GetAtomicInstance<RunnerCountTag>().load();
-    if (counter == 0) {
-      LOG_TRACE("Wait done: count=" << counter);
-      return true;
-    }
-    LOG_TRACE("Keep waiting: count=" << counter);
-    return false;
-  };
-
-  while (true) {
-    std::this_thread::yield();
-    if (is_can_break()) {
-      break;
-    }
-  }
+bool rms::core::AsyncRunner::WaitAll(std::chrono::milliseconds timeout) {
+  LOG_AUTO_TRACE();
+  std::unique_lock<std::mutex> lock(all_done_mutex);
+  ++all_done_waiters_count;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const bool is_done = all_done_awaiter.wait_for(lock, timeout, IsAllDone);
+  --all_done_waiters_count;
+  LOG_TRACE("Wait " << (is_done ? "done" : "timed out"));
+  return is_done;
+}
+
+std::int64_t rms::core::AsyncRunner::GetCount() {
+  return RunnerCounter::GetCount();
 }
 
 rms::core::AsyncOpState rms::core::AsyncRunner::Start(HandlerType handler) {
   LOG_AUTO_TRACE();
   auto op_state = GetOpState();
-  Schedule([handler = std::move(handler), this]() mutable {
-    MakeGuard()->Start([handler = std::move(handler)] {
+  // Handler is kept by the runner, so wrappers capture this only and fit into small buffer of HandlerType
+  handler_ = std::move(handler);
+  Schedule([this] {
+    MakeGuard()->Start([this] {
       LOG_DEBUG("Coroutine started");
       try {
-        handler();
+        handler_();
       } catch (const std::exception& e) {
         LOG_DEBUG("Exception in Deferrer (will not be propagated): " << e.what());
       }
@@ -163,6 +233,16 @@ void rms::core::AsyncRunner::Schedule(HandlerType handler) {
   scheduler_->Schedule(std::move(handler));
 }
 
+rms::core::AsyncRunner::Guard::Guard(AsyncRunner& async_runner) : async_runner_(async_runner) {
+  LOG_AUTO_TRACE();
+  async_runner_.OnEnter();
+}
+
+rms::core::AsyncRunner::Guard::~Guard() {
+  LOG_AUTO_TRACE();
+  async_runner_.OnExit();
+}
+
 rms::core::AsyncRunner::Guard rms::core::AsyncRunner::MakeGuard() {
   LOG_AUTO_TRACE();
   LOG_TRACE("Making guard for this of AsyncRunner");
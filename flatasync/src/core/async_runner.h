@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include "core/alias.h"
 #include "core/async_op_state.h"
 #include "core/coro_helper.h"
@@ -17,6 +20,11 @@ namespace core {
 class IScheduler;
 }
 }  // namespace rms
+namespace rms {
+namespace util {
+class ShardedCounterSlot;
+}
+}  // namespace rms
 
 namespace rms {
 namespace core {
@@ -45,7 +53,7 @@ class AsyncRunner {
    * Return handler which allows to schedule continuation.
    * @return Callable which schedules continuation.
    */
-  HandlerType ProceedHandler();
+  CallbackType ProceedHandler();
 
   /**
    * Schedule to execute operation after current async task will be finished. Building block for writing continuation.
@@ -100,6 +108,18 @@ class AsyncRunner {
    */
   AsyncOpState GetOpState() const;
 
+  /**
+   * Get non-owning view of OpState of the async runner. Valid while the runner is alive.
+   * @return View of OpState of this async runner.
+   */
+  AsyncOpStateView GetOpStateView() const;
+
+  /**
+   * Check whether events (Cancel, Timedout) are processed.
+   * @return True if events are enabled.
+   */
+  bool GetIsEventsAllowed() const;
+
   /**
    * Factory method which creates AsyncRunner with specified handler and scheduler.
    * @param handler Async operation to be executed.
@@ -113,22 +133,35 @@ class AsyncRunner {
    */
   static void WaitAll();
 
+  /**
+   * Blocks current execution and waits until all async tasks will be finished or timeout expires.
+   * @param timeout Max time to wait.
+   * @return True if all async tasks have finished. False on timeout.
+   */
+  static bool WaitAll(std::chrono::milliseconds timeout);
+
+  /**
+   * Get count of alive async runners. Aggregated from per thread counters, so intended for introspection rather than
+   * for hot paths.
+   * @return Count of alive async runners.
+   */
+  static std::int64_t GetCount();
+
  private:
   DECLARE_GET_LOGGER("Core.AsyncRunner")
 
   explicit AsyncRunner(IScheduler& scheduler);
 
+  // Runners are created and destroyed for every async task, memory is taken from per thread pool
+  static void* operator new(std::size_t size);
+
+  static void operator delete(void* ptr) noexcept;
+
   class Guard {
    public:
-    explicit Guard(AsyncRunner& async_runner) : async_runner_(async_runner) {
-      LOG_AUTO_TRACE();
-      async_runner_.OnEnter();
-    }
+    explicit Guard(AsyncRunner& async_runner);
 
-    ~Guard() {
-      LOG_AUTO_TRACE();
-      async_runner_.OnExit();
-    }
+    ~Guard();
 
     CoroHelper* operator->() {
       return &async_runner_.coro_helper_;
@@ -157,14 +190,18 @@ class AsyncRunner {
 
   IScheduler* scheduler_;
 
+  HandlerType handler_;
+
   HandlerType defer_handler_;
 
+  ProceedHandlerType defer_proceed_;
+
   CoroHelper coro_helper_;
 
   /**
    * Used track async ops creation \ deletion
    */
-  const int count_;
+  util::ShardedCounterSlot& counter_slot_;
 };
 
 /**
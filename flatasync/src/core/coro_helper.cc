@@ -5,6 +5,7 @@
 #include <cassert>
 #include <functional>
 #include <utility>
+#include "core/coro_stack_pool.h"
 
 namespace {
 
@@ -51,15 +52,16 @@ rms::core::CoroHelper::~CoroHelper() {
   ptr_yield_ = nullptr;
 }
 
-rms::core::CoroHelper::CoroHelper(HandlerType handler)
-    : handler_(std::move(handler)), ptr_yield_(nullptr), coro_(MakeCoroAndAutoStart()) {}
+rms::core::CoroHelper::CoroHelper(HandlerType handler) : handler_(std::move(handler)), ptr_yield_(nullptr) {
+  MakeCoroAndAutoStart();
+}
 
 void rms::core::CoroHelper::Start(HandlerType handler) {
   LOG_AUTO_TRACE();
   handler_ = std::move(handler);
   ptr_yield_ = nullptr;
   coro_.reset();
-  coro_ = MakeCoroAndAutoStart();
+  MakeCoroAndAutoStart();
 }
 
 void rms::core::CoroHelper::Yield() {
@@ -91,11 +93,11 @@ void rms::core::CoroHelper::Resume() {
   }
 }
 
-rms::core::CoroHelper::CoroPullType rms::core::CoroHelper::MakeCoroAndAutoStart() {
+void rms::core::CoroHelper::MakeCoroAndAutoStart() {
   // ASAN doesn't like the logging below
   LOG_AUTO_TRACE();
-  // CTor fires coro
-  return std::make_unique<CoroType::pull_type>([this](CoroType::push_type& yield) {
+  // CTor fires coro. Stack is taken from the per thread pool, so no allocation in steady state
+  coro_.emplace(CoroStackPool{}, [this](CoroType::push_type& yield) {
     // ASAN doesn't like the logging below
     ptr_yield_ = &yield;
     LOG_TRACE("Creating guard for this coro");
@@ -1,7 +1,7 @@
 // Copyright [2018] <Malinovsky Rodion>
 
 #include <boost/coroutine2/all.hpp>
-#include <memory>
+#include <boost/optional/optional.hpp>
 #include "core/alias.h"
 #include "util/logger.h"
 
@@ -55,9 +55,10 @@ class CoroHelper {
   DECLARE_GET_LOGGER("Core.CoroHelper")
 
   using CoroType = boost::coroutines2::coroutine<void>;
-  using CoroPullType = std::unique_ptr<CoroType::pull_type>;
+  // Kept in place to avoid heap allocation per coroutine
+  using CoroPullType = boost::optional<CoroType::pull_type>;
 
-  CoroPullType MakeCoroAndAutoStart();
+  void MakeCoroAndAutoStart();
 
   HandlerType handler_;
 
@@ -0,0 +1,143 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/coro_stack_pool.h"
+#include <boost/context/protected_fixedsize_stack.hpp>
+#include <boost/context/stack_traits.hpp>
+#include <atomic>
+#include <vector>
+#include "util/metrics.h"
+
+namespace {
+
+using StackType = boost::context::stack_context;
+using AllocatorType = boost::context::protected_fixedsize_stack;
+
+std::atomic<std::size_t> configured_stack_size{boost::context::stack_traits::default_size()};
+
+std::atomic<std::size_t> max_cached_stacks{64u};
+
+// Counters are striped, allocations on different threads do not contend on a single cache line
+rms::util::MetricCounter& GetHitsCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter(
+      "flatasync_coro_stack_cache_hits_total", "Coroutine stacks reused from the per thread cache");
+  return counter;
+}
+
+rms::util::MetricCounter& GetMissesCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter(
+      "flatasync_coro_stack_cache_misses_total", "Coroutine stacks allocated as the per thread cache was empty");
+  return counter;
+}
+
+// Values of the counters at the last ResetStatistics, touched by GetStatistics and ResetStatistics only
+std::atomic<std::uint64_t> hits_reset_value{0u};
+
+std::atomic<std::uint64_t> misses_reset_value{0u};
+
+class StackCache {
+ public:
+  struct Entry {
+    std::size_t stack_size;
+    StackType stack;
+  };
+
+  ~StackCache() {
+    Clear();
+  }
+
+  bool Pop(std::size_t stack_size, StackType& stack) {
+    while (!entries_.empty()) {
+      auto entry = entries_.back();
+      entries_.pop_back();
+      if (entry.stack_size == stack_size) {
+        stack = entry.stack;
+        return true;
+      }
+      // Stack size has been changed since this stack was cached
+      AllocatorType{entry.stack_size}.deallocate(entry.stack);
+    }
+    return false;
+  }
+
+  bool Push(std::size_t stack_size, StackType& stack) {
+    if (entries_.size() >= max_cached_stacks.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    entries_.push_back(Entry{stack_size, stack});
+    return true;
+  }
+
+  std::size_t GetCount() const {
+    return entries_.size();
+  }
+
+  void Clear() {
+    for (auto& entry : entries_) {
+      AllocatorType{entry.stack_size}.deallocate(entry.stack);
+    }
+    entries_.clear();
+  }
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+thread_local StackCache thrd_stack_cache;
+
+}  // namespace
+
+rms::core::CoroStackPool::CoroStackPool() : stack_size_(configured_stack_size.load(std::memory_order_relaxed)) {}
+
+boost::context::stack_context rms::core::CoroStackPool::allocate() {
+  StackType stack;
+  if (thrd_stack_cache.Pop(stack_size_, stack)) {
+    GetHitsCounter().Increment();
+    return stack;
+  }
+  GetMissesCounter().Increment();
+  return AllocatorType{stack_size_}.allocate();
+}
+
+void rms::core::CoroStackPool::deallocate(boost::context::stack_context& stack) {
+  // Coroutine might be destroyed on another thread than created, stack just migrates to the cache of that thread
+  const bool is_size_changed = stack_size_ != configured_stack_size.load(std::memory_order_relaxed);
+  if (is_size_changed || !thrd_stack_cache.Push(stack_size_, stack)) {
+    AllocatorType{stack_size_}.deallocate(stack);
+  }
+}
+
+void rms::core::CoroStackPool::SetStackSize(std::size_t stack_size) {
+  configured_stack_size.store(stack_size, std::memory_order_relaxed);
+}
+
+std::size_t rms::core::CoroStackPool::GetStackSize() {
+  return configured_stack_size.load(std::memory_order_relaxed);
+}
+
+void rms::core::CoroStackPool::SetMaxCachedStacks(std::size_t count) {
+  max_cached_stacks.store(count, std::memory_order_relaxed);
+}
+
+std::size_t rms::core::CoroStackPool::GetMaxCachedStacks() {
+  return max_cached_stacks.load(std::memory_order_relaxed);
+}
+
+std::size_t rms::core::CoroStackPool::GetCachedStacksCount() {
+  return thrd_stack_cache.GetCount();
+}
+
+void rms::core::CoroStackPool::ReleaseCachedStacks() {
+  thrd_stack_cache.Clear();
+}
+
+rms::core::CoroStackPool::Statistics rms::core::CoroStackPool::GetStatistics() {
+  Statistics statistics;
+  statistics.hits = GetHitsCounter().GetValue() - hits_reset_value.load(std::memory_order_relaxed);
+  statistics.misses = GetMissesCounter().GetValue() - misses_reset_value.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+void rms::core::CoroStackPool::ResetStatistics() {
+  hits_reset_value.store(GetHitsCounter().GetValue(), std::memory_order_relaxed);
+  misses_reset_value.store(GetMissesCounter().GetValue(), std::memory_order_relaxed);
+}
@@ -0,0 +1,102 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <boost/context/stack_context.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace rms {
+namespace core {
+
+/**
+ * Stack allocator for coroutines which keeps released stacks in per thread cache and reuses them for new coroutines,
+ * so steady state coroutine creation does not touch mmap\munmap. Stacks are allocated with guard page (based on
+ * boost::context::protected_fixedsize_stack). Satisfies StackAllocator concept of Boost::Context.
+ */
+class CoroStackPool {
+ public:
+  /**
+   * Pool usage statistics. Accumulated over all threads.
+   */
+  struct Statistics {
+    /**
+     * Count of allocations served from the cache.
+     */
+    std::uint64_t hits = 0u;
+
+    /**
+     * Count of allocations which required new stack.
+     */
+    std::uint64_t misses = 0u;
+  };
+
+  /**
+   * Create allocator which uses stack size configured at the moment of creation.
+   */
+  CoroStackPool();
+
+  /**
+   * Get stack either from the cache of current thread or allocate new one.
+   * @return Allocated stack.
+   */
+  boost::context::stack_context allocate();  // NOLINT
+
+  /**
+   * Return stack to the cache of current thread. Stack is released if cache is full or stack size has been changed.
+   * @param stack Stack previously allocated with allocate().
+   */
+  void deallocate(boost::context::stack_context& stack);  // NOLINT
+
+  /**
+   * Set size of stack for newly created coroutines. Cached stacks of other size are released lazily.
+   * @param stack_size Stack size in bytes, guard page is not included.
+   */
+  static void SetStackSize(std::size_t stack_size);
+
+  /**
+   * Get size of stack for newly created coroutines.
+   * @return Stack size in bytes.
+   */
+  static std::size_t GetStackSize();
+
+  /**
+   * Set max count of cached stacks per thread. 0 disables caching.
+   * @param count Max count of stacks kept by every thread.
+   */
+  static void SetMaxCachedStacks(std::size_t count);
+
+  /**
+   * Get max count of cached stacks per thread.
+   * @return Max count of stacks kept by every thread.
+   */
+  static std::size_t GetMaxCachedStacks();
+
+  /**
+   * Get count of stacks cached by current thread.
+   * @return Count of cached stacks.
+   */
+  static std::size_t GetCachedStacksCount();
+
+  /**
+   * Release all stacks cached by current thread.
+   */
+  static void ReleaseCachedStacks();
+
+  /**
+   * Get hits\misses counters.
+   * @return Statistics accumulated since start or last reset.
+   */
+  static Statistics GetStatistics();
+
+  /**
+   * Reset hits\misses counters.
+   */
+  static void ResetStatistics();
+
+ private:
+  std::size_t stack_size_;
+};
+
+}  // namespace core
+}  // namespace rms
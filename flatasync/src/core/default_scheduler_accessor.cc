@@ -10,6 +10,10 @@ rms::core::TimeoutServiceAccessor& rms::core::GetTimeoutServiceAccessorInstance(
   return rms::util::single<TimeoutServiceAccessor>();
 }
 
+rms::core::TimerWheelAccessor& rms::core::GetTimerWheelAccessorInstance() {
+  return rms::util::single<TimerWheelAccessor>();
+}
+
 rms::core::IoSchedulerAccessor& rms::core::GetDefaultSchedulerAccessorInstance() {
   return rms::util::single<IoSchedulerAccessor>();
 }
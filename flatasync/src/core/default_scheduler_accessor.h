@@ -14,6 +14,11 @@ namespace core {
 class IScheduler;
 }
 }  // namespace rms
+namespace rms {
+namespace core {
+class TimerWheel;
+}
+}  // namespace rms
 
 namespace rms {
 namespace core {
@@ -33,6 +38,13 @@ using TimeoutServiceAccessor = rms::util::SingleAccessor<IIoService, TimeoutTag>
  */
 TimeoutServiceAccessor& GetTimeoutServiceAccessorInstance();
 
+using TimerWheelAccessor = rms::util::SingleAccessor<TimerWheel>;
+/**
+ * Gets reference to timer wheel (singleton). If attached, it tracks timeouts instead of timeout io service.
+ * @return Reference to timer wheel.
+ */
+TimerWheelAccessor& GetTimerWheelAccessorInstance();
+
 using IoSchedulerAccessor = rms::util::SingleAccessor<IScheduler>;
 /**
  * Gets reference to default scheduler (singleton).
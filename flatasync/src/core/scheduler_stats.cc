@@ -0,0 +1,64 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/scheduler_stats.h"
+#include <atomic>
+#include <cstdint>
+#include "util/metrics.h"
+
+namespace {
+
+// Longer waits and runs are counted as this one
+const std::uint64_t kHighestTimeNs = 60ull * 1000u * 1000u * 1000u;
+
+std::atomic_bool is_stats_enabled{false};
+
+thread_local rms::util::MetricCounter* thrd_busy_counter = nullptr;
+
+std::uint64_t ToNanoseconds(rms::core::SchedulerStats::ClockType::duration duration) {
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+}  // namespace
+
+rms::core::SchedulerStats::SchedulerStats(const char* scheduler_name)
+    : queue_wait_histogram_(&util::GetMetricsRegistryInstance().GetHistogram(
+          "flatasync_scheduler_queue_wait_nanoseconds",
+          "Time tasks wait in the queue of the scheduler, recorded while scheduler stats are enabled",
+          kHighestTimeNs,
+          {{"scheduler", scheduler_name}}))
+    , run_time_histogram_(&util::GetMetricsRegistryInstance().GetHistogram(
+          "flatasync_scheduler_run_time_nanoseconds",
+          "Time tasks of the scheduler run, recorded while scheduler stats are enabled",
+          kHighestTimeNs,
+          {{"scheduler", scheduler_name}})) {}
+
+void rms::core::SchedulerStats::SetIsEnabled(bool is_enabled) {
+  is_stats_enabled.store(is_enabled, std::memory_order_relaxed);
+}
+
+bool rms::core::SchedulerStats::GetIsEnabled() {
+  return is_stats_enabled.load(std::memory_order_relaxed);
+}
+
+rms::core::SchedulerStats::ClockType::time_point rms::core::SchedulerStats::GetScheduleTime() {
+  return GetIsEnabled() ? ClockType::now() : ClockType::time_point();
+}
+
+void rms::core::SchedulerStats::Run(HandlerType& handler, ClockType::time_point schedule_time) const {
+  if (schedule_time == ClockType::time_point()) {
+    handler();
+    return;
+  }
+  const auto start_time = ClockType::now();
+  handler();
+  const auto run_time = ToNanoseconds(ClockType::now() - start_time);
+  queue_wait_histogram_->Record(ToNanoseconds(start_time - schedule_time));
+  run_time_histogram_->Record(run_time);
+  if (thrd_busy_counter != nullptr) {
+    thrd_busy_counter->Increment(run_time);
+  }
+}
+
+void rms::core::SchedulerStats::SetCurrentThreadBusyCounter(util::MetricCounter* counter) {
+  thrd_busy_counter = counter;
+}
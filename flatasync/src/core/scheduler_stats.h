@@ -0,0 +1,72 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <chrono>
+#include "core/alias.h"
+
+namespace rms {
+namespace util {
+class MetricCounter;
+class MetricHistogram;
+}  // namespace util
+}  // namespace rms
+
+namespace rms {
+namespace core {
+
+/**
+ * Optional instrumentation of a scheduler. While enabled, tasks are timestamped by Schedule and time they wait in the
+ * queue and run is recorded to histograms of the metrics registry labelled by the scheduler name, run time is also
+ * added to busy time of the pool thread which runs the task. Disabled by default: a task is timed only if stats were
+ * enabled when it was scheduled, otherwise it costs a single check. Copyable, histograms are owned by the registry.
+ */
+class SchedulerStats {
+ public:
+  using ClockType = std::chrono::steady_clock;
+
+  /**
+   * Bind stats to histograms of the scheduler, schedulers of the same name share them.
+   * @param scheduler_name Name of the scheduler.
+   */
+  explicit SchedulerStats(const char* scheduler_name);
+
+  /**
+   * Enable or disable timing of tasks of all schedulers.
+   * @param is_enabled True to time tasks scheduled from now on.
+   */
+  static void SetIsEnabled(bool is_enabled);
+
+  /**
+   * Check whether tasks are timed.
+   * @return True if enabled.
+   */
+  static bool GetIsEnabled();
+
+  /**
+   * Get schedule time of a task to be passed to Run.
+   * @return Current time if stats are enabled, default time point otherwise: task is not timed.
+   */
+  static ClockType::time_point GetScheduleTime();
+
+  /**
+   * Run task and record its queue wait and run time if it has been timed.
+   * @param handler Task to run.
+   * @param schedule_time Time returned by GetScheduleTime when the task was scheduled.
+   */
+  void Run(HandlerType& handler, ClockType::time_point schedule_time) const;
+
+  /**
+   * Set counter of busy time of the current thread, run time of timed tasks is added to it.
+   * @param counter Counter of nanoseconds, nullptr to stop counting.
+   */
+  static void SetCurrentThreadBusyCounter(util::MetricCounter* counter);
+
+ private:
+  util::MetricHistogram* queue_wait_histogram_;
+
+  util::MetricHistogram* run_time_histogram_;
+};
+
+}  // namespace core
+}  // namespace rms
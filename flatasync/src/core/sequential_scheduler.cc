@@ -6,13 +6,38 @@
 #include <utility>
 #include "core/iioservice.h"
 
+namespace {
+
+// Task posted while scheduler stats are enabled
+struct TimedTask {
+  void operator()() {
+    stats.Run(handler, schedule_time);
+  }
+
+  rms::core::SchedulerStats stats;
+
+  rms::core::SchedulerStats::ClockType::time_point schedule_time;
+
+  rms::core::HandlerType handler;
+};
+
+}  // namespace
+
 rms::core::SequentialScheduler::SequentialScheduler(IIoService& service, const char* name)
-    : strand_(service.GetAsioService()), strand_name_(name) {}
+    : strand_(service.GetAsioService()), strand_name_(name), stats_(name) {}
 
 void rms::core::SequentialScheduler::Schedule(HandlerType handler) {
-  strand_.post(std::move(handler));
+  if (SchedulerStats::GetIsEnabled()) {
+    boost::asio::post(strand_, TimedTask{stats_, SchedulerStats::ClockType::now(), std::move(handler)});
+    return;
+  }
+  boost::asio::post(strand_, std::move(handler));
 }
 
 const char* rms::core::SequentialScheduler::GetName() const {
   return strand_name_;
 }
+
+rms::core::AsioServiceType& rms::core::SequentialScheduler::GetAsioService() {
+  return strand_.context();
+}
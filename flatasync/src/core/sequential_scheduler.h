@@ -4,6 +4,7 @@
 
 #include "core/alias.h"
 #include "core/ischeduler.h"
+#include "core/scheduler_stats.h"
 
 namespace rms {
 namespace core {
@@ -43,10 +44,18 @@ class SequentialScheduler : public IScheduler {
    */
   const char* GetName() const override;
 
+  /**
+   * Get asio io service the scheduler runs on. In Sharded mode this is the shard the scheduler is bound to.
+   * @return Asio io service of the scheduler.
+   */
+  AsioServiceType& GetAsioService();
+
  private:
   AsioServiceStrandType strand_;
 
   const char* strand_name_;
+
+  const SchedulerStats stats_;
 };
 
 }  // namespace core
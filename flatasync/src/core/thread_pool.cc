@@ -2,35 +2,167 @@
 
 #include "core/thread_pool.h"
 #include <boost/asio.hpp>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
 #include <utility>
+#include "core/work_stealing_queue.h"
 #include "util/logger.h"
+#include "util/metrics.h"
+#include "util/scope_guard.h"
+#include "util/thread_local_pool.h"
 #include "util/thread_util.h"
 
 DECLARE_GLOBAL_GET_LOGGER("Core.ThreadPool")
 
-rms::core::ThreadPool::ThreadPool(const std::size_t thread_count, const char* name)
+// Task scheduled to the local queue of a work stealing worker
+struct rms::core::detail::ThreadPoolTask {
+  HandlerType handler;
+
+  SchedulerStats::ClockType::time_point schedule_time;
+};
+
+namespace {
+
+// Worker checks io service after this amount of local tasks, so io completions and external tasks are not starved
+const std::size_t kIoPollInterval = 61u;
+
+using rms::core::HandlerType;
+using rms::core::SchedulerStats;
+using rms::core::detail::ThreadPoolTask;
+using TaskPoolType = rms::util::ThreadLocalPool<ThreadPoolTask>;
+
+// Local tasks are allocated for every Schedule, memory is taken from per thread pool
+ThreadPoolTask* NewTask(HandlerType&& handler, SchedulerStats::ClockType::time_point schedule_time) {
+  return new (TaskPoolType::Allocate()) ThreadPoolTask{std::move(handler), schedule_time};
+}
+
+void DeleteTask(ThreadPoolTask* task) {
+  if (task != nullptr) {
+    task->~ThreadPoolTask();
+    TaskPoolType::Deallocate(task);
+  }
+}
+
+struct TaskDeleter {
+  void operator()(ThreadPoolTask* task) const {
+    DeleteTask(task);
+  }
+};
+
+using TaskHolderType = std::unique_ptr<ThreadPoolTask, TaskDeleter>;
+
+// Task posted to asio io service, counts its start
+struct PostedTask {
+  void operator()() {
+    started_counter->Increment();
+    stats.Run(handler, schedule_time);
+  }
+
+  rms::util::MetricCounter* started_counter;
+
+  SchedulerStats stats;
+
+  SchedulerStats::ClockType::time_point schedule_time;
+
+  HandlerType handler;
+};
+
+rms::util::MetricCounter& GetPoolCounter(const char* name, const char* help, const char* pool_name) {
+  return rms::util::GetMetricsRegistryInstance().GetCounter(name, help, {{"pool", pool_name}});
+}
+
+}  // namespace
+
+struct rms::core::ThreadPool::Worker {
+  Worker(ThreadPool& owner, std::size_t index) : owner(owner), index(index), random_state(index * 2654435761u + 1u) {}
+
+  std::size_t NextRandom() {
+    // xorshift32: cheap random victim selection
+    random_state ^= random_state << 13u;
+    random_state ^= random_state >> 17u;
+    random_state ^= random_state << 5u;
+    return random_state;
+  }
+
+  ThreadPool& owner;
+
+  const std::size_t index;
+
+  std::uint32_t random_state;
+
+  std::atomic<detail::ThreadPoolTask*> lifo_slot{nullptr};
+
+  WorkStealingQueue<detail::ThreadPoolTask*> queue;
+};
+
+struct rms::core::ThreadPool::Shard {
+  explicit Shard(ThreadPool& owner) : owner(owner), work(std::make_unique<AsioServiceWorkType>(asio_service)) {}
+
+  ThreadPool& owner;
+
+  AsioServiceType asio_service;
+
+  std::unique_ptr<AsioServiceWorkType> work;
+};
+
+thread_local rms::core::ThreadPool::Worker* rms::core::ThreadPool::current_worker_ = nullptr;
+
+thread_local rms::core::ThreadPool::Shard* rms::core::ThreadPool::current_shard_ = nullptr;
+
+rms::core::ThreadPool::ThreadPool(const std::size_t thread_count, const char* name, Mode mode)
     : name_(name)
+    , mode_(mode)
+    , scheduled_counter_(GetPoolCounter(
+          "flatasync_thread_pool_scheduled_tasks_total", "Tasks scheduled to thread pools", name))
+    , started_counter_(
+          GetPoolCounter("flatasync_thread_pool_started_tasks_total", "Tasks started by thread pools", name))
+    , stats_(name)
     , asio_service_()
     , work_(std::make_unique<AsioServiceWorkType>(asio_service_))
     , barrier_(thread_count + 1u) {
   LOG_AUTO_TRACE();
+  auto& scheduled_counter = scheduled_counter_;
+  auto& started_counter = started_counter_;
+  util::GetMetricsRegistryInstance().SetGaugeCallback(
+      "flatasync_thread_pool_queued_tasks",
+      "Tasks scheduled to thread pools and not started yet",
+      [&scheduled_counter, &started_counter] {
+        // Stripes are read without synchronization with the workers, start might be seen before its schedule
+        const auto started = started_counter.GetValue();
+        const auto scheduled = scheduled_counter.GetValue();
+        return scheduled > started ? static_cast<std::int64_t>(scheduled - started) : std::int64_t{0};
+      },
+      {{"pool", name_}});
+  if (mode_ == Mode::WorkStealing) {
+    workers_.reserve(thread_count);
+    for (std::size_t i = 0u; i < thread_count; ++i) {
+      workers_.emplace_back(std::make_unique<Worker>(*this, i));
+    }
+  } else if (mode_ == Mode::Sharded) {
+    shards_.reserve(thread_count);
+    for (std::size_t i = 0u; i < thread_count; ++i) {
+      shards_.emplace_back(std::make_unique<Shard>(*this));
+    }
+  }
   threads_.reserve(thread_count);
   for (std::size_t i = 0u; i < thread_count; ++i) {
     threads_.emplace_back(util::ThreadUtil::CreateThread(
-        [this] {
+        [this, i] {
           util::ThreadUtil::SetCurrentThreadIoService(*this);
+          SchedulerStats::SetCurrentThreadBusyCounter(&util::GetMetricsRegistryInstance().GetCounter(
+              "flatasync_thread_pool_worker_busy_nanoseconds_total",
+              "Time pool threads run tasks, counted while scheduler stats are enabled",
+              {{"pool", name_}, {"worker", std::to_string(i)}}));
+          auto guard = util::MakeScopeGuard([] { SchedulerStats::SetCurrentThreadBusyCounter(nullptr); });
           barrier_.wait();
-          while (true) {
-            asio_service_.run();
-            std::unique_lock<std::mutex> lock(mutex_);
-            if (stopped_) {
-              break;
-            }
-            if (!work_) {
-              work_ = std::make_unique<AsioServiceWorkType>(asio_service_);
-              asio_service_.reset();
-              awaiter_.notify_all();
-            }
+          if (mode_ == Mode::WorkStealing) {
+            RunWorkStealing(*workers_[i]);
+          } else if (mode_ == Mode::Sharded) {
+            RunSharded(*shards_[i]);
+          } else {
+            RunShared();
           }
         },
         name_));
@@ -45,24 +177,54 @@ rms::core::ThreadPool::~ThreadPool() {
     std::lock_guard<std::mutex> lock(mutex_);
     stopped_ = true;
     work_.reset();
+    for (auto&& shard : shards_) {
+      shard->work.reset();
+    }
+    shard_awaiter_.notify_all();
   }
   asio_service_.stop();
+  for (auto&& shard : shards_) {
+    shard->asio_service.stop();
+  }
   LOG_DEBUG(GetName() << ": Stopping thread pool");
   for (auto&& item : threads_) {
     item.join();
   }
+  for (auto&& worker : workers_) {
+    TaskHolderType task(worker->lifo_slot.exchange(nullptr));
+    ThreadPoolTask* queued_task = nullptr;
+    while (worker->queue.Pop(queued_task)) {
+      DeleteTask(queued_task);
+    }
+  }
   LOG_DEBUG(GetName() << ": Thread pool stopped");
 }
 
 void rms::core::ThreadPool::Schedule(HandlerType handler) {
   LOG_AUTO_TRACE();
-  asio_service_.post(std::move(handler));
+  scheduled_counter_.Increment();
+  const auto schedule_time = SchedulerStats::GetScheduleTime();
+  if (current_worker_ != nullptr && &current_worker_->owner == this) {
+    ScheduleLocal(*current_worker_, std::move(handler), schedule_time);
+    return;
+  }
+  PostedTask task{&started_counter_, stats_, schedule_time, std::move(handler)};
+  if (mode_ == Mode::Sharded) {
+    boost::asio::post(GetCurrentOrNextShard().asio_service, std::move(task));
+    return;
+  }
+  // Free function post accepts move-only handlers
+  boost::asio::post(asio_service_, std::move(task));
 }
 
 void rms::core::ThreadPool::Wait() {
   LOG_AUTO_TRACE();
   std::unique_lock<std::mutex> lock(mutex_);
   work_.reset();
+  if (mode_ == Mode::Sharded) {
+    WaitShards(lock);
+    return;
+  }
   while (true) {
     awaiter_.wait(lock);
     LOG_DEBUG(GetName() << ": Wait completed: " << (work_ != nullptr));
@@ -76,6 +238,180 @@ const char* rms::core::ThreadPool::GetName() const {
   return name_;
 }
 
+rms::core::ThreadPool::Mode rms::core::ThreadPool::GetMode() const {
+  return mode_;
+}
+
 rms::core::AsioServiceType& rms::core::ThreadPool::GetAsioService() {
+  if (mode_ == Mode::Sharded) {
+    return GetNextShard().asio_service;
+  }
   return asio_service_;
 }
+
+void rms::core::ThreadPool::RunShared() {
+  while (true) {
+    asio_service_.run();
+    if (!RestartOnOutOfWork()) {
+      break;
+    }
+  }
+}
+
+void rms::core::ThreadPool::RunWorkStealing(Worker& worker) {
+  current_worker_ = &worker;
+  auto guard = util::MakeScopeGuard([] { current_worker_ = nullptr; });
+  std::size_t tick = 0u;
+  while (true) {
+    if ((++tick % kIoPollInterval) != 0u && RunLocalTask(worker)) {
+      continue;
+    }
+    if (asio_service_.poll_one() != 0u) {
+      continue;
+    }
+    if (RunLocalTask(worker) || StealTask(worker)) {
+      continue;
+    }
+    ++idle_count_;
+    // Re-check after announcing idleness: task might have been pushed before producer has seen idle worker
+    if (StealTask(worker)) {
+      --idle_count_;
+      continue;
+    }
+    // Sleep inside io service: wakes up on io completion, external task or wake up from ScheduleLocal
+    const auto executed = asio_service_.run_one();
+    --idle_count_;
+    if (executed == 0u && !RestartOnOutOfWork()) {
+      break;
+    }
+  }
+}
+
+void rms::core::ThreadPool::RunSharded(Shard& shard) {
+  current_shard_ = &shard;
+  auto guard = util::MakeScopeGuard([] { current_shard_ = nullptr; });
+  while (true) {
+    const auto executed_count = shard.asio_service.run();
+    if (!RestartShardOnOutOfWork(shard, executed_count)) {
+      break;
+    }
+  }
+}
+
+rms::core::ThreadPool::Shard& rms::core::ThreadPool::GetCurrentOrNextShard() {
+  if (current_shard_ != nullptr && &current_shard_->owner == this) {
+    return *current_shard_;
+  }
+  return GetNextShard();
+}
+
+rms::core::ThreadPool::Shard& rms::core::ThreadPool::GetNextShard() {
+  return *shards_[next_shard_++ % shards_.size()];
+}
+
+void rms::core::ThreadPool::ScheduleLocal(Worker& worker,
+                                          HandlerType handler,
+                                          SchedulerStats::ClockType::time_point schedule_time) {
+  ++pending_count_;
+  auto* previous = worker.lifo_slot.exchange(NewTask(std::move(handler), schedule_time));
+  if (previous != nullptr) {
+    worker.queue.Push(previous);
+  }
+  if (idle_count_.load() != 0u) {
+    // Wake up one sleeping worker so it can steal the task
+    asio_service_.post([] {});
+  }
+}
+
+bool rms::core::ThreadPool::RunLocalTask(Worker& worker) {
+  auto* task = worker.lifo_slot.exchange(nullptr);
+  if (task == nullptr && !worker.queue.Pop(task)) {
+    return false;
+  }
+  RunTask(task);
+  return true;
+}
+
+bool rms::core::ThreadPool::StealTask(Worker& worker) {
+  const auto count = workers_.size();
+  const auto start = worker.NextRandom() % count;
+  ThreadPoolTask* task = nullptr;
+  for (std::size_t i = 0u; i < count; ++i) {
+    auto& victim = *workers_[(start + i) % count];
+    if (&victim == &worker) {
+      continue;
+    }
+    // Take LIFO slot as well: task in it might be awaited by the busy victim
+    if (victim.queue.Steal(task) || (task = victim.lifo_slot.exchange(nullptr)) != nullptr) {
+      RunTask(task);
+      return true;
+    }
+  }
+  return false;
+}
+
+void rms::core::ThreadPool::RunTask(detail::ThreadPoolTask* task) {
+  TaskHolderType holder(task);
+  started_counter_.Increment();
+  auto guard = util::MakeScopeGuard([this] { --pending_count_; });
+  stats_.Run(holder->handler, holder->schedule_time);
+}
+
+bool rms::core::ThreadPool::RestartOnOutOfWork() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (stopped_) {
+    return false;
+  }
+  if (!work_) {
+    asio_service_.reset();
+    if (pending_count_.load() == 0u) {
+      work_ = std::make_unique<AsioServiceWorkType>(asio_service_);
+      awaiter_.notify_all();
+    }
+  }
+  return true;
+}
+
+void rms::core::ThreadPool::WaitShards(std::unique_lock<std::mutex>& lock) {
+  for (auto&& shard : shards_) {
+    shard->work.reset();
+  }
+  // Shard which has run out of work might get it again from a busy one, e.g. through a sequential scheduler or a socket
+  // bound to it. So shards run until out of work round by round, pool is done once none has executed anything in a
+  // round: nothing has been posted since each of them found its service empty
+  while (true) {
+    drained_shard_count_ = 0u;
+    is_shard_busy_ = false;
+    ++shard_round_;
+    shard_awaiter_.notify_all();
+    awaiter_.wait(lock, [this] { return drained_shard_count_ == shards_.size(); });
+    LOG_DEBUG(GetName() << ": Shards drained, busy: " << is_shard_busy_);
+    if (!is_shard_busy_) {
+      break;
+    }
+  }
+  for (auto&& shard : shards_) {
+    shard->work = std::make_unique<AsioServiceWorkType>(shard->asio_service);
+  }
+  work_ = std::make_unique<AsioServiceWorkType>(asio_service_);
+  ++shard_round_;
+  shard_awaiter_.notify_all();
+}
+
+bool rms::core::ThreadPool::RestartShardOnOutOfWork(Shard& shard, std::size_t executed_count) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (stopped_) {
+    return false;
+  }
+  shard.asio_service.reset();
+  if (shard.work) {
+    return true;
+  }
+  // Wait is in progress: report the round and run again once the next one starts
+  ++drained_shard_count_;
+  is_shard_busy_ = is_shard_busy_ || executed_count != 0u;
+  awaiter_.notify_all();
+  const auto round = shard_round_;
+  shard_awaiter_.wait(lock, [this, round] { return stopped_ || shard_round_ != round; });
+  return !stopped_;
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <boost/thread/barrier.hpp>
+#include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <memory>
@@ -12,21 +13,55 @@
 #include "core/alias.h"
 #include "core/iioservice.h"
 #include "core/ischeduler.h"
+#include "core/scheduler_stats.h"
+
+namespace rms {
+namespace util {
+class MetricCounter;
+}  // namespace util
+}  // namespace rms
 
 namespace rms {
 namespace core {
 
+namespace detail {
+struct ThreadPoolTask;
+}  // namespace detail
+
 /**
  * Allows to create and manipulate thread pools.
  */
 class ThreadPool : public IScheduler, public IIoService {
  public:
+  /**
+   * Scheduling strategy of the thread pool.
+   */
+  enum class Mode {
+    /**
+     * All threads run the single shared asio io service. Every task goes through io service queue.
+     */
+    Shared,
+    /**
+     * Each thread has its own local run queue. Tasks scheduled from the pool thread stay local (the latest one goes to
+     * LIFO slot), idle threads steal tasks from the others. Asio io service is used for io completions and tasks
+     * scheduled from outside of the pool.
+     */
+    WorkStealing,
+    /**
+     * Each thread runs its own asio io service (shard). Tasks scheduled from the pool thread stay on the same shard,
+     * tasks scheduled from outside and io service requests are distributed across shards round-robin. Async task
+     * follows io completions of its socket, thus coroutine, socket and its buffers stay on one thread.
+     */
+    Sharded
+  };
+
   /**
    * Creates thread pool with given name and count of threads.
    * @param thread_count Count of threads in the pool.
    * @param name Thread pull name.
+   * @param mode Scheduling strategy.
    */
-  ThreadPool(const std::size_t thread_count, const char* name);
+  ThreadPool(const std::size_t thread_count, const char* name, Mode mode = Mode::Shared);
 
   /**
    * Destroy thread pool, stopp all threads and wait until they are done.
@@ -43,7 +78,7 @@ class ThreadPool : public IScheduler, public IIoService {
   void Schedule(HandlerType handler) override;
 
   /**
-   * Wait until thread pool is done.
+   * Wait until thread pool is done: all threads are out of tasks and io at the same time.
    */
   void Wait();
 
@@ -53,19 +88,83 @@ class ThreadPool : public IScheduler, public IIoService {
    */
   const char* GetName() const override;
 
+  /**
+   * Get scheduling strategy of the thread pool.
+   * @return Scheduling strategy.
+   */
+  Mode GetMode() const;
+
  private:
+  struct Worker;
+
+  struct Shard;
+
   /**
-   * Get underlying asio io service.
+   * Get underlying asio io service. In Sharded mode every call returns the next shard (round-robin).
    * @return Asio io service which executes all tasks.
    */
   AsioServiceType& GetAsioService() override;
 
+  void RunShared();
+
+  void RunWorkStealing(Worker& worker);
+
+  void RunSharded(Shard& shard);
+
+  Shard& GetCurrentOrNextShard();
+
+  Shard& GetNextShard();
+
+  void ScheduleLocal(Worker& worker, HandlerType handler, SchedulerStats::ClockType::time_point schedule_time);
+
+  bool RunLocalTask(Worker& worker);
+
+  bool StealTask(Worker& worker);
+
+  void RunTask(detail::ThreadPoolTask* task);
+
+  bool RestartOnOutOfWork();
+
+  // Waits until all shards run out of work in the same round. Called under the lock
+  void WaitShards(std::unique_lock<std::mutex>& lock);
+
+  bool RestartShardOnOutOfWork(Shard& shard, std::size_t executed_count);
+
   const char* name_;
 
+  const Mode mode_;
+
+  // Shared by pools of the same name, count of queued tasks is the difference
+  util::MetricCounter& scheduled_counter_;
+
+  util::MetricCounter& started_counter_;
+
+  const SchedulerStats stats_;
+
   AsioServiceType asio_service_;
 
   std::unique_ptr<AsioServiceWorkType> work_;
 
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::atomic<std::size_t> idle_count_{0u};
+
+  std::atomic<std::size_t> pending_count_{0u};
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  std::atomic<std::size_t> next_shard_{0u};
+
+  // Shards which have run out of work in the current round of Wait
+  std::size_t drained_shard_count_ = 0u;
+
+  // Some shard has executed handlers in the current round of Wait, so others might have got work from it
+  bool is_shard_busy_ = false;
+
+  std::size_t shard_round_ = 0u;
+
+  std::condition_variable shard_awaiter_;
+
   std::vector<std::thread> threads_;
 
   std::mutex mutex_;
@@ -75,6 +174,10 @@ class ThreadPool : public IScheduler, public IIoService {
   bool stopped_ = false;
 
   boost::barrier barrier_;
+
+  static thread_local Worker* current_worker_;
+
+  static thread_local Shard* current_shard_;
 };
 
 }  // namespace core
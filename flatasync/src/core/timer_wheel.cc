@@ -0,0 +1,133 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/timer_wheel.h"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include "util/metrics.h"
+#include "util/thread_util.h"
+
+namespace {
+
+rms::util::MetricCounter& GetFiredTimeoutCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter(
+      "flatasync_timeouts_fired_total", "Timeouts of async tasks which have expired", {{"backend", "timer_wheel"}});
+  return counter;
+}
+
+}  // namespace
+
+rms::core::TimerWheel::TimerWheel(std::chrono::milliseconds tick, std::size_t slot_count)
+    : tick_(std::max(tick, std::chrono::milliseconds(1))),
+      slot_count_(std::max(slot_count, std::size_t{1u})),
+      slots_(std::make_unique<Slot[]>(slot_count_)),
+      start_time_(ClockType::now()) {
+  LOG_AUTO_TRACE();
+  thread_ = util::ThreadUtil::CreateThread([this] { Run(); }, "timer_wheel");
+  LOG_DEBUG("Timer wheel created: tick=" << tick_.count() << "ms, slots=" << slot_count_);
+}
+
+rms::core::TimerWheel::~TimerWheel() {
+  LOG_AUTO_TRACE();
+  {
+    std::lock_guard<std::mutex> lock(stop_mutex_);
+    is_stopped_ = true;
+  }
+  stop_awaiter_.notify_all();
+  thread_.join();
+  for (std::size_t i = 0u; i < slot_count_; ++i) {
+    slots_[i].entries.clear();
+  }
+}
+
+void rms::core::TimerWheel::Arm(Entry& entry, std::chrono::milliseconds timeout, AsyncOpState op_state) {
+  LOG_AUTO_TRACE();
+  assert(!entry.hook_.is_linked() && "Timer is already armed");
+  // Round up and skip the current tick which is partially elapsed, so timer never fires earlier than requested
+  const auto timeout_ms = std::max<std::chrono::milliseconds::rep>(timeout.count(), 0);
+  const auto tick_count = static_cast<std::uint64_t>((timeout_ms + tick_.count() - 1) / tick_.count()) + 1u;
+  while (true) {
+    // Counted from the clock rather than from current_tick_, which lags behind if the wheel thread is delayed
+    const auto elapsed_ticks = static_cast<std::uint64_t>((ClockType::now() - start_time_) / tick_);
+    const auto deadline_tick = elapsed_ticks + tick_count;
+    const auto slot_index = static_cast<std::size_t>(deadline_tick % slot_count_);
+    auto& slot = slots_[slot_index];
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    // Deadline tick is processed under the same lock: if it is not reached yet, the timer can't be missed
+    if (current_tick_.load(std::memory_order_relaxed) < deadline_tick) {
+      entry.op_state_ = std::move(op_state);
+      entry.deadline_tick_ = deadline_tick;
+      entry.slot_index_ = slot_index;
+      slot.entries.push_back(entry);
+      return;
+    }
+  }
+}
+
+bool rms::core::TimerWheel::Cancel(Entry& entry) {
+  LOG_AUTO_TRACE();
+  auto& slot = slots_[entry.slot_index_];
+  std::lock_guard<std::mutex> lock(slot.mutex);
+  if (!entry.hook_.is_linked()) {
+    return false;
+  }
+  slot.entries.erase(slot.entries.iterator_to(entry));
+  entry.op_state_ = boost::none;
+  return true;
+}
+
+std::size_t rms::core::TimerWheel::GetArmedCount() {
+  std::size_t count = 0u;
+  for (std::size_t i = 0u; i < slot_count_; ++i) {
+    std::lock_guard<std::mutex> lock(slots_[i].mutex);
+    count += slots_[i].entries.size();
+  }
+  return count;
+}
+
+std::chrono::milliseconds rms::core::TimerWheel::GetTick() const {
+  return tick_;
+}
+
+void rms::core::TimerWheel::Run() {
+  LOG_AUTO_TRACE();
+  auto next_tick = current_tick_.load() + 1u;
+  std::unique_lock<std::mutex> lock(stop_mutex_);
+  while (!stop_awaiter_.wait_until(lock, start_time_ + tick_ * next_tick, [this] { return is_stopped_; })) {
+    lock.unlock();
+    // Catch up if the thread has been delayed for several ticks
+    const auto elapsed_ticks = static_cast<std::uint64_t>((ClockType::now() - start_time_) / tick_);
+    for (; next_tick <= elapsed_ticks; ++next_tick) {
+      ProcessTick(next_tick);
+    }
+    lock.lock();
+  }
+}
+
+void rms::core::TimerWheel::ProcessTick(std::uint64_t tick) {
+  auto& slot = slots_[tick % slot_count_];
+  {
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    current_tick_.store(tick, std::memory_order_release);
+    for (auto it = slot.entries.begin(); it != slot.entries.end();) {
+      auto& entry = *it;
+      if (entry.deadline_tick_ > tick) {
+        ++it;
+        continue;
+      }
+      it = slot.entries.erase(it);
+      expired_.push_back(std::move(*entry.op_state_));
+      entry.op_state_ = boost::none;
+    }
+  }
+  if (expired_.empty()) {
+    return;
+  }
+  LOG_TRACE("Expired timers: " << expired_.size());
+  GetFiredTimeoutCounter().Increment(expired_.size());
+  // Outside of the lock: owners are free to destroy their entries
+  for (auto& op_state : expired_) {
+    op_state.Timedout();
+  }
+  expired_.clear();
+}
@@ -0,0 +1,139 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <boost/intrusive/list.hpp>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/async_op_state.h"
+#include "util/logger.h"
+
+namespace rms {
+namespace core {
+
+/**
+ * Hashed timer wheel which tracks timeouts of async operations. Time is split into coarse ticks, every slot of the
+ * wheel holds timers which expire on the ticks mapped to it. Arm and cancel take the lock of a single slot only and
+ * cost O(1) regardless of count of outstanding timers. Own thread advances the wheel every tick and marks expired
+ * operations as Timedout in batch. Timers fire not earlier than requested and at most two ticks later.
+ */
+class TimerWheel {
+  using HookType = boost::intrusive::list_member_hook<boost::intrusive::link_mode<boost::intrusive::safe_link>>;
+
+ public:
+  /**
+   * Timer registered in the wheel. Owned by the caller, must be cancelled (or expired) before destruction.
+   */
+  class Entry {
+   public:
+    Entry() = default;
+
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+
+   private:
+    friend class TimerWheel;
+
+    HookType hook_;
+
+    boost::optional<AsyncOpState> op_state_;
+
+    std::uint64_t deadline_tick_ = 0u;
+
+    std::size_t slot_index_ = 0u;
+  };
+
+  /**
+   * Create timer wheel and start its thread.
+   * @param tick Resolution of the wheel.
+   * @param slot_count Count of slots. Timers longer than tick * slot_count stay in the slot for several revolutions.
+   */
+  explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10), std::size_t slot_count = 1024u);
+
+  /**
+   * Stop the wheel thread. Outstanding timers do not fire.
+   */
+  ~TimerWheel();
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /**
+   * Register timer which marks async operation as Timedout.
+   * @param entry Timer to be armed. Must not be armed already.
+   * @param timeout Time after which operation is timed out.
+   * @param op_state State of the async operation.
+   */
+  void Arm(Entry& entry, std::chrono::milliseconds timeout, AsyncOpState op_state);
+
+  /**
+   * Unregister timer.
+   * @param entry Armed timer.
+   * @return True if timer has been cancelled. False if it has already expired or has not been armed.
+   */
+  bool Cancel(Entry& entry);
+
+  /**
+   * Get count of armed timers. Takes locks of all slots, intended for introspection.
+   * @return Count of armed timers.
+   */
+  std::size_t GetArmedCount();
+
+  /**
+   * Get resolution of the wheel.
+   * @return Duration of the tick.
+   */
+  std::chrono::milliseconds GetTick() const;
+
+ private:
+  DECLARE_GET_LOGGER("Core.TimerWheel")
+
+  using ClockType = std::chrono::steady_clock;
+
+  using EntryListType =
+      boost::intrusive::list<Entry, boost::intrusive::member_hook<Entry, HookType, &Entry::hook_>,
+                             boost::intrusive::constant_time_size<false>>;
+
+  struct Slot {
+    std::mutex mutex;
+
+    EntryListType entries;
+  };
+
+  void Run();
+
+  void ProcessTick(std::uint64_t tick);
+
+  const std::chrono::milliseconds tick_;
+
+  const std::size_t slot_count_;
+
+  std::unique_ptr<Slot[]> slots_;
+
+  // Last processed tick. Updated under the lock of the slot being processed
+  std::atomic<std::uint64_t> current_tick_{0u};
+
+  const ClockType::time_point start_time_;
+
+  // Used by the wheel thread only, keeps expired states between ticks to avoid reallocation
+  std::vector<AsyncOpState> expired_;
+
+  std::mutex stop_mutex_;
+
+  std::condition_variable stop_awaiter_;
+
+  bool is_stopped_ = false;
+
+  std::thread thread_;
+};
+
+}  // namespace core
+}  // namespace rms
@@ -0,0 +1,185 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace rms {
+namespace core {
+
+/**
+ * Lock-free single producer / multiple consumers deque (Chase-Lev). Owner thread pushes and pops items from the bottom
+ * (LIFO), other threads steal items from the top (FIFO). Based on "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (Le, Pop, Cohen, Zappa Nardelli, 2013).
+ * @tparam T Type of the item. Must be trivially copyable, usually pointer to the task.
+ */
+template <typename T>
+class WorkStealingQueue {
+  static_assert(std::is_trivially_copyable<T>::value, "Item of the WorkStealingQueue must be trivially copyable");
+
+ public:
+  /**
+   * Create empty queue.
+   * @param capacity Initial capacity of the queue. Must be power of 2. Queue grows automatically when full.
+   */
+  explicit WorkStealingQueue(std::size_t capacity = 256u);
+
+  WorkStealingQueue(const WorkStealingQueue&) = delete;
+  WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+  /**
+   * Push item to the bottom of the queue. Must be called by owner thread only.
+   * @param item Item to push.
+   */
+  void Push(T item);
+
+  /**
+   * Pop item from the bottom of the queue. Must be called by owner thread only.
+   * @param item Receives popped item.
+   * @return True if item has been popped. False if queue is empty.
+   */
+  bool Pop(T& item);
+
+  /**
+   * Steal item from the top of the queue. Can be called by any thread.
+   * @param item Receives stolen item.
+   * @return True if item has been stolen. False if queue is empty or race with another thief has been lost.
+   */
+  bool Steal(T& item);
+
+  /**
+   * Check whether queue is empty. Result is approximate if queue is accessed concurrently.
+   * @return True if queue has no items.
+   */
+  bool IsEmpty() const;
+
+ private:
+  class Array {
+   public:
+    explicit Array(std::size_t capacity) : capacity_(capacity), items_(new std::atomic<T>[capacity]) {
+      assert(capacity_ > 0u && (capacity_ & (capacity_ - 1u)) == 0u && "Capacity must be power of 2");
+    }
+
+    std::int64_t Capacity() const {
+      return static_cast<std::int64_t>(capacity_);
+    }
+
+    T Get(std::int64_t index) const {
+      return items_[static_cast<std::size_t>(index) & (capacity_ - 1u)].load(std::memory_order_relaxed);
+    }
+
+    void Put(std::int64_t index, T item) {
+      items_[static_cast<std::size_t>(index) & (capacity_ - 1u)].store(item, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Array> Grow(std::int64_t top, std::int64_t bottom) const {
+      auto result = std::make_unique<Array>(capacity_ * 2u);
+      for (auto i = top; i != bottom; ++i) {
+        result->Put(i, Get(i));
+      }
+      return result;
+    }
+
+   private:
+    const std::size_t capacity_;
+
+    std::unique_ptr<std::atomic<T>[]> items_;
+  };
+
+  // Keep indexes on separate cache lines: top is hammered by thieves, bottom by the owner
+  static constexpr std::size_t kCacheLineSize = 64u;
+
+  std::atomic<std::int64_t> top_;
+
+  char top_padding_[kCacheLineSize - sizeof(std::atomic<std::int64_t>)];
+
+  std::atomic<std::int64_t> bottom_;
+
+  char bottom_padding_[kCacheLineSize - sizeof(std::atomic<std::int64_t>)];
+
+  std::atomic<Array*> array_;
+
+  // Thieves might still read from replaced arrays, so they are released together with the queue only
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+template <typename T>
+WorkStealingQueue<T>::WorkStealingQueue(std::size_t capacity) : top_(0), bottom_(0) {
+  arrays_.emplace_back(std::make_unique<Array>(capacity));
+  array_.store(arrays_.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+void WorkStealingQueue<T>::Push(T item) {
+  const auto bottom = bottom_.load(std::memory_order_relaxed);
+  const auto top = top_.load(std::memory_order_acquire);
+  auto* array = array_.load(std::memory_order_relaxed);
+  if (bottom - top > array->Capacity() - 1) {
+    arrays_.emplace_back(array->Grow(top, bottom));
+    array = arrays_.back().get();
+    array_.store(array, std::memory_order_release);
+  }
+  array->Put(bottom, item);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool WorkStealingQueue<T>::Pop(T& item) {
+  const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  auto* array = array_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto top = top_.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // Empty queue
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  item = array->Get(bottom);
+  if (top == bottom) {
+    // Last item: race with thieves
+    const bool is_won =
+        top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return is_won;
+  }
+  return true;
+}
+
+template <typename T>
+bool WorkStealingQueue<T>::Steal(T& item) {
+  auto top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const auto bottom = bottom_.load(std::memory_order_acquire);
+
+  if (top >= bottom) {
+    return false;
+  }
+
+  auto* array = array_.load(std::memory_order_acquire);
+  const auto result = array->Get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+    return false;
+  }
+  item = result;
+  return true;
+}
+
+template <typename T>
+bool WorkStealingQueue<T>::IsEmpty() const {
+  const auto bottom = bottom_.load(std::memory_order_relaxed);
+  const auto top = top_.load(std::memory_order_relaxed);
+  return top >= bottom;
+}
+
+}  // namespace core
+}  // namespace rms
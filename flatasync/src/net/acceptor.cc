@@ -10,14 +10,55 @@
 
 #include <boost/asio.hpp>
 #include <boost/system/error_code.hpp>
-#include <cassert>
+#include <cerrno>
 #include "core/iioservice.h"
 #include "net/tcp_socket.h"
 
+#ifdef __linux__
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 using rms::core::GetCurrentThreadIoService;
 using rms::net::TcpSocket;
 
-rms::net::Acceptor::Acceptor(const EndPointType& endpoint) : acceptor_(GetCurrentThreadIoService().GetAsioService()) {
+namespace {
+
+#ifdef SO_REUSEPORT
+using ReusePortOptionType = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+// Pending connection has failed before it was accepted: it is skipped and the next one is accepted, as async accept of
+// asio does
+bool IsSkippedAcceptError(const rms::net::ErrorType& error) {
+  if (error == boost::asio::error::connection_aborted || error == boost::asio::error::interrupted) {
+    return true;
+  }
+  if (error.category() != boost::system::system_category()) {
+    return false;
+  }
+  switch (error.value()) {
+    case EPROTO:
+#ifdef __linux__
+    // Network errors of the new socket which accept(2) passes through on Linux
+    case ENETDOWN:
+    case ENOPROTOOPT:
+    case EHOSTDOWN:
+    case ENONET:
+    case EHOSTUNREACH:
+    case EOPNOTSUPP:
+    case ENETUNREACH:
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+rms::net::Acceptor::Acceptor(const EndPointType& endpoint, bool reuse_port, int backlog)
+    : acceptor_(GetCurrentThreadIoService().GetAsioService()), protocol_(endpoint.protocol()) {
   // TODO(malirod): move this logic to Start out of CTor
   LOG_DEBUG("Opening socket for listening");
   boost::system::error_code error;
@@ -28,16 +69,31 @@ rms::net::Acceptor::Acceptor(const EndPointType& endpoint) : acceptor_(GetCurren
   }
   acceptor_.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
   acceptor_.set_option(boost::asio::ip::tcp::no_delay(true));
+  if (reuse_port) {
+#ifdef SO_REUSEPORT
+    acceptor_.set_option(ReusePortOptionType(true), error);
+    if (error.value() != boost::system::errc::success) {
+      LOG_DEBUG("Error during set SO_REUSEPORT: " << error.message());
+    }
+#else
+    LOG_DEBUG("SO_REUSEPORT is not supported");
+#endif
+  }
   acceptor_.bind(endpoint, error);
   if (error.value() != boost::system::errc::success) {
     // TODO(malirod): raise OnError event
     LOG_DEBUG("Error during bind: " << error.message());
   }
-  acceptor_.listen(boost::asio::socket_base::max_connections, error);
+  acceptor_.listen(backlog, error);
   if (error.value() != boost::system::errc::success) {
     // TODO(malirod): raise OnError event
     LOG_DEBUG("Error during listen: " << error.message());
   }
+  // AcceptBatch drains pending connections with plain accept calls, they must fail rather than block once drained
+  acceptor_.non_blocking(true, error);
+  if (error.value() != boost::system::errc::success) {
+    LOG_DEBUG("Error during set non blocking: " << error.message());
+  }
   LOG_DEBUG("Listening");
 }
 
@@ -47,22 +103,88 @@ rms::net::Acceptor::Acceptor(const std::string& ip, int port)
     : Acceptor(EndPointType(boost::asio::ip::address::from_string(ip), port)) {}
 
 std::shared_ptr<TcpSocket> rms::net::Acceptor::Accept() {
+  ErrorType error;
+  return Accept(error);
+}
+
+std::shared_ptr<TcpSocket> rms::net::Acceptor::Accept(ErrorType& error) {
   LOG_AUTO_TRACE();
   AsioTcpSocketType asio_socket(GetCurrentThreadIoService().GetAsioService());
-  DeferIo([this, &asio_socket](IoHandlerType proceed) {
+  error = DeferIo([this, &asio_socket](IoHandlerType proceed) {
     LOG_DEBUG("Calling acceptor_.async_accept");
-    acceptor_.async_accept(asio_socket, proceed);
+    acceptor_.async_accept(asio_socket, std::move(proceed));
     LOG_DEBUG("End of call acceptor_.async_accept");
   });
+  if (error) {
+    LOG_DEBUG("Error during accept: " << error.message());
+    return nullptr;
+  }
   return TcpSocket::Create(std::move(asio_socket));
 }
 
+std::size_t rms::net::Acceptor::AcceptBatch(std::vector<std::shared_ptr<TcpSocket>>& sockets,
+                                            std::size_t max_count,
+                                            ErrorType& error) {
+  LOG_AUTO_TRACE();
+  error = DeferIo([this](IoHandlerType proceed) {
+    acceptor_.async_wait(boost::asio::socket_base::wait_read, std::move(proceed));
+  });
+  if (error) {
+    LOG_DEBUG("Error during wait for connections: " << error.message());
+    return 0u;
+  }
+  std::size_t count = 0u;
+  for (; count < max_count; ++count) {
+    // In Sharded mode every socket is bound to the next shard
+    AsioTcpSocketType asio_socket(GetCurrentThreadIoService().GetAsioService());
+    if (!AcceptPending(asio_socket, error)) {
+      break;
+    }
+    sockets.push_back(TcpSocket::Create(std::move(asio_socket)));
+  }
+  LOG_DEBUG("Accepted batch of " << count << " connections");
+  return count;
+}
+
+bool rms::net::Acceptor::AcceptPending(AsioTcpSocketType& asio_socket, ErrorType& error) {
+#ifdef __linux__
+  int native_socket = -1;
+  do {
+    // Accepted socket is non-blocking from the start, no extra syscall is needed
+    native_socket = ::accept4(acceptor_.native_handle(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    error = native_socket < 0 ? ErrorType(errno, boost::system::system_category()) : ErrorType();
+  } while (IsSkippedAcceptError(error));
+  if (!error) {
+    asio_socket.assign(protocol_, native_socket, error);
+    if (error) {
+      ::close(native_socket);
+    }
+  }
+#else
+  do {
+    acceptor_.accept(asio_socket, error);
+  } while (IsSkippedAcceptError(error));
+#endif
+  if (error) {
+    if (error == boost::asio::error::would_block || error == boost::asio::error::try_again) {
+      error = ErrorType();
+    } else {
+      LOG_DEBUG("Error during accept: " << error.message());
+    }
+    return false;
+  }
+  return true;
+}
+
+bool rms::net::Acceptor::IsOpen() const {
+  return acceptor_.is_open();
+}
+
 void rms::net::Acceptor::DoAccept(const SocketHandlerType& handler) {
   LOG_AUTO_TRACE();
   auto socket = Accept();
-  assert(socket);
 
-  if (!acceptor_.is_open()) {
+  if (!socket || !acceptor_.is_open()) {
     LOG_DEBUG("Acceptor is closed after Accept has finished.");
     return;
   }
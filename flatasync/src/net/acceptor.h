@@ -2,10 +2,12 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include <boost/asio.hpp>
 #include <string>
+#include <vector>
 #include "net/alias.h"
 #include "util/logger.h"
 
@@ -22,8 +24,13 @@ class Acceptor {
   /**
    * Constructs acceptor basing on address and port.
    * @param endpoint Address and port to listen for new connections.
+   * @param reuse_port Set SO_REUSEPORT, so several acceptors can listen on the same endpoint. Kernel balances incoming
+   * connections between them.
+   * @param backlog Max length of the queue of pending connections.
    */
-  explicit Acceptor(const boost::asio::ip::tcp::endpoint& endpoint);
+  explicit Acceptor(const boost::asio::ip::tcp::endpoint& endpoint,
+                    bool reuse_port = false,
+                    int backlog = boost::asio::socket_base::max_connections);
 
   /**
    * Constructs acceptor basing on port. Default address is 0.0.0.0.
@@ -44,6 +51,35 @@ class Acceptor {
    */
   void DoAccept(const SocketHandlerType& handler);
 
+  /**
+   * Wait for new connection. Several accepts can be outstanding at once.
+   * @return Accepted socket, nullptr on error.
+   */
+  std::shared_ptr<TcpSocket> Accept();
+
+  /**
+   * Wait for new connection. Several accepts can be outstanding at once.
+   * @param error Set to error of the accept.
+   * @return Accepted socket, nullptr on error.
+   */
+  std::shared_ptr<TcpSocket> Accept(ErrorType& error);
+
+  /**
+   * Wait until there are pending connections and accept all of them without waiting, up to the given count. Several
+   * batches can be outstanding at once.
+   * @param sockets Accepted sockets are appended to it.
+   * @param max_count Max count of connections to accept.
+   * @param error Set to error of the wait or of the accept which has stopped the batch.
+   * @return Count of accepted connections.
+   */
+  std::size_t AcceptBatch(std::vector<std::shared_ptr<TcpSocket>>& sockets, std::size_t max_count, ErrorType& error);
+
+  /**
+   * Check whether acceptor is listening.
+   * @return False if acceptor has been stopped.
+   */
+  bool IsOpen() const;
+
   /**
    * Stop listening incoming connections.
    */
@@ -52,9 +88,12 @@ class Acceptor {
  private:
   DECLARE_GET_LOGGER("Net.Acceptor")
 
-  std::shared_ptr<TcpSocket> Accept();
+  // Error is left clear if there are no more pending connections
+  bool AcceptPending(AsioTcpSocketType& asio_socket, ErrorType& error);
 
   boost::asio::ip::tcp::acceptor acceptor_;
+
+  const boost::asio::ip::tcp protocol_;
 };
 
 }  // namespace net
@@ -3,27 +3,35 @@
 #pragma once
 
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <string>
 
 #include <boost/asio.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "core/alias.h"
+#include "net/buffer.h"
+#include "util/inplace_function.h"
+
 namespace rms {
 namespace net {
 
 class TcpSocket;
 
-using BufferType = std::string;
+using BufferType = Buffer;
+// Parts of a gathered write, e.g. protocol header, payload and trailer
+using BufferRefsType = std::initializer_list<BufferRef>;
 using TcpServerIdType = std::size_t;
 using SocketHandlerType = std::function<void(std::shared_ptr<TcpSocket>)>;
 using EndPointType = boost::asio::ip::tcp::endpoint;
 using AsioTcpSocketType = boost::asio::ip::tcp::socket;
 
 using ErrorType = boost::system::error_code;
-using IoHandlerType = std::function<void(const ErrorType&)>;
-using BufferIoHandlerType = std::function<void(const ErrorType&, std::size_t)>;
-using CallbackIoHandlerType = std::function<void(IoHandlerType)>;
+using IoHandlerType = util::InplaceFunction<void(const ErrorType&), FLATASYNC_TASK_INLINE_SIZE>;
+// Wraps IoHandlerType and a reference to the buffer
+using BufferIoHandlerType =
+    util::InplaceFunction<void(const ErrorType&, std::size_t), sizeof(IoHandlerType) + sizeof(void*)>;
 
 }  // namespace net
 }  // namespace rms
@@ -0,0 +1,211 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/buffer.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+#include "util/thread_local_pool.h"
+
+namespace {
+
+using BlockPoolType = rms::util::ThreadLocalPool<rms::net::BufferBlock, 256u>;
+
+// Compare data of the slices, starting at the given offset of the first one, with the view
+bool IsMatch(rms::net::Buffer::SlicesType::const_iterator slice, std::size_t offset, rms::net::BufferViewType data) {
+  while (!data.empty()) {
+    const auto size = std::min(slice->GetSize() - offset, data.size());
+    if (std::memcmp(slice->GetData() + offset, data.data(), size) != 0) {
+      return false;
+    }
+    data.remove_prefix(size);
+    ++slice;
+    offset = 0u;
+  }
+  return true;
+}
+
+}  // namespace
+
+constexpr std::size_t rms::net::BufferBlock::kSize;
+constexpr std::size_t rms::net::Buffer::npos;
+
+rms::net::BufferBlockPtr rms::net::BufferBlock::Create() {
+  return BufferBlockPtr(new BufferBlock());
+}
+
+void* rms::net::BufferBlock::operator new(std::size_t size) {
+  assert(size == sizeof(BufferBlock));
+  static_cast<void>(size);
+  return BlockPoolType::Allocate();
+}
+
+void rms::net::BufferBlock::operator delete(void* ptr) noexcept {
+  BlockPoolType::Deallocate(ptr);
+}
+
+rms::net::BufferSlice::BufferSlice(BufferBlockPtr block, const char* data, std::size_t size)
+    : block_(std::move(block)), data_(data), size_(size) {}
+
+rms::net::Buffer::Buffer(BufferViewType data) {
+  Append(data);
+}
+
+rms::net::BufferViewType rms::net::Buffer::GetView() const {
+  assert(IsContiguous() && "Buffer consists of several slices");
+  return slices_.empty() ? BufferViewType() : slices_.front().GetView();
+}
+
+rms::net::Buffer rms::net::Buffer::Slice(std::size_t offset, std::size_t size) const {
+  Buffer result;
+  if (offset >= size_) {
+    return result;
+  }
+  size = std::min(size, size_ - offset);
+  for (const auto& slice : slices_) {
+    if (size == 0u) {
+      break;
+    }
+    if (offset >= slice.size_) {
+      offset -= slice.size_;
+      continue;
+    }
+    const auto part_size = std::min(slice.size_ - offset, size);
+    result.Append(BufferSlice(slice.block_, slice.data_ + offset, part_size));
+    size -= part_size;
+    offset = 0u;
+  }
+  return result;
+}
+
+void rms::net::Buffer::Append(const Buffer& other) {
+  if (&other == this) {
+    Append(Buffer(other));
+    return;
+  }
+  for (const auto& slice : other.slices_) {
+    Append(slice);
+  }
+}
+
+void rms::net::Buffer::Append(BufferSlice slice) {
+  if (slice.size_ == 0u) {
+    return;
+  }
+  size_ += slice.size_;
+  // Adjacent parts of the same block, e.g. consecutive reads, are merged
+  if (!slices_.empty()) {
+    auto& last = slices_.back();
+    if (last.block_ == slice.block_ && last.data_ + last.size_ == slice.data_) {
+      last.size_ += slice.size_;
+      return;
+    }
+  }
+  slices_.push_back(std::move(slice));
+}
+
+void rms::net::Buffer::Append(BufferViewType data) {
+  if (!slices_.empty()) {
+    auto& last = slices_.back();
+    // Exclusively owned block: memory after the last slice is not visible to anyone
+    if (!last.block_->IsShared()) {
+      const auto* block_end = last.block_->GetData() + BufferBlock::kSize;
+      auto* tail = last.block_->GetData() + (last.data_ - last.block_->GetData()) + last.size_;
+      const auto size = std::min(static_cast<std::size_t>(block_end - tail), data.size());
+      std::memcpy(tail, data.data(), size);
+      last.size_ += size;
+      size_ += size;
+      data.remove_prefix(size);
+    }
+  }
+  while (!data.empty()) {
+    auto block = BufferBlock::Create();
+    const auto size = std::min(BufferBlock::kSize, data.size());
+    std::memcpy(block->GetData(), data.data(), size);
+    const auto* block_data = block->GetData();
+    slices_.emplace_back(std::move(block), block_data, size);
+    size_ += size;
+    data.remove_prefix(size);
+  }
+}
+
+std::size_t rms::net::Buffer::Find(BufferViewType data, std::size_t from) const {
+  if (from > size_ || data.size() > size_ - from) {
+    return npos;
+  }
+  const auto last_position = size_ - data.size();
+  std::size_t position = 0u;
+  for (auto slice = slices_.begin(); slice != slices_.end(); ++slice) {
+    for (std::size_t offset = 0u; offset < slice->size_; ++offset, ++position) {
+      if (position > last_position) {
+        return npos;
+      }
+      if (position >= from && IsMatch(slice, offset, data)) {
+        return position;
+      }
+    }
+  }
+  // Empty data at the end of the buffer
+  return position == from ? position : npos;
+}
+
+std::string rms::net::Buffer::ToString() const {
+  std::string result;
+  result.reserve(size_);
+  for (const auto& slice : slices_) {
+    result.append(slice.data_, slice.size_);
+  }
+  return result;
+}
+
+void rms::net::Buffer::Clear() {
+  slices_.clear();
+  size_ = 0u;
+}
+
+bool rms::net::operator==(const Buffer& lhs, BufferViewType rhs) {
+  return lhs.GetSize() == rhs.size() && (rhs.empty() || IsMatch(lhs.GetSlices().begin(), 0u, rhs));
+}
+
+bool rms::net::operator==(BufferViewType lhs, const Buffer& rhs) {
+  return rhs == lhs;
+}
+
+bool rms::net::operator==(const Buffer& lhs, const Buffer& rhs) {
+  if (lhs.GetSize() != rhs.GetSize()) {
+    return false;
+  }
+  auto lhs_slice = lhs.GetSlices().begin();
+  std::size_t lhs_offset = 0u;
+  for (const auto& slice : rhs.GetSlices()) {
+    if (!IsMatch(lhs_slice, lhs_offset, slice.GetView())) {
+      return false;
+    }
+    // Move to the end of the compared data
+    lhs_offset += slice.GetSize();
+    while (lhs_slice != lhs.GetSlices().end() && lhs_offset >= lhs_slice->GetSize()) {
+      lhs_offset -= lhs_slice->GetSize();
+      ++lhs_slice;
+    }
+  }
+  return true;
+}
+
+bool rms::net::operator!=(const Buffer& lhs, const Buffer& rhs) {
+  return !(lhs == rhs);
+}
+
+bool rms::net::operator!=(const Buffer& lhs, BufferViewType rhs) {
+  return !(lhs == rhs);
+}
+
+bool rms::net::operator!=(BufferViewType lhs, const Buffer& rhs) {
+  return !(lhs == rhs);
+}
+
+std::ostream& rms::net::operator<<(std::ostream& stream, const Buffer& buffer) {
+  for (const auto& slice : buffer.GetSlices()) {
+    stream << slice.GetView();
+  }
+  return stream;
+}
@@ -0,0 +1,294 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/container/small_vector.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <boost/utility/string_view.hpp>
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace rms {
+namespace net {
+
+// Non-owning view of contiguous data
+using BufferViewType = boost::string_view;
+
+/**
+ * Fixed-size ref-counted memory block, the storage of Buffer. Memory of the blocks is pooled per thread and is not
+ * zero-filled.
+ */
+class BufferBlock {
+ public:
+  static constexpr std::size_t kSize = 4096u;
+
+  /**
+   * Create block.
+   * @return Block owned by the returned pointer only.
+   */
+  static boost::intrusive_ptr<BufferBlock> Create();
+
+  BufferBlock(const BufferBlock&) = delete;
+  BufferBlock& operator=(const BufferBlock&) = delete;
+
+  /**
+   * Get memory of the block.
+   * @return Pointer to kSize bytes.
+   */
+  char* GetData() {
+    return data_;
+  }
+
+  /**
+   * Check whether block is referenced by more than one owner. Memory not covered by the slices of an exclusive owner
+   * can be written safely.
+   * @return True if block has other owners.
+   */
+  bool IsShared() const {
+    return ref_count_.load(std::memory_order_acquire) > 1u;
+  }
+
+  static void* operator new(std::size_t size);
+
+  static void operator delete(void* ptr) noexcept;
+
+ private:
+  BufferBlock() = default;
+
+  friend void intrusive_ptr_add_ref(BufferBlock* block) {
+    block->ref_count_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  friend void intrusive_ptr_release(BufferBlock* block) {
+    if (block->ref_count_.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+      delete block;
+    }
+  }
+
+  std::atomic<std::size_t> ref_count_{0u};
+
+  char data_[kSize];
+};
+
+using BufferBlockPtr = boost::intrusive_ptr<BufferBlock>;
+
+/**
+ * Contiguous part of a block referenced by Buffer.
+ */
+class BufferSlice {
+ public:
+  /**
+   * Create slice.
+   * @param block Block which holds the data.
+   * @param data Beginning of the data inside of the block.
+   * @param size Size of the data.
+   */
+  BufferSlice(BufferBlockPtr block, const char* data, std::size_t size);
+
+  const char* GetData() const {
+    return data_;
+  }
+
+  std::size_t GetSize() const {
+    return size_;
+  }
+
+  const BufferBlockPtr& GetBlock() const {
+    return block_;
+  }
+
+  BufferViewType GetView() const {
+    return BufferViewType(data_, size_);
+  }
+
+  /**
+   * Adapter to asio, makes sequence of slices a ConstBufferSequence.
+   */
+  operator boost::asio::const_buffer() const {
+    return boost::asio::const_buffer(data_, size_);
+  }
+
+ private:
+  friend class Buffer;
+
+  BufferBlockPtr block_;
+
+  const char* data_;
+
+  std::size_t size_;
+};
+
+/**
+ * Immutable view of data held by a chain of ref-counted blocks. Copy, Slice and Append of another buffer share blocks
+ * instead of copying data, so received data can be passed on and written without copies. Data is copied only when a
+ * buffer is built from external memory.
+ */
+class Buffer {
+ public:
+  using SlicesType = boost::container::small_vector<BufferSlice, 2u>;
+
+  // Lightweight ConstBufferSequence over the slices, cheap to copy into asio operations
+  using ConstBuffersType = boost::iterator_range<SlicesType::const_iterator>;
+
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  Buffer() = default;
+
+  /**
+   * Create buffer with a copy of the data.
+   * @param data Data to copy.
+   */
+  explicit Buffer(BufferViewType data);
+
+  std::size_t GetSize() const {
+    return size_;
+  }
+
+  bool IsEmpty() const {
+    return size_ == 0u;
+  }
+
+  /**
+   * Check whether data is stored in one piece and can be viewed by GetView.
+   * @return True if buffer has at most one slice.
+   */
+  bool IsContiguous() const {
+    return slices_.size() <= 1u;
+  }
+
+  /**
+   * Get view of the data. Buffer must be contiguous.
+   * @return View which is valid while buffer exists.
+   */
+  BufferViewType GetView() const;
+
+  /**
+   * Get slices which hold the data.
+   * @return Slices in order.
+   */
+  const SlicesType& GetSlices() const {
+    return slices_;
+  }
+
+  /**
+   * Adapter to asio: gather operations write all slices at once.
+   * @return ConstBufferSequence which is valid while buffer exists and is not modified.
+   */
+  ConstBuffersType GetConstBuffers() const {
+    return boost::make_iterator_range(slices_.begin(), slices_.end());
+  }
+
+  /**
+   * Get part of the buffer. Shares blocks with this buffer.
+   * @param offset Beginning of the part.
+   * @param size Size of the part. Truncated to the end of the buffer.
+   * @return Buffer which holds the part.
+   */
+  Buffer Slice(std::size_t offset, std::size_t size = npos) const;
+
+  /**
+   * Append data of another buffer. Shares blocks with it.
+   * @param other Buffer to append.
+   */
+  void Append(const Buffer& other);
+
+  /**
+   * Append slice of a block.
+   * @param slice Slice to append.
+   */
+  void Append(BufferSlice slice);
+
+  /**
+   * Append copy of the data. Fills free space of the last block if no one else references it.
+   * @param data Data to copy.
+   */
+  void Append(BufferViewType data);
+
+  Buffer& operator+=(const Buffer& other) {
+    Append(other);
+    return *this;
+  }
+
+  Buffer& operator+=(BufferViewType data) {
+    Append(data);
+    return *this;
+  }
+
+  /**
+   * Find position of data in the buffer.
+   * @param data Data to look for.
+   * @param from Position to start from.
+   * @return Position of the first occurrence or npos.
+   */
+  std::size_t Find(BufferViewType data, std::size_t from = 0u) const;
+
+  /**
+   * Copy data to a string.
+   * @return String with copy of the data.
+   */
+  std::string ToString() const;
+
+  /**
+   * Release all blocks.
+   */
+  void Clear();
+
+ private:
+  SlicesType slices_;
+
+  std::size_t size_ = 0u;
+};
+
+/**
+ * Reference to a part of a gathered write: view of external memory or Buffer. Doesn't own the data.
+ */
+class BufferRef {
+ public:
+  BufferRef(const Buffer& buffer) : buffer_(&buffer) {}  // NOLINT(runtime/explicit)
+
+  BufferRef(BufferViewType view) : view_(view) {}  // NOLINT(runtime/explicit)
+
+  BufferRef(const std::string& data) : view_(data) {}  // NOLINT(runtime/explicit)
+
+  BufferRef(const char* data) : view_(data) {}  // NOLINT(runtime/explicit)
+
+  /**
+   * Append asio buffers which cover the data.
+   * @tparam Container Container of boost::asio::const_buffer.
+   * @param const_buffers Container to append to.
+   */
+  template <typename Container>
+  void AppendTo(Container& const_buffers) const {
+    if (buffer_ == nullptr) {
+      const_buffers.emplace_back(view_.data(), view_.size());
+      return;
+    }
+    const_buffers.insert(const_buffers.end(), buffer_->GetSlices().begin(), buffer_->GetSlices().end());
+  }
+
+ private:
+  const Buffer* buffer_ = nullptr;
+
+  BufferViewType view_;
+};
+
+bool operator==(const Buffer& lhs, const Buffer& rhs);
+
+bool operator==(const Buffer& lhs, BufferViewType rhs);
+
+bool operator==(BufferViewType lhs, const Buffer& rhs);
+
+bool operator!=(const Buffer& lhs, const Buffer& rhs);
+
+bool operator!=(const Buffer& lhs, BufferViewType rhs);
+
+bool operator!=(BufferViewType lhs, const Buffer& rhs);
+
+std::ostream& operator<<(std::ostream& stream, const Buffer& buffer);
+
+}  // namespace net
+}  // namespace rms
@@ -0,0 +1,100 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/metrics_server.h"
+#include <algorithm>
+#include <sstream>
+#include "util/metrics.h"
+
+using rms::net::BufferType;
+using rms::net::TcpServerIdType;
+
+namespace {
+
+const char kHeadersEnd[] = "\r\n\r\n";
+
+const char kMetricsPath[] = "/metrics";
+
+// Bigger requests are dropped, scrapers send a few short headers
+const std::size_t kMaxRequestSize = 8u * 1024u;
+
+std::string MakeHttpResponse(const char* status, const char* content_type, const std::string& body) {
+  std::ostringstream response;
+  response << "HTTP/1.1 " << status << "\r\nContent-Type: " << content_type << "\r\nContent-Length: " << body.size()
+           << "\r\nConnection: close\r\n\r\n"
+           << body;
+  return response.str();
+}
+
+}  // namespace
+
+rms::net::MetricsServer::MetricsServer(util::MetricsRegistry& registry, std::size_t max_connections)
+    : registry_(registry), tcp_server_(max_connections) {
+  tcp_server_.SubscribeOnData([this](TcpServerIdType id, const BufferType& data) { OnData(id, data); });
+  tcp_server_.SubscribeOnDisconnected([this](TcpServerIdType id) {
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    requests_.erase(id);
+  });
+}
+
+rms::net::MetricsServer::~MetricsServer() = default;
+
+void rms::net::MetricsServer::Start(const std::string& ip, int port) {
+  LOG_AUTO_TRACE();
+  LOG_INFO("Exposing metrics on http://" << ip << ":" << port << kMetricsPath);
+  tcp_server_.Start(ip, port);
+}
+
+void rms::net::MetricsServer::Stop() {
+  LOG_AUTO_TRACE();
+  tcp_server_.Stop();
+}
+
+boost::signals2::connection rms::net::MetricsServer::SubscribeOnListening(
+    const TcpServer::OnListeningSubscriberType& subscriber) {
+  return tcp_server_.SubscribeOnListening(subscriber);
+}
+
+boost::signals2::connection rms::net::MetricsServer::SubscribeOnStopped(
+    const TcpServer::OnStoppedSubscriberType& subscriber) {
+  return tcp_server_.SubscribeOnStopped(subscriber);
+}
+
+void rms::net::MetricsServer::OnData(TcpServerIdType id, const BufferType& data) {
+  std::string request;
+  {
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    auto& pending = requests_[id];
+    // Terminator might span the previous and the new data
+    const auto search_from = pending.GetSize() - std::min(pending.GetSize(), sizeof(kHeadersEnd) - 1u);
+    pending.Append(data);
+    if (pending.Find(kHeadersEnd, search_from) == BufferType::npos) {
+      if (pending.GetSize() > kMaxRequestSize) {
+        LOG_DEBUG("Request is too big, closing client id: " << id);
+        requests_.erase(id);
+        tcp_server_.StopClient(id);
+      }
+      return;
+    }
+    request = pending.ToString();
+    requests_.erase(id);
+  }
+
+  const auto response = MakeResponse(request.substr(0u, request.find("\r\n")));
+  tcp_server_.Write(id, BufferViewType(response));
+  tcp_server_.StopClient(id);
+}
+
+std::string rms::net::MetricsServer::MakeResponse(const std::string& request_line) const {
+  LOG_DEBUG("Request: " << request_line);
+  std::istringstream request_stream(request_line);
+  std::string method;
+  std::string target;
+  request_stream >> method >> target;
+  if (method != "GET") {
+    return MakeHttpResponse("405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+  }
+  if (target.substr(0u, target.find('?')) != kMetricsPath) {
+    return MakeHttpResponse("404 Not Found", "text/plain", "Metrics are exposed on /metrics\n");
+  }
+  return MakeHttpResponse("200 OK", "text/plain; version=0.0.4", registry_.FormatPrometheusText());
+}
@@ -0,0 +1,88 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/signals2.hpp>
+
+#include "net/alias.h"
+#include "net/tcp_server.h"
+#include "util/logger.h"
+
+namespace rms {
+namespace util {
+class MetricsRegistry;
+}  // namespace util
+}  // namespace rms
+
+namespace rms {
+namespace net {
+
+/**
+ * Plain text HTTP endpoint which exposes metrics registry in Prometheus text format on GET /metrics. Every connection
+ * serves a single request and is closed after the response. Built on TcpServer, so it should be used within async
+ * tasks.
+ */
+class MetricsServer {
+ public:
+  /**
+   * Create server.
+   * @param registry Registry to expose, must outlive the server.
+   * @param max_connections Maximum count of concurrent scrapes.
+   */
+  explicit MetricsServer(util::MetricsRegistry& registry, std::size_t max_connections = 16u);
+
+  ~MetricsServer();
+
+  MetricsServer& operator=(const MetricsServer&) = delete;
+  MetricsServer(const MetricsServer&) = delete;
+
+  /**
+   * Start listening on specific address and port.
+   * @param ip Local address to listen on.
+   * @param port Port to listen on.
+   */
+  void Start(const std::string& ip, int port);
+
+  /**
+   * Initiate shutdown sequence.
+   */
+  void Stop();
+
+  /**
+   * Register to OnListening which will be fired when server socket is up and running.
+   * @param subscriber Slot which will be fired when server socket is ready and listening.
+   * @return Connection of the signal to slot.
+   */
+  boost::signals2::connection SubscribeOnListening(const TcpServer::OnListeningSubscriberType& subscriber);
+
+  /**
+   * Register to OnStopped which will be fired when server has stopped.
+   * @param subscriber Slot which will be fired when server has stopped.
+   * @return Connection of the signal to slot.
+   */
+  boost::signals2::connection SubscribeOnStopped(const TcpServer::OnStoppedSubscriberType& subscriber);
+
+ private:
+  DECLARE_GET_LOGGER("Net.MetricsServer")
+
+  void OnData(TcpServerIdType id, const BufferType& data);
+
+  std::string MakeResponse(const std::string& request_line) const;
+
+  util::MetricsRegistry& registry_;
+
+  TcpServer tcp_server_;
+
+  // Requests which have not been received completely, clients are served in parallel
+  std::mutex requests_mutex_;
+
+  std::unordered_map<TcpServerIdType, BufferType> requests_;
+};
+
+}  // namespace net
+}  // namespace rms
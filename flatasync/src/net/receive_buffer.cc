@@ -0,0 +1,98 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/receive_buffer.h"
+#include <algorithm>
+#include <cassert>
+
+constexpr std::size_t rms::net::ReceiveBuffer::kDefaultSize;
+constexpr std::size_t rms::net::ReceiveBuffer::kDefaultMaxSize;
+constexpr std::size_t rms::net::ReceiveBuffer::kShrinkReadCount;
+constexpr std::size_t rms::net::ReceiveBuffer::kMinTailSize;
+
+rms::net::ReceiveBuffer::ReceiveBuffer(std::size_t size, std::size_t max_size)
+    : capacity_(0u), min_size_(0u), max_size_(0u) {
+  SetSize(size, max_size);
+}
+
+void rms::net::ReceiveBuffer::SetSize(std::size_t size, std::size_t max_size) {
+  min_size_ = std::max(size, std::size_t{1u});
+  max_size_ = std::max(max_size, min_size_);
+  capacity_ = min_size_;
+  small_read_count_ = 0u;
+}
+
+rms::net::ReceiveBuffer::MutableBuffersType rms::net::ReceiveBuffer::Prepare() {
+  const auto buffers = Prepare(capacity_);
+  is_adaptive_read_ = true;
+  return buffers;
+}
+
+rms::net::ReceiveBuffer::MutableBuffersType rms::net::ReceiveBuffer::Prepare(std::size_t size) {
+  is_adaptive_read_ = false;
+  buffers_.clear();
+  if (!blocks_.empty()) {
+    if (!blocks_.front()->IsShared()) {
+      // All data of the block has been released
+      offset_ = 0u;
+    } else if (BufferBlock::kSize - offset_ < std::min(size, kMinTailSize)) {
+      blocks_.erase(blocks_.begin());
+      offset_ = 0u;
+    }
+  }
+  std::size_t index = 0u;
+  for (; size != 0u; ++index) {
+    if (index == blocks_.size()) {
+      blocks_.push_back(BufferBlock::Create());
+    }
+    const auto offset = (index == 0u) ? offset_ : 0u;
+    const auto part_size = std::min(BufferBlock::kSize - offset, size);
+    buffers_.emplace_back(blocks_[index]->GetData() + offset, part_size);
+    size -= part_size;
+  }
+  // Keep the spare blocks which the read size might need again
+  const auto spare_count = std::max(max_size_ / BufferBlock::kSize + 1u, index);
+  if (blocks_.size() > spare_count) {
+    blocks_.resize(spare_count);
+  }
+  return boost::make_iterator_range(buffers_.cbegin(), buffers_.cend());
+}
+
+rms::net::Buffer rms::net::ReceiveBuffer::Commit(std::size_t size) {
+  Buffer buffer;
+  std::size_t index = 0u;
+  auto offset = offset_;
+  for (auto remaining = size; remaining != 0u;) {
+    assert(index < blocks_.size());
+    const auto part_size = std::min(BufferBlock::kSize - offset, remaining);
+    buffer.Append(BufferSlice(blocks_[index], blocks_[index]->GetData() + offset, part_size));
+    remaining -= part_size;
+    offset += part_size;
+    if (offset == BufferBlock::kSize) {
+      ++index;
+      offset = 0u;
+    }
+  }
+  // Fully used blocks are referenced by the buffer only, the partially used one becomes the current
+  blocks_.erase(blocks_.begin(), blocks_.begin() + static_cast<std::ptrdiff_t>(index));
+  offset_ = offset;
+
+  if (!is_adaptive_read_) {
+    return buffer;
+  }
+  if (size == capacity_) {
+    capacity_ = std::min(capacity_ * 2u, max_size_);
+    small_read_count_ = 0u;
+  } else if (size <= capacity_ / 4u && capacity_ > min_size_) {
+    if (++small_read_count_ == kShrinkReadCount) {
+      capacity_ = std::max(capacity_ / 2u, min_size_);
+      small_read_count_ = 0u;
+    }
+  } else {
+    small_read_count_ = 0u;
+  }
+  return buffer;
+}
+
+std::size_t rms::net::ReceiveBuffer::GetCapacity() const {
+  return capacity_;
+}
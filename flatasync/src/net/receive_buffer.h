@@ -0,0 +1,99 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <cstddef>
+#include <vector>
+#include "net/buffer.h"
+
+namespace rms {
+namespace net {
+
+/**
+ * Receive buffer reused by all reads of a socket. Reads go to the free tail of the current block and further pooled
+ * blocks; read data is handed out as Buffer which shares the blocks, so nothing is copied, zero-filled or allocated in
+ * steady state. Block is rewound once all buffers handed out from it are released. Adaptive read size doubles when a
+ * read fills it completely and halves after a series of small reads, staying within [size, max_size].
+ */
+class ReceiveBuffer {
+ public:
+  // Lightweight MutableBufferSequence: asio copies the sequence into the operation, copy of a vector would allocate
+  using MutableBuffersType = boost::iterator_range<std::vector<boost::asio::mutable_buffer>::const_iterator>;
+
+  static constexpr std::size_t kDefaultSize = 1024u;
+
+  static constexpr std::size_t kDefaultMaxSize = 64u * 1024u;
+
+  /**
+   * Create receive buffer.
+   * @param size Initial and minimal read size.
+   * @param max_size Maximal read size. Read size is fixed if it is not greater than size.
+   */
+  explicit ReceiveBuffer(std::size_t size = kDefaultSize, std::size_t max_size = kDefaultMaxSize);
+
+  ReceiveBuffer(const ReceiveBuffer&) = delete;
+  ReceiveBuffer& operator=(const ReceiveBuffer&) = delete;
+
+  /**
+   * Change read sizes. Applied on the next read.
+   * @param size Initial and minimal read size.
+   * @param max_size Maximal read size.
+   */
+  void SetSize(std::size_t size, std::size_t max_size);
+
+  /**
+   * Get memory for the next read of adaptive size.
+   * @return Mutable buffer sequence, valid until the next call.
+   */
+  MutableBuffersType Prepare();
+
+  /**
+   * Get memory for the next read of exact size. Doesn't affect adaptive read size.
+   * @param size Size of the read.
+   * @return Mutable buffer sequence, valid until the next call.
+   */
+  MutableBuffersType Prepare(std::size_t size);
+
+  /**
+   * Finish the read.
+   * @param size Amount of bytes read into the memory returned by Prepare.
+   * @return Buffer which holds the read bytes.
+   */
+  Buffer Commit(std::size_t size);
+
+  /**
+   * Get size which the next adaptive read will use.
+   * @return Size in bytes.
+   */
+  std::size_t GetCapacity() const;
+
+ private:
+  // Count of consecutive reads using at most a quarter of the read size which makes it shrink
+  static constexpr std::size_t kShrinkReadCount = 64u;
+
+  // Smaller tail of a block is skipped, so small reads are not split between blocks
+  static constexpr std::size_t kMinTailSize = 256u;
+
+  // Front block is used starting from offset_, further blocks are not used yet. All are referenced by Buffers handed
+  // out or not at all
+  std::vector<BufferBlockPtr> blocks_;
+
+  std::size_t offset_ = 0u;
+
+  std::vector<boost::asio::mutable_buffer> buffers_;
+
+  std::size_t capacity_;
+
+  std::size_t min_size_;
+
+  std::size_t max_size_;
+
+  std::size_t small_read_count_ = 0u;
+
+  bool is_adaptive_read_ = false;
+};
+
+}  // namespace net
+}  // namespace rms
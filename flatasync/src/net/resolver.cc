@@ -11,7 +11,8 @@ rms::net::Resolver::EndPointsType rms::net::Resolver::Resolve(const std::string&
   boost::asio::ip::tcp::resolver::query query(hostname, std::to_string(port));
   EndPointsType result;
   DeferIo([this, &query, &result](IoHandlerType proceed) {
-    resolver_.async_resolve(query, [proceed, &result](const ErrorType& error, EndPointsType end_points) {
+    resolver_.async_resolve(query, [proceed = std::move(proceed), &result](const ErrorType& error,
+                                                                          EndPointsType end_points) mutable {
       if (!error) {
         result = end_points;
       }
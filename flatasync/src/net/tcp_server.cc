@@ -5,18 +5,23 @@
 #include <utility>
 
 #include "core/async.h"
+#include "core/sequential_scheduler.h"
 #include "net/acceptor.h"
 
 #include <algorithm>
 #include <boost/asio.hpp>
 #include <boost/none.hpp>
 #include <cassert>
-#include <ext/alloc_traits.h>
-#include <functional>
+#include <chrono>
+#include <cstdint>
 #include <iterator>
+#include "core/iioservice.h"
 #include "net/tcp_socket.h"
+#include "net/util.h"
+#include "util/metrics.h"
 
 using rms::core::RunAsync;
+using rms::core::SequentialScheduler;
 using rms::net::BufferType;
 using rms::net::ErrorType;
 using rms::net::TcpServerIdType;
@@ -24,17 +29,40 @@ using rms::net::TcpSocket;
 
 namespace {
 
-std::size_t GetSocketIndex(TcpServerIdType id) {
-  if (id < 1) {
-    // Wrong id. Id is 1-based
-    return 0;
-  }
-  return id - 1;
+const char connection_scheduler_name[] = "tcp_connection";
+
+// Persistent accept errors like EMFILE leave the listening socket readable, so the next accept is delayed rather than
+// failing again at once
+const auto kAcceptErrorDelay = std::chrono::milliseconds(100);
+
+// Out of descriptors or memory: retrying at once fails again until some are released
+bool IsResourceExhausted(const rms::net::ErrorType& error) {
+  return error == boost::asio::error::no_descriptors ||
+         error == boost::system::errc::too_many_files_open_in_system || error == boost::asio::error::no_buffer_space ||
+         error == boost::asio::error::no_memory;
+}
+
+rms::util::MetricCounter& GetAcceptedCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter(
+      "flatasync_tcp_server_accepted_connections_total", "Connections accepted by TCP servers");
+  return counter;
+}
+
+rms::util::MetricCounter& GetRefusedCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter(
+      "flatasync_tcp_server_refused_connections_total", "Connections refused by TCP servers over the limit");
+  return counter;
+}
+
+rms::util::MetricGauge& GetConnectionsGauge() {
+  static auto& gauge = rms::util::GetMetricsRegistryInstance().GetGauge("flatasync_tcp_server_connections",
+                                                                       "Clients connected to TCP servers");
+  return gauge;
 }
 
 }  // namespace
 
-rms::net::TcpServer::TcpServer(int max_connections) : client_connections_(max_connections) {}
+rms::net::TcpServer::TcpServer(std::size_t max_connections) : client_connections_(max_connections) {}
 
 rms::net::TcpServer::~TcpServer() = default;
 
@@ -42,25 +70,30 @@ void rms::net::TcpServer::OnAccepted(std::shared_ptr<TcpSocket> accepted_socket)
   LOG_INFO("Accepted socket");
   assert(accepted_socket);
 
+  auto& socket = *accepted_socket;
+  // Stop takes the same lock to collect sockets after it has reset is_running_, so it either finds the socket started
+  // or the socket is not registered at all
+  std::unique_lock<std::mutex> lock(connections_mutex_);
   if (!is_running_) {
     LOG_INFO("Server is not running. Skipping acceptance.");
     return;
   }
 
-  const auto index = GetNewConnectionIndex();
-  if (!index) {
+  const auto id = client_connections_.Insert(accepted_socket);
+  if (!id) {
+    lock.unlock();
+    GetRefusedCounter().Increment();
     LOG_INFO("Max connections reached. Connection refused");
     accepted_socket->Stop();
     return;
   }
 
-  client_connections_[*index] = std::move(accepted_socket);
-
-  auto& socket = *(client_connections_[*index]);
-  // index is zero based, id it's 1-based
-  const auto id = *index + 1;
-  socket.SetId(id);
-  LOG_INFO("Connected client. id: " << id);
+  GetAcceptedCounter().Increment();
+  GetConnectionsGauge().Add(1);
+  socket.SetId(*id);
+  auto& scheduler = GetConnectionScheduler(*id, socket.GetAsioService());
+  socket.SetWriteHighWaterMark(write_high_water_mark_, write_overflow_policy_);
+  LOG_INFO("Connected client. id: " << *id);
 
   // Register to socket events
 
@@ -70,29 +103,68 @@ void rms::net::TcpServer::OnAccepted(std::shared_ptr<TcpSocket> accepted_socket)
     on_data_(socket.GetId(), data);
   });
 
-  socket.SubscribeOnDisconnected([&](TcpSocket& socket) {
+  socket.SubscribeOnDisconnected([&, connection_scheduler = &scheduler](TcpSocket& socket) {
+    // Client stays on the scheduler it was accepted on, even if Start has replaced the schedulers since
     LOG_DEBUG("Socket disconnected id: " << socket.GetId());
     assert(socket.GetId());
-    RunAsync([&]() {
-      const auto id = socket.GetId();
-      on_disconnected_(id);
-      LOG_DEBUG("Releasing socket id=" << id);
-      client_connections_[GetSocketIndex(id)].reset();
-      if (!is_running_) {
-        RaiseOnClosed();
-      }
-    });
+    RunAsync(
+        [&]() {
+          const auto id = socket.GetId();
+          on_disconnected_(id);
+          LOG_DEBUG("Releasing socket id=" << id);
+          std::shared_ptr<TcpSocket> released_socket;
+          {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            released_socket = client_connections_.Erase(id).value_or(nullptr);
+          }
+          if (released_socket) {
+            GetConnectionsGauge().Add(-1);
+          }
+          if (!is_running_) {
+            RaiseOnClosed();
+          }
+        },
+        *connection_scheduler);
   });
 
-  RunAsync([&]() { on_connected_(socket.GetId()); });
-
-  socket.Start();
+  // Queued ahead of the read loop, so OnConnected precedes data of the client on its sequential scheduler
+  RunAsync([&]() { on_connected_(socket.GetId()); }, scheduler);
+  socket.Start(scheduler);
+}
 
-  RunAsync([&]() {
-    if (is_running_) {
-      acceptor_->DoAccept(std::bind(&TcpServer::OnAccepted, this, std::placeholders::_1));
+void rms::net::TcpServer::RunAcceptLoop(Acceptor& acceptor) {
+  LOG_AUTO_TRACE();
+  const auto batch_size = std::max<std::size_t>(accept_options_.accept_batch_size, 1u);
+  std::vector<std::shared_ptr<TcpSocket>> sockets;
+  sockets.reserve(batch_size);
+  // Next accept is armed as soon as the accepted sockets are registered
+  while (is_running_ && acceptor.IsOpen()) {
+    ErrorType error;
+    if (batch_size == 1u) {
+      auto socket = acceptor.Accept(error);
+      if (socket) {
+        OnAccepted(std::move(socket));
+      }
+    } else {
+      acceptor.AcceptBatch(sockets, batch_size, error);
+      for (auto& socket : sockets) {
+        OnAccepted(std::move(socket));
+      }
+      sockets.clear();
     }
-  });
+    if (!error || !is_running_ || !acceptor.IsOpen()) {
+      continue;
+    }
+    if (!IsResourceExhausted(error)) {
+      // Failure of a single connection, the rest are accepted right away
+      LOG_DEBUG("Accept failed: " << error.message());
+      continue;
+    }
+    LOG_WARN("Accept failed: " << error.message() << ". Retrying in " << kAcceptErrorDelay.count() << " ms");
+    boost::asio::steady_timer timer(rms::core::GetCurrentThreadIoService().GetAsioService(), kAcceptErrorDelay);
+    DeferIo([&timer](IoHandlerType proceed) { timer.async_wait(std::move(proceed)); });
+  }
+  LOG_DEBUG("Accept loop has finished");
 }
 
 void rms::net::TcpServer::Start(const EndPointType& endpoint) {
@@ -110,8 +182,32 @@ void rms::net::TcpServer::Start(const EndPointType& endpoint) {
       LOG_DEBUG("Skip start listening: not running.");
       return;
     }
-    LOG_INFO("Accepting client connections on " << endpoint.address() << ":" << endpoint.port());
-    acceptor_ = std::make_unique<Acceptor>(endpoint);
+    const auto acceptor_count = std::max<std::size_t>(accept_options_.acceptor_count, 1u);
+    const auto accepts_per_acceptor = std::max<std::size_t>(accept_options_.accepts_per_acceptor, 1u);
+    LOG_INFO("Accepting client connections on " << endpoint.address() << ":" << endpoint.port() << " with "
+                                                << acceptor_count << " acceptor(s)");
+    const auto reuse_port = acceptor_count > 1u;
+    std::vector<std::shared_ptr<Acceptor>> acceptors;
+    for (std::size_t i = 0u; i < acceptor_count; ++i) {
+      // In Sharded mode every acceptor is bound to the next shard
+      acceptors.push_back(std::make_shared<Acceptor>(endpoint, reuse_port, accept_options_.listen_backlog));
+    }
+    {
+      std::lock_guard<std::mutex> lock(connections_mutex_);
+      if (connection_schedulers_.size() != connection_scheduler_count_) {
+        LOG_INFO("Client connections are processed by " << connection_scheduler_count_ << " sequential scheduler(s)");
+        std::move(connection_schedulers_.begin(),
+                  connection_schedulers_.end(),
+                  std::back_inserter(retired_connection_schedulers_));
+        connection_schedulers_.clear();
+        for (std::size_t i = 0u; i < connection_scheduler_count_; ++i) {
+          // In Sharded mode every scheduler is bound to the next shard
+          connection_schedulers_.push_back(std::make_unique<SequentialScheduler>(
+              rms::core::GetCurrentThreadIoService(), connection_scheduler_name));
+        }
+      }
+      acceptors_ = acceptors;
+    }
 
     RunAsync([&]() {
       LOG_DEBUG("Start listening");
@@ -119,7 +215,11 @@ void rms::net::TcpServer::Start(const EndPointType& endpoint) {
       on_listening_();
     });
 
-    acceptor_->DoAccept(std::bind(&TcpServer::OnAccepted, this, std::placeholders::_1));
+    for (auto& acceptor : acceptors) {
+      for (std::size_t i = 0u; i < accepts_per_acceptor; ++i) {
+        RunAsync([this, acceptor]() { RunAcceptLoop(*acceptor); });
+      }
+    }
   });
 }
 
@@ -153,37 +253,65 @@ void rms::net::TcpServer::Stop() {
     }
     is_running_ = false;
 
-    LOG_DEBUG("Stopping acceptor");
-    acceptor_->Stop();
+    LOG_DEBUG("Stopping acceptors");
+    std::vector<std::shared_ptr<Acceptor>> acceptors;
+    {
+      std::lock_guard<std::mutex> lock(connections_mutex_);
+      acceptors = acceptors_;
+    }
+    for (auto& acceptor : acceptors) {
+      acceptor->Stop();
+    }
     LOG_DEBUG("Stopping all connected sockets");
-    for (auto&& item : client_connections_) {
-      if (item) {
-        LOG_DEBUG("Stopping socket id: " << item->GetId());
-        item->Stop();
-      }
+    for (auto&& item : GetSockets()) {
+      LOG_DEBUG("Stopping socket id: " << item->GetId());
+      item->Stop();
     }
     RaiseOnClosed();
   });
 }
 
+void rms::net::TcpServer::SetMaxConnections(std::size_t max_connections) {
+  LOG_AUTO_TRACE();
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  LOG_INFO("Max connections: " << max_connections << ", connected: " << client_connections_.GetSize());
+  client_connections_.SetCapacity(max_connections);
+}
+
+void rms::net::TcpServer::SetAcceptOptions(const AcceptOptions& options) {
+  LOG_AUTO_TRACE();
+  accept_options_ = options;
+}
+
+void rms::net::TcpServer::SetConnectionSchedulerCount(std::size_t count) {
+  LOG_AUTO_TRACE();
+  connection_scheduler_count_ = count;
+}
+
+std::size_t rms::net::TcpServer::GetMaxConnections() const {
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  return client_connections_.GetCapacity();
+}
+
 std::size_t rms::net::TcpServer::GetConnectedCount() const {
-  return std::count_if(
-      std::begin(client_connections_), std::end(client_connections_), [](const auto& item) { return item; });
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  return client_connections_.GetSize();
 }
 
-boost::optional<TcpServerIdType> rms::net::TcpServer::GetNewConnectionIndex() const {
-  const auto iter = std::find_if(client_connections_.begin(),
-                                 client_connections_.end(),
-                                 [](const ClientConnectionItemType& item) { return !static_cast<bool>((item)); });
-  if (iter == client_connections_.end()) {
-    return boost::none;
-  }
-  return static_cast<TcpServerIdType>(std::distance(client_connections_.begin(), iter));
+std::vector<std::shared_ptr<TcpSocket>> rms::net::TcpServer::GetSockets() {
+  std::vector<std::shared_ptr<TcpSocket>> sockets;
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  sockets.reserve(client_connections_.GetSize());
+  client_connections_.ForEach([&sockets](TcpServerIdType, const ClientConnectionItemType& item) {
+    sockets.push_back(item);
+  });
+  return sockets;
 }
 
 void rms::net::TcpServer::StopClient(TcpServerIdType id) {
   LOG_AUTO_TRACE();
-  RunAsync([&] {
+  // Id is captured by value: the call returns before the task runs
+  RunAsync([&, id] {
     auto socket = GetSocket(id);
 
     if (!socket) {
@@ -206,9 +334,9 @@ boost::signals2::connection rms::net::TcpServer::SubscribeOnConnected(const OnCo
   return on_connected_.connect(subscriber);
 }
 
-boost::signals2::connection rms::net::TcpServer::SubscribeOnData(const OnDataSubscriberType& subscriber) {
+rms::util::SignalConnection rms::net::TcpServer::SubscribeOnData(OnDataSubscriberType subscriber) {
   LOG_AUTO_TRACE();
-  return on_data_.connect(subscriber);
+  return on_data_.Connect(std::move(subscriber));
 }
 
 boost::signals2::connection rms::net::TcpServer::SubscribeOnDisconnected(
@@ -224,25 +352,41 @@ boost::signals2::connection rms::net::TcpServer::SubscribeOnStopped(const OnStop
 
 std::shared_ptr<rms::net::TcpSocket> rms::net::TcpServer::GetSocket(TcpServerIdType id) {
   LOG_AUTO_TRACE();
-  if (id < 1) {
-    LOG_DEBUG("Wrong id. Id is 1-based");
-    return nullptr;
-  }
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  const auto* socket = client_connections_.Find(id);
 
-  const auto index = GetSocketIndex(id);
-  if (index >= client_connections_.size()) {
-    LOG_DEBUG("Wrong id. Id is greater than size");
+  if (socket == nullptr) {
+    LOG_DEBUG("Wrong id. No such connection.");
     return nullptr;
   }
 
-  auto socket = client_connections_[index];
+  return *socket;
+}
 
-  if (!socket) {
-    LOG_DEBUG("Wrong id. No such connection.");
-    return nullptr;
+rms::core::IScheduler& rms::net::TcpServer::GetConnectionScheduler(TcpServerIdType id,
+                                                                   rms::core::AsioServiceType& service) {
+  if (connection_schedulers_.empty()) {
+    return rms::core::GetCurrentThreadScheduler();
   }
-
-  return socket;
+  // Lower half of the id is the slot index, so clients which reuse the slot share the scheduler
+  const auto index = static_cast<std::uint32_t>(id);
+  // Prefer schedulers of the socket's shard, so io completions don't hop between shards
+  const auto is_same_service = [&service](const std::unique_ptr<SequentialScheduler>& scheduler) {
+    return &scheduler->GetAsioService() == &service;
+  };
+  const auto same_service_count = static_cast<std::size_t>(
+      std::count_if(connection_schedulers_.begin(), connection_schedulers_.end(), is_same_service));
+  if (same_service_count == 0u) {
+    return *connection_schedulers_[index % connection_schedulers_.size()];
+  }
+  auto skip_count = index % same_service_count;
+  for (auto& scheduler : connection_schedulers_) {
+    if (is_same_service(scheduler) && skip_count-- == 0u) {
+      return *scheduler;
+    }
+  }
+  assert(false && "Scheduler of the socket's service must be found");
+  return *connection_schedulers_.front();
 }
 
 boost::optional<BufferType> rms::net::TcpServer::ReadExact(TcpServerIdType id, std::size_t size) {
@@ -278,14 +422,57 @@ boost::optional<BufferType> rms::net::TcpServer::ReadUntil(TcpServerIdType id, c
   return socket->ReadUntil(delimiter);
 }
 
-void rms::net::TcpServer::Write(TcpServerIdType id, const BufferType& buffer) {
+rms::net::ErrorType rms::net::TcpServer::Write(TcpServerIdType id, const BufferType& buffer) {
   LOG_AUTO_TRACE();
   LOG_DEBUG("Writing to id=" << id);
   auto socket = GetSocket(id);
 
   if (!socket) {
-    return;
+    return boost::asio::error::not_connected;
+  }
+
+  return socket->Write(buffer);
+}
+
+rms::net::ErrorType rms::net::TcpServer::Write(TcpServerIdType id, BufferViewType buffer) {
+  LOG_AUTO_TRACE();
+  LOG_DEBUG("Writing to id=" << id);
+  auto socket = GetSocket(id);
+
+  if (!socket) {
+    return boost::asio::error::not_connected;
+  }
+
+  return socket->Write(buffer);
+}
+
+rms::net::ErrorType rms::net::TcpServer::Write(TcpServerIdType id, BufferRefsType buffers) {
+  LOG_AUTO_TRACE();
+  LOG_DEBUG("Writing to id=" << id);
+  auto socket = GetSocket(id);
+
+  if (!socket) {
+    return boost::asio::error::not_connected;
+  }
+
+  return socket->Write(buffers);
+}
+
+void rms::net::TcpServer::SetWriteHighWaterMark(std::size_t high_water_mark, WriteQueue::OverflowPolicy policy) {
+  LOG_AUTO_TRACE();
+  write_high_water_mark_ = high_water_mark;
+  write_overflow_policy_ = policy;
+  for (const auto& socket : GetSockets()) {
+    socket->SetWriteHighWaterMark(high_water_mark, policy);
+  }
+}
+
+boost::optional<rms::net::WriteQueue::Stats> rms::net::TcpServer::GetWriteQueueStats(TcpServerIdType id) {
+  auto socket = GetSocket(id);
+
+  if (!socket) {
+    return boost::none;
   }
 
-  socket->Write(buffer);
+  return socket->GetWriteQueueStats();
 }
@@ -2,7 +2,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -11,7 +14,17 @@
 #include <boost/signals2.hpp>
 
 #include "net/alias.h"
+#include "net/write_queue.h"
+#include "util/fast_signal.h"
 #include "util/logger.h"
+#include "util/slot_map.h"
+
+namespace rms {
+namespace core {
+class IScheduler;
+class SequentialScheduler;
+}  // namespace core
+}  // namespace rms
 
 namespace rms {
 namespace net {
@@ -34,11 +47,47 @@ class TcpServer {
   TcpServer(const TcpServer&) = delete;
 
   /**
-   * Create Tcp server and limit amount of connections.
+   * Create Tcp server and limit amount of connections. Client ids carry generation of the connection slot, so id of a
+   * disconnected client never refers to a client accepted later. Memory for connections is allocated on demand, so the
+   * limit can be large.
    * @param max_connections Maximum count of connection server can hold. If max count is reached new connections will be
    * rejected.
    */
-  explicit TcpServer(int max_connections);
+  explicit TcpServer(std::size_t max_connections);
+
+  /**
+   * Options of accepting new connections.
+   */
+  struct AcceptOptions {
+    // Count of listening sockets. Several sockets are bound to the endpoint with SO_REUSEPORT, kernel balances
+    // incoming connections between them
+    std::size_t acceptor_count = 1u;
+
+    // Count of accepts kept outstanding on every listening socket, each one is served by its own accept loop
+    std::size_t accepts_per_acceptor = 1u;
+
+    // Max count of pending connections accepted at once when listening socket becomes ready. Above 1 drains the
+    // backlog with non-blocking accepts, 1 makes a separate async accept per connection
+    std::size_t accept_batch_size = 1u;
+
+    // Max length of the queue of pending connections of every listening socket
+    int listen_backlog = boost::asio::socket_base::max_connections;
+  };
+
+  /**
+   * Set options of accepting new connections. Applied by the next Start.
+   * @param options Accept options.
+   */
+  void SetAcceptOptions(const AcceptOptions& options);
+
+  /**
+   * Process client connections on several sequential schedulers instead of the scheduler of the server. Every client is
+   * bound to one of them by its id: events of a client are ordered, different clients are processed in parallel. In
+   * Sharded mode schedulers are spread between shards and client is bound to a scheduler of the shard of its socket, so
+   * count should be a multiple of the shard count. Applied by the next Start.
+   * @param count Count of schedulers, 0 to process clients on the scheduler which has started the server.
+   */
+  void SetConnectionSchedulerCount(std::size_t count);
 
   /**
    * Start listening on specified address.
@@ -64,6 +113,19 @@ class TcpServer {
    */
   void Stop();
 
+  /**
+   * Change limit of connections at runtime. Lowered limit doesn't drop connected clients: new connections are rejected
+   * until enough clients disconnect, so load is shed gracefully.
+   * @param max_connections Maximum count of connection server can hold.
+   */
+  void SetMaxConnections(std::size_t max_connections);
+
+  /**
+   * Get limit of connections.
+   * @return Maximum count of connection server can hold.
+   */
+  std::size_t GetMaxConnections() const;
+
   /**
    * Disconnect specific client connection.
    * @param id Identifier of the client to deal with.
@@ -97,8 +159,46 @@ class TcpServer {
    * Sends data to specific client. Makes async
    * @param id Identifier of the client to deal with.
    * @param buffer Buffer which holds data to send.
+   * @return Error code, not_connected if client is unknown.
+   */
+  ErrorType Write(TcpServerIdType id, const BufferType& buffer);
+
+  /**
+   * Sends data to specific client. Makes async
+   * @param id Identifier of the client to deal with.
+   * @param buffer Data to send. Must stay valid until the call returns.
+   * @return Error code, not_connected if client is unknown.
    */
-  void Write(TcpServerIdType id, const BufferType& buffer);
+  ErrorType Write(TcpServerIdType id, BufferViewType buffer);
+
+  /**
+   * Sends several buffers to specific client with a single gathered write. Makes async
+   * @param id Identifier of the client to deal with.
+   * @param buffers Data to send in order. Must stay valid until the call returns.
+   * @return Error code, not_connected if client is unknown.
+   */
+  ErrorType Write(TcpServerIdType id, BufferRefsType buffers);
+
+  /**
+   * Limit bytes of pending writes of every client, see TcpSocket::SetWriteHighWaterMark.
+   * @param high_water_mark Max amount of queued and in flight bytes per client.
+   * @param policy Whether writers over the mark wait or fail.
+   */
+  void SetWriteHighWaterMark(std::size_t high_water_mark, WriteQueue::OverflowPolicy policy);
+
+  /**
+   * Get counters of the write queue of specific client.
+   * @param id Identifier of the client to deal with.
+   * @return Snapshot of the counters if client is connected.
+   */
+  boost::optional<WriteQueue::Stats> GetWriteQueueStats(TcpServerIdType id);
+
+  /**
+   * Get socket of specific client, e.g. to inspect its options or the shard it is bound to.
+   * @param id Identifier of the client to deal with.
+   * @return Socket if client is connected, nullptr otherwise.
+   */
+  std::shared_ptr<TcpSocket> GetSocket(TcpServerIdType id);
 
   using OnListeningType = boost::signals2::signal<void()>;
   using OnListeningSubscriberType = OnListeningType::slot_type;
@@ -120,15 +220,16 @@ class TcpServer {
    */
   boost::signals2::connection SubscribeOnConnected(const OnConnectedSubscriberType& subscriber);
 
-  using OnDataType = boost::signals2::signal<void(TcpServerIdType id, const BufferType& data)>;
-  using OnDataSubscriberType = OnDataType::slot_type;
+  using OnDataType = rms::util::FastSignal<void(TcpServerIdType id, const BufferType& data)>;
+  using OnDataSubscriberType = OnDataType::SubscriberType;
 
   /**
-   * Register to OnData which will be fired when data is received from client. Server should be started first.
+   * Register to OnData which will be fired when data is received from client. Server should be started first. Data
+   * shares blocks of the receive buffer of the client socket, keeping a copy of it doesn't copy the bytes.
    * @param subscriber Slot which will be fired when data is received from client.
    * @return Connection of the signal to slot.
    */
-  boost::signals2::connection SubscribeOnData(const OnDataSubscriberType& subscriber);
+  rms::util::SignalConnection SubscribeOnData(OnDataSubscriberType subscriber);
 
   using OnDisconnectedType = boost::signals2::signal<void(TcpServerIdType id)>;
   using OnDisconnectedSubscriberType = OnDisconnectedType::slot_type;
@@ -155,15 +256,23 @@ class TcpServer {
 
   void OnAccepted(std::shared_ptr<TcpSocket> accepted_socket);
 
-  boost::optional<TcpServerIdType> GetNewConnectionIndex() const;
+  void RunAcceptLoop(Acceptor& acceptor);
 
-  std::shared_ptr<TcpSocket> GetSocket(TcpServerIdType id);
+  // Called under connections_mutex_
+  rms::core::IScheduler& GetConnectionScheduler(TcpServerIdType id, rms::core::AsioServiceType& service);
+
+  std::vector<std::shared_ptr<TcpSocket>> GetSockets();
 
   void RaiseOnClosed();
 
   std::size_t GetConnectedCount() const;
 
-  bool is_running_ = false;
+  // Read by accept loops and disconnect handlers running on any thread
+  std::atomic_bool is_running_{false};
+
+  std::size_t write_high_water_mark_ = std::numeric_limits<std::size_t>::max();
+
+  WriteQueue::OverflowPolicy write_overflow_policy_ = WriteQueue::OverflowPolicy::Suspend;
 
   OnConnectedType on_connected_;
 
@@ -175,10 +284,26 @@ class TcpServer {
 
   OnStoppedType on_stopped_;
 
-  std::unique_ptr<rms::net::Acceptor> acceptor_;
+  AcceptOptions accept_options_;
+
+  // Shared with accept loops, which might still be finishing after Stop when Start replaces the acceptors. Guarded by
+  // connections_mutex_
+  std::vector<std::shared_ptr<rms::net::Acceptor>> acceptors_;
+
+  std::size_t connection_scheduler_count_ = 0u;
+
+  // Created by Start, client is bound to the scheduler by its id and shard. Guarded by connections_mutex_
+  std::vector<std::unique_ptr<rms::core::SequentialScheduler>> connection_schedulers_;
+
+  // Replaced by Start with a different count, clients of the previous run might still be running on them
+  std::vector<std::unique_ptr<rms::core::SequentialScheduler>> retired_connection_schedulers_;
 
   using ClientConnectionItemType = std::shared_ptr<rms::net::TcpSocket>;
-  std::vector<ClientConnectionItemType> client_connections_;
+
+  // Accessed from accept, disconnect and client calls running on any thread
+  mutable std::mutex connections_mutex_;
+
+  rms::util::SlotMap<ClientConnectionItemType> client_connections_;
 };
 
 }  // namespace net
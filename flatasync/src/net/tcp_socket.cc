@@ -5,15 +5,49 @@
 #include <utility>
 
 #include <boost/asio.hpp>
+#include <boost/container/small_vector.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <boost/system/error_code.hpp>
 #include "core/async.h"
 #include "core/iioservice.h"
 #include "net/util.h"
+#include "util/metrics.h"
 
 using rms::core::GetCurrentThreadIoService;
 using rms::core::RunAsync;
 using rms::net::TcpServerIdType;
 
+namespace {
+
+rms::util::MetricCounter& GetReceivedBytesCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter(
+      "flatasync_tcp_socket_received_bytes_total", "Bytes received by TCP sockets");
+  return counter;
+}
+
+rms::util::MetricCounter& GetSentBytesCounter() {
+  static auto& counter = rms::util::GetMetricsRegistryInstance().GetCounter("flatasync_tcp_socket_sent_bytes_total",
+                                                                           "Bytes sent by TCP sockets");
+  return counter;
+}
+
+// Remainder of the read memory after the bytes read before the read was aborted
+boost::container::small_vector<boost::asio::mutable_buffer, 8u> SkipBytes(
+    rms::net::ReceiveBuffer::MutableBuffersType buffers, std::size_t size) {
+  boost::container::small_vector<boost::asio::mutable_buffer, 8u> remainder;
+  for (const auto& buffer : buffers) {
+    if (size >= buffer.size()) {
+      size -= buffer.size();
+      continue;
+    }
+    remainder.push_back(buffer + size);
+    size = 0u;
+  }
+  return remainder;
+}
+
+}  // namespace
+
 std::shared_ptr<rms::net::TcpSocket> rms::net::TcpSocket::Create() {
   return std::make_shared<TcpSocket>(TcpSocket::PrivateKey());
 }
@@ -23,10 +57,12 @@ std::shared_ptr<rms::net::TcpSocket> rms::net::TcpSocket::Create(AsioTcpSocketTy
 }
 
 rms::net::TcpSocket::TcpSocket(const PrivateKey& /*unused*/)
-    : socket_(GetCurrentThreadIoService().GetAsioService()), scheduler_(rms::core::GetCurrentThreadScheduler()) {}
+    : socket_(GetCurrentThreadIoService().GetAsioService()),
+      write_queue_(socket_),
+      scheduler_(rms::core::GetCurrentThreadScheduler()) {}
 
 rms::net::TcpSocket::TcpSocket(const PrivateKey& /*unused*/, AsioTcpSocketType socket)
-    : socket_(std::move(socket)), scheduler_(rms::core::GetCurrentThreadScheduler()) {}
+    : socket_(std::move(socket)), write_queue_(socket_), scheduler_(rms::core::GetCurrentThreadScheduler()) {}
 
 rms::net::TcpSocket::~TcpSocket() {
   LOG_DEBUG("[" << GetId() << "] Destroying socket");
@@ -34,16 +70,31 @@ rms::net::TcpSocket::~TcpSocket() {
 
 rms::net::BufferType rms::net::TcpSocket::ReadExact(std::size_t size) {
   auto self = shared_from_this();
-  BufferType buffer(size, 0);
   if (!socket_.is_open()) {
     LOG_DEBUG("Skip ReadExact: not open");
-    return buffer;
+    return BufferType();
   }
 
-  DeferIo([&, self](IoHandlerType proceed) {
-    boost::asio::async_read(
-        socket_, boost::asio::buffer(&buffer[0], buffer.size()), BufferIoHandler(buffer, std::move(proceed)));
-  });
+  std::size_t transferred = 0u;
+  const auto buffers = receive_buffer_.Prepare(size);
+  while (true) {
+    std::size_t read_size = 0u;
+    const auto error = DeferIo(
+        [&, self](IoHandlerType proceed) {
+          if (transferred == 0u) {
+            boost::asio::async_read(socket_, buffers, BufferIoHandler(read_size, std::move(proceed)));
+          } else {
+            boost::asio::async_read(
+                socket_, SkipBytes(buffers, transferred), BufferIoHandler(read_size, std::move(proceed)));
+          }
+        },
+        [this] { CancelIo(); });
+    transferred += read_size;
+    if (!IsAbortedByOtherOperation(error)) {
+      break;
+    }
+  }
+  GetReceivedBytesCounter().Increment(transferred);
 
   if (!socket_.is_open() && !stopped_) {
     stopped_ = true;
@@ -51,22 +102,29 @@ rms::net::BufferType rms::net::TcpSocket::ReadExact(std::size_t size) {
     RunAsync([&, self]() { on_disconnected_(*this); }, scheduler_);
   }
 
-  return buffer;
+  return receive_buffer_.Commit(transferred);
 }
 
 std::pair<rms::net::BufferType, rms::net::ErrorType> rms::net::TcpSocket::ReadPartial() {
-  constexpr static const int MAX_BUFFER = 1024;
   auto self = shared_from_this();
-  BufferType buffer(MAX_BUFFER, 0);
   if (!socket_.is_open()) {
     LOG_DEBUG("Skip ReadPartial: not open");
-    return std::make_pair(buffer, ErrorType());
+    return std::make_pair(BufferType(), ErrorType());
   }
 
-  const auto error = DeferIo([&, self](IoHandlerType proceed) {
-    socket_.async_read_some(boost::asio::buffer(&buffer[0], buffer.size()),
-                            BufferIoHandler(buffer, std::move(proceed)));
-  });
+  std::size_t transferred = 0u;
+  ErrorType error;
+  do {
+    error = DeferIo(
+        [&, self](IoHandlerType proceed) {
+          socket_.async_read_some(receive_buffer_.Prepare(), BufferIoHandler(transferred, std::move(proceed)));
+        },
+        [this] { CancelIo(); });
+  } while (transferred == 0u && IsAbortedByOtherOperation(error));
+  if (IsAbortedByOtherOperation(error)) {
+    error = ErrorType();
+  }
+  GetReceivedBytesCounter().Increment(transferred);
 
   if (!socket_.is_open() && !stopped_) {
     stopped_ = true;
@@ -74,43 +132,75 @@ std::pair<rms::net::BufferType, rms::net::ErrorType> rms::net::TcpSocket::ReadPa
     RunAsync([&, self]() { on_disconnected_(*this); }, scheduler_);
   }
 
-  return std::make_pair(buffer, error);
+  return std::make_pair(receive_buffer_.Commit(transferred), error);
 }
 
-rms::net::BufferType rms::net::TcpSocket::ReadUntil(const std::string& delimiter) {
-  auto self = shared_from_this();
-  boost::asio::streambuf buffer;
+void rms::net::TcpSocket::SetReceiveBufferSize(std::size_t size, std::size_t max_size) {
+  receive_buffer_.SetSize(size, max_size);
+}
 
+rms::net::BufferType rms::net::TcpSocket::ReadUntil(const std::string& delimiter) {
+  BufferType buffer;
   if (!socket_.is_open()) {
     LOG_DEBUG("Skip ReadUntil: not open");
-    return ToBuffer(buffer);
+    return buffer;
   }
 
-  DeferIo([&, self](IoHandlerType proceed) {
-    boost::asio::async_read_until(socket_, buffer, delimiter, BufferIoHandler(std::move(proceed)));
-  });
+  // Consecutive reads share blocks of the receive buffer, so accumulating them doesn't copy
+  while (true) {
+    // Delimiter might span the previous and the new data
+    const auto search_from = buffer.GetSize() - std::min(buffer.GetSize(), delimiter.size());
+    const auto read_result = ReadPartial();
+    buffer.Append(read_result.first);
+    if (read_result.second || read_result.first.IsEmpty() ||
+        buffer.Find(delimiter, search_from) != BufferType::npos) {
+      return buffer;
+    }
+  }
+}
 
-  if (!socket_.is_open() && !stopped_) {
-    stopped_ = true;
-    LOG_DEBUG("[" << GetId() << "] Closed after async operation (ReadUntil): raise on_disconnect");
-    RunAsync([&, self]() { on_disconnected_(*this); }, scheduler_);
+rms::net::ErrorType rms::net::TcpSocket::Write(const BufferType& buffer) {
+  // Stays on the coroutine stack while the write is pending
+  const boost::container::small_vector<boost::asio::const_buffer, 8u> const_buffers(buffer.GetSlices().begin(),
+                                                                                    buffer.GetSlices().end());
+  return WriteBuffers(boost::make_iterator_range(const_buffers.data(), const_buffers.data() + const_buffers.size()));
+}
+
+rms::net::ErrorType rms::net::TcpSocket::Write(BufferViewType buffer) {
+  const boost::asio::const_buffer const_buffer(buffer.data(), buffer.size());
+  return WriteBuffers(boost::make_iterator_range(&const_buffer, &const_buffer + 1));
+}
+
+rms::net::ErrorType rms::net::TcpSocket::Write(BufferRefsType buffers) {
+  boost::container::small_vector<boost::asio::const_buffer, 8u> const_buffers;
+  for (const auto& buffer : buffers) {
+    buffer.AppendTo(const_buffers);
   }
+  return WriteBuffers(boost::make_iterator_range(const_buffers.data(), const_buffers.data() + const_buffers.size()));
+}
+
+void rms::net::TcpSocket::SetWriteHighWaterMark(std::size_t high_water_mark, WriteQueue::OverflowPolicy policy) {
+  write_queue_.SetHighWaterMark(high_water_mark, policy);
+}
 
-  return ToBuffer(buffer);
+rms::net::WriteQueue::Stats rms::net::TcpSocket::GetWriteQueueStats() const {
+  return write_queue_.GetStats();
 }
 
-void rms::net::TcpSocket::Write(const BufferType& buffer) {
+rms::net::ErrorType rms::net::TcpSocket::WriteBuffers(WriteQueue::ConstBuffersType buffers) {
   auto self = shared_from_this();
-  DeferIo([&, self](IoHandlerType proceed) {
-    boost::asio::async_write(
-        socket_, boost::asio::buffer(&buffer[0], buffer.size()), BufferIoHandler(std::move(proceed)));
-  });
+  const auto error = write_queue_.Write(buffers);
+  if (!error) {
+    GetSentBytesCounter().Increment(boost::asio::buffer_size(buffers));
+  }
 
   if (!socket_.is_open() && !stopped_) {
     stopped_ = true;
     LOG_DEBUG("[" << GetId() << "] Closed after async operation (Write): raise on_disconnect");
     RunAsync([&, self]() { on_disconnected_(*this); }, scheduler_);
   }
+
+  return error;
 }
 
 void rms::net::TcpSocket::Connect(const std::string& ip, int port) {
@@ -126,7 +216,8 @@ void rms::net::TcpSocket::Connect(const EndPointType& end_point) {
   auto self = shared_from_this();
   stopped_ = false;
   LOG_DEBUG("[" << GetId() << "] Connecting");
-  DeferIo([&, self](IoHandlerType proceed) { socket_.async_connect(end_point, proceed); });
+  DeferIo([&, self](IoHandlerType proceed) { socket_.async_connect(end_point, std::move(proceed)); },
+          [this] { CancelIo(); });
 
   if (!socket_.is_open() && !stopped_) {
     stopped_ = true;
@@ -165,15 +256,29 @@ void rms::net::TcpSocket::Stop() {
   });
 }
 
+void rms::net::TcpSocket::CancelIo() {
+  LOG_DEBUG("[" << GetId() << "] Aborting pending operations");
+  // Cancelled on the io service of the socket rather than from the cancelling thread, operations of the socket which
+  // are aborted along with the cancelled one are issued again
+  boost::asio::post(socket_.get_executor(), [self = shared_from_this()] {
+    boost::system::error_code error;
+    self->socket_.cancel(error);
+  });
+}
+
+bool rms::net::TcpSocket::IsAbortedByOtherOperation(const ErrorType& error) const {
+  return error == boost::asio::error::operation_aborted && socket_.is_open();
+}
+
 rms::net::TcpSocket::SocketOptsMap rms::net::TcpSocket::GetSocketOpts() const {
   boost::asio::ip::tcp::no_delay no_delay_option;
   socket_.get_option(no_delay_option);
   return {{SocketOpt::NoDelay, no_delay_option.value()}};
 }
 
-boost::signals2::connection rms::net::TcpSocket::SubscribeOnData(const OnDataSubscriberType& subscriber) {
+rms::util::SignalConnection rms::net::TcpSocket::SubscribeOnData(OnDataSubscriberType subscriber) {
   LOG_AUTO_TRACE();
-  return on_data_.connect(subscriber);
+  return on_data_.Connect(std::move(subscriber));
 }
 
 boost::signals2::connection rms::net::TcpSocket::SubscribeOnDisconnected(
@@ -183,6 +288,10 @@ boost::signals2::connection rms::net::TcpSocket::SubscribeOnDisconnected(
 }
 
 void rms::net::TcpSocket::Start() {
+  Start(rms::core::GetCurrentThreadScheduler());
+}
+
+void rms::net::TcpSocket::Start(rms::core::IScheduler& scheduler) {
   LOG_AUTO_TRACE();
   auto self = shared_from_this();
 
@@ -191,55 +300,70 @@ void rms::net::TcpSocket::Start() {
     return;
   }
 
-  RunAsync([&, self]() {
-    LOG_DEBUG("[" << GetId() << "] Calling async_receive");
-
-    const auto read_result = ReadPartial();
-
-    const auto& error = read_result.second;
-
-    if ((error == boost::asio::error::eof) || (error == boost::asio::error::connection_reset) ||
-        (error == boost::asio::error::operation_aborted)) {
-      LOG_DEBUG("[" << GetId() << "] Start: disconnected");
-
-      if (!stopped_) {
-        LOG_DEBUG("[" << GetId() << "] Start: disconnected");
-        on_disconnected_(*this);
-      } else {
-        LOG_DEBUG("[" << GetId()
-                      << "] Start: disconnected. Skip disconnection "
-                         "event, already stopped.");
-      }
-      return;
-    }
-
-    if (error.value() != boost::system::errc::success) {
-      LOG_DEBUG("[" << GetId() << "] Start error: " << error.value() << ", message: " << error.message());
-      Stop();
-
-      if (!stopped_) {
-        on_disconnected_(*this);
-
-      } else {
-        LOG_DEBUG("[" << GetId() << "] Start: skip disconnection event, already stopped.");
-      }
-
-      return;
-    }
-
-    LOG_DEBUG("[" << GetId() << "] Start: raising OnData. bytes_transferred: " << read_result.first.size());
-
-    // Run directly here instead of inside async op to avoid buffer copy
-    on_data_(*this, read_result.first);
-
-    RunAsync([&, self]() { Start(); });
-  });
+  // Single coroutine serves the connection for its whole life: it suspends on every read and resumes on its completion,
+  // so no runner is created per received packet
+  RunAsync(
+      [&, self]() {
+        while (socket_.is_open()) {
+          LOG_DEBUG("[" << GetId() << "] Calling async_receive");
+
+          const auto read_result = ReadPartial();
+
+          const auto& error = read_result.second;
+
+          if ((error == boost::asio::error::eof) || (error == boost::asio::error::connection_reset) ||
+              (error == boost::asio::error::operation_aborted)) {
+            if (!stopped_) {
+              LOG_DEBUG("[" << GetId() << "] Start: disconnected");
+              on_disconnected_(*this);
+            } else {
+              LOG_DEBUG("[" << GetId()
+                            << "] Start: disconnected. Skip disconnection "
+                               "event, already stopped.");
+            }
+            return;
+          }
+
+          if (error.value() != boost::system::errc::success) {
+            LOG_DEBUG("[" << GetId() << "] Start error: " << error.value() << ", message: " << error.message());
+            Stop();
+
+            if (!stopped_) {
+              on_disconnected_(*this);
+
+            } else {
+              LOG_DEBUG("[" << GetId() << "] Start: skip disconnection event, already stopped.");
+            }
+
+            return;
+          }
+
+          LOG_DEBUG("[" << GetId() << "] Start: raising OnData. bytes_transferred: " << read_result.first.GetSize());
+
+          // Run directly here instead of inside async op: data shares blocks of the receive buffer, no copy is made
+          on_data_(*this, read_result.first);
+        }
+
+        LOG_DEBUG("[" << GetId() << "] Start: socket is closed, stop reading");
+        // Closed by Stop while no read was pending, so no read has reported it
+        if (!stopped_) {
+          stopped_ = true;
+          on_disconnected_(*this);
+        }
+      },
+      scheduler);
 }
 
 TcpServerIdType rms::net::TcpSocket::GetId() const {
   return id_;
 }
 
+rms::core::AsioServiceType& rms::net::TcpSocket::GetAsioService() {
+  // Sockets are created on io services only
+  return static_cast<rms::core::AsioServiceType&>(
+      boost::asio::query(socket_.get_executor(), boost::asio::execution::context));
+}
+
 void rms::net::TcpSocket::SetId(TcpServerIdType id) {
   LOG_DEBUG("Changing Id from " << id_ << " to " << id);
   id_ = id;
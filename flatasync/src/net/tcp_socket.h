@@ -12,7 +12,10 @@
 #include <array>
 #include <string>
 #include "net/alias.h"
+#include "net/receive_buffer.h"
+#include "net/write_queue.h"
 #include "util/enum_util.h"
+#include "util/fast_signal.h"
 #include "util/logger.h"
 
 namespace rms {
@@ -87,6 +90,13 @@ class TcpSocket : public std::enable_shared_from_this<TcpSocket> {
    */
   std::pair<BufferType, ErrorType> ReadPartial();
 
+  /**
+   * Configure receive buffer used by ReadPartial and Start. Applied on the next read.
+   * @param size Initial and minimal size of the buffer.
+   * @param max_size Size the buffer can grow to if reads fill it completely. Equal to size disables adaptive sizing.
+   */
+  void SetReceiveBufferSize(std::size_t size, std::size_t max_size);
+
   /**
    * Read from socket until delimiter reached. Buffer can contain data after delimiter. Should be called within async
    * task. Suspends execution until result is received.
@@ -97,9 +107,40 @@ class TcpSocket : public std::enable_shared_from_this<TcpSocket> {
 
   /**
    * Write buffer to socket. Should be called within async task. Suspends execution until result is received.
+   * Concurrent writes are queued and coalesced, see SetWriteHighWaterMark.
    * @param buffer Data to be sent.
+   * @return Error code, no_buffer_space if rejected by the write queue.
+   */
+  ErrorType Write(const BufferType& buffer);
+
+  /**
+   * Write data to socket. Should be called within async task. Suspends execution until result is received.
+   * @param buffer Data to be sent. Must stay valid until the call returns.
+   * @return Error code, no_buffer_space if rejected by the write queue.
+   */
+  ErrorType Write(BufferViewType buffer);
+
+  /**
+   * Write several buffers to socket with a single gathered write, e.g. header, payload and trailer without
+   * concatenating them. Should be called within async task. Suspends execution until result is received.
+   * @param buffers Data to be sent in order. Must stay valid until the call returns.
+   * @return Error code, no_buffer_space if rejected by the write queue.
+   */
+  ErrorType Write(BufferRefsType buffers);
+
+  /**
+   * Limit bytes of pending writes. Writes issued while another write is in flight are queued and sent together with
+   * one gathered write. Unlimited by default.
+   * @param high_water_mark Max amount of queued and in flight bytes.
+   * @param policy Whether writers over the mark wait or fail.
+   */
+  void SetWriteHighWaterMark(std::size_t high_water_mark, WriteQueue::OverflowPolicy policy);
+
+  /**
+   * Get counters of the write queue: queue depth, batches and bytes written by them.
+   * @return Snapshot of the counters.
    */
-  void Write(const BufferType& buffer);
+  WriteQueue::Stats GetWriteQueueStats() const;
 
   /**
    * Establish connection to remote peer. Should be called within async task. Suspends execution until result is
@@ -118,9 +159,17 @@ class TcpSocket : public std::enable_shared_from_this<TcpSocket> {
 
   /**
    * Start listening for incoming data. Doesn't block. Fires OnData signal when data received and keep listening.
+   * All reads of the connection run in one long-lived coroutine, OnData handlers are called from it.
    */
   void Start();
 
+  /**
+   * Start listening for incoming data on specific scheduler. Same as Start, but the read coroutine and OnData handlers
+   * run on the given scheduler, e.g. a sequential one which orders them with other tasks of the connection.
+   * @param scheduler Scheduler of the read coroutine. Must outlive the socket.
+   */
+  void Start(rms::core::IScheduler& scheduler);
+
   /**
    * Close socket and cleanup.
    */
@@ -138,6 +187,12 @@ class TcpSocket : public std::enable_shared_from_this<TcpSocket> {
    */
   void SetId(TcpServerIdType id);
 
+  /**
+   * Get asio io service the socket is bound to. In Sharded mode this is the shard which completes its io.
+   * @return Asio io service of the socket.
+   */
+  rms::core::AsioServiceType& GetAsioService();
+
   using SocketOptsMap = std::unordered_map<SocketOpt, bool, rms::util::enum_util::EnumClassHash>;
 
   /**
@@ -146,15 +201,16 @@ class TcpSocket : public std::enable_shared_from_this<TcpSocket> {
    */
   SocketOptsMap GetSocketOpts() const;
 
-  using OnDataType = boost::signals2::signal<void(TcpSocket& socket, const BufferType& data)>;
-  using OnDataSubscriberType = OnDataType::slot_type;
+  using OnDataType = rms::util::FastSignal<void(TcpSocket& socket, const BufferType& data)>;
+  using OnDataSubscriberType = OnDataType::SubscriberType;
 
   /**
-   * Register to OnData event which will be fired when data is received.
+   * Register to OnData event which will be fired when data is received. Data shares blocks of the receive buffer,
+   * subscribers can keep a copy of it without copying the bytes.
    * @param subscriber Slot which will be fired when data is received.
    * @return Connection of the signal to slot.
    */
-  boost::signals2::connection SubscribeOnData(const OnDataSubscriberType& subscriber);
+  rms::util::SignalConnection SubscribeOnData(OnDataSubscriberType subscriber);
 
   using OnDisconnectedType = boost::signals2::signal<void(TcpSocket& socket)>;
   using OnDisconnectedSubscriberType = OnDisconnectedType::slot_type;
@@ -169,8 +225,21 @@ class TcpSocket : public std::enable_shared_from_this<TcpSocket> {
  private:
   DECLARE_GET_LOGGER("Net.Socket")
 
+  ErrorType WriteBuffers(WriteQueue::ConstBuffersType buffers);
+
+  // Aborts pending async operations, invoked when the async task gets Cancelled or Timedout
+  void CancelIo();
+
+  // Operation has been aborted by CancelIo of another operation: asio can only cancel all operations of the socket, so
+  // operations which were not cancelled themselves are issued again. Own cancel throws on resume instead
+  bool IsAbortedByOtherOperation(const ErrorType& error) const;
+
   AsioTcpSocketType socket_;
 
+  ReceiveBuffer receive_buffer_;
+
+  WriteQueue write_queue_;
+
   OnDataType on_data_;
 
   OnDisconnectedType on_disconnected_;
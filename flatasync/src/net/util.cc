@@ -19,30 +19,13 @@ rms::net::NetworkIoSchedulerAccessor& rms::net::GetNetworkSchedulerAccessorInsta
   return rms::util::single<NetworkIoSchedulerAccessor>();
 }
 
-rms::net::ErrorType rms::net::DeferIo(CallbackIoHandlerType callback) {
-  ErrorType error;
-  rms::core::DeferProceed([callback = std::move(callback), &error](rms::core::HandlerType proceed) {
-    callback([proceed, &error](const ErrorType& e) {
-      error = e;
-      proceed();
-    });
-  });
-  return error;
-}
-
-rms::net::BufferIoHandlerType rms::net::BufferIoHandler(BufferType& buffer, IoHandlerType proceed) {
-  return [&buffer, proceed = std::move(proceed)](const ErrorType& error, std::size_t size) {
-    if (!error) {
-      buffer.resize(size);
-    }
+rms::net::BufferIoHandlerType rms::net::BufferIoHandler(std::size_t& size, IoHandlerType proceed) {
+  return [&size, proceed = std::move(proceed)](const ErrorType& error, std::size_t transferred) mutable {
+    size = transferred;
     proceed(error);
   };
 }
 
 rms::net::BufferIoHandlerType rms::net::BufferIoHandler(IoHandlerType proceed) {
-  return [proceed = std::move(proceed)](const ErrorType& error, std::size_t) { proceed(error); };
-}
-
-rms::net::BufferType rms::net::ToBuffer(const boost::asio::streambuf& streambuf) {
-  return {boost::asio::buffers_begin(streambuf.data()), boost::asio::buffers_end(streambuf.data())};
+  return [proceed = std::move(proceed)](const ErrorType& error, std::size_t) mutable { proceed(error); };
 }
@@ -3,7 +3,11 @@
 #pragma once
 
 #include <boost/asio.hpp>
+#include <utility>
+#include "core/async.h"
+#include "core/async_runner.h"
 #include "net/alias.h"
+#include "util/scope_guard.h"
 #include "util/singleton.h"
 
 namespace rms {
@@ -44,18 +48,60 @@ NetworkIoSchedulerAccessor& GetNetworkSchedulerAccessorInstance();
 
 /**
  * Helper function for asio net functions. Allows to set operations to run after asio async call will finish.
+ * @tparam Callback Callable which accepts IoHandlerType. Not type erased, so captures do not count against inline
+ * buffer of the deferred task.
  * @param callback Operation to run after asio net operation will finish.
  * @return Error code.
  */
-ErrorType DeferIo(CallbackIoHandlerType callback);
+template <typename Callback>
+ErrorType DeferIo(Callback callback) {
+  ErrorType error;
+  core::DeferProceed([callback = std::move(callback), &error](core::CallbackType proceed) mutable {
+    callback(IoHandlerType([proceed = std::move(proceed), &error](const ErrorType& e) {
+      error = e;
+      proceed();
+    }));
+  });
+  return error;
+}
+
+/**
+ * Helper function for asio net functions which can be aborted. While operation is pending, Cancel or Timedout of the
+ * async task calls abort, so the task is interrupted without waiting for the io to complete. Abort is not armed if
+ * events are disabled.
+ * @tparam Callback Callable which accepts IoHandlerType.
+ * @tparam Abort Callable which aborts pending asio operation, e.g. cancels the socket. Called from the thread which
+ * cancels the task.
+ * @param callback Operation to run after asio net operation will finish.
+ * @param abort Operation which aborts pending asio operation.
+ * @return Error code.
+ */
+template <typename Callback, typename Abort>
+ErrorType DeferIo(Callback callback, Abort abort) {
+  auto& async_runner = core::GetCurrentThreadAsyncRunner();
+  if (!async_runner.GetIsEventsAllowed()) {
+    return DeferIo(std::move(callback));
+  }
+  const auto op_state_view = async_runner.GetOpStateView();
+  op_state_view.SetCancelHandler(std::move(abort));
+  const auto cancel_handler_guard =
+      util::MakeScopeGuard([op_state_view] { op_state_view.ResetCancelHandler(); });
+  // Owning state: operation might complete and the task might finish while this callback is still running
+  return DeferIo([callback = std::move(callback), op_state = async_runner.GetOpState()](IoHandlerType proceed) mutable {
+    callback(std::move(proceed));
+    // Status might have been changed before operation started, so cancel handler had nothing to abort. Handler is
+    // invoked under its lock: if operation has already completed and the task has reset the handler, nothing is touched
+    op_state.GetView().InvokeCancelHandler();
+  });
+}
 
 /**
  * Helper for asio net calls.
- * @param buffer Buffer for result.
+ * @param size Amount of transferred bytes, set on completion.
  * @param proceed Continuation
  * @return Continuation
  */
-BufferIoHandlerType BufferIoHandler(BufferType& buffer, IoHandlerType proceed);
+BufferIoHandlerType BufferIoHandler(std::size_t& size, IoHandlerType proceed);
 
 /**
  * Helper for asio net calls.
@@ -64,12 +110,5 @@ BufferIoHandlerType BufferIoHandler(BufferType& buffer, IoHandlerType proceed);
  */
 BufferIoHandlerType BufferIoHandler(IoHandlerType proceed);
 
-/**
- * Converts (copy) asio stream buffer to internal buffer.
- * @param streambuf Input asio buffer.
- * @return Copy of the input buffer.
- */
-BufferType ToBuffer(const boost::asio::streambuf& streambuf);
-
 }  // namespace net
 }  // namespace rms
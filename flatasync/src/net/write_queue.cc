@@ -0,0 +1,155 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/write_queue.h"
+#include <algorithm>
+#include <utility>
+#include "net/util.h"
+
+rms::net::WriteQueue::WriteQueue(AsioTcpSocketType& socket) : socket_(socket) {}
+
+void rms::net::WriteQueue::SetHighWaterMark(std::size_t high_water_mark, OverflowPolicy policy) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  high_water_mark_ = high_water_mark;
+  policy_ = policy;
+}
+
+rms::net::ErrorType rms::net::WriteQueue::Write(ConstBuffersType buffers) {
+  Request request;
+  request.buffers = buffers;
+  request.size = boost::asio::buffer_size(buffers);
+  return DeferIo(
+      [this, &request](IoHandlerType proceed) {
+        request.proceed = std::move(proceed);
+        Enqueue(request);
+      },
+      [this, &request] { Abort(request); });
+}
+
+rms::net::WriteQueue::Stats rms::net::WriteQueue::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void rms::net::WriteQueue::Enqueue(Request& request) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto is_over_mark =
+      stats_.pending_bytes != 0u && (!suspended_.empty() || stats_.pending_bytes + request.size > high_water_mark_);
+  if (is_over_mark && policy_ == OverflowPolicy::Reject) {
+    ++stats_.rejected_count;
+    auto proceed = std::move(request.proceed);
+    lock.unlock();
+    LOG_DEBUG("Write rejected: " << request.size << " bytes over high-water mark");
+    proceed(boost::asio::error::no_buffer_space);
+    return;
+  }
+  if (is_over_mark) {
+    suspended_.push_back(request);
+  } else {
+    queued_.push_back(request);
+    stats_.pending_bytes += request.size;
+  }
+  UpdateQueueDepth();
+  if (in_flight_.empty()) {
+    StartBatch();
+  }
+}
+
+void rms::net::WriteQueue::Abort(const Request& request) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Only addresses are compared: request might have already completed and been destroyed
+  const auto is_request = [&request](const Request& other) { return &other == &request; };
+  for (auto* list : {&queued_, &suspended_}) {
+    const auto it = std::find_if(list->begin(), list->end(), is_request);
+    if (it == list->end()) {
+      continue;
+    }
+    if (list == &queued_) {
+      stats_.pending_bytes -= it->size;
+    }
+    auto proceed = std::move(it->proceed);
+    list->erase(it);
+    UpdateQueueDepth();
+    lock.unlock();
+    proceed(boost::asio::error::operation_aborted);
+    return;
+  }
+  // In flight request is left to complete with its batch: cancelling the socket would fail the other writers of the
+  // batch and pending reads, buffers of the writer are pinned until Write returns anyway
+}
+
+void rms::net::WriteQueue::AdmitSuspended() {
+  while (!suspended_.empty()) {
+    auto& request = suspended_.front();
+    if (stats_.pending_bytes != 0u && stats_.pending_bytes + request.size > high_water_mark_) {
+      break;
+    }
+    suspended_.pop_front();
+    queued_.push_back(request);
+    stats_.pending_bytes += request.size;
+  }
+}
+
+void rms::net::WriteQueue::StartBatch() {
+  if (queued_.empty()) {
+    return;
+  }
+  in_flight_.splice(in_flight_.end(), queued_);
+  batch_buffers_.clear();
+  in_flight_bytes_ = 0u;
+  for (const auto& request : in_flight_) {
+    batch_buffers_.insert(batch_buffers_.end(), request.buffers.begin(), request.buffers.end());
+    in_flight_bytes_ += request.size;
+  }
+  ++stats_.batch_count;
+  stats_.write_count += in_flight_.size();
+  UpdateQueueDepth();
+  LOG_TRACE("Writing batch: " << in_flight_.size() << " writes, " << in_flight_bytes_ << " bytes");
+  WriteBatch();
+}
+
+void rms::net::WriteQueue::WriteBatch() {
+  boost::asio::async_write(socket_,
+                           boost::make_iterator_range(batch_buffers_.cbegin(), batch_buffers_.cend()),
+                           [this](const ErrorType& error, std::size_t size) { OnBatchWritten(error, size); });
+}
+
+void rms::net::WriteQueue::OnBatchWritten(const ErrorType& error, std::size_t size) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (error == boost::asio::error::operation_aborted && socket_.is_open()) {
+    // Socket has been cancelled to abort a read, writers of the batch are not cancelled: write the rest
+    auto it = batch_buffers_.begin();
+    for (; it != batch_buffers_.end() && size >= it->size(); ++it) {
+      size -= it->size();
+    }
+    if (it != batch_buffers_.end()) {
+      *it += size;
+    }
+    batch_buffers_.erase(batch_buffers_.begin(), it);
+    LOG_TRACE("Resuming aborted batch");
+    WriteBatch();
+    return;
+  }
+  RequestListType completed;
+  completed.swap(in_flight_);
+  stats_.pending_bytes -= in_flight_bytes_;
+  if (!error) {
+    stats_.written_bytes += in_flight_bytes_;
+  }
+  in_flight_bytes_ = 0u;
+  AdmitSuspended();
+  // Queued writers keep the socket alive, so the next batch is started before the completed ones are resumed
+  StartBatch();
+  lock.unlock();
+
+  while (!completed.empty()) {
+    auto& request = completed.front();
+    completed.pop_front();
+    auto proceed = std::move(request.proceed);
+    proceed(error);
+  }
+}
+
+void rms::net::WriteQueue::UpdateQueueDepth() {
+  stats_.queue_depth = queued_.size() + suspended_.size();
+  stats_.max_queue_depth = std::max(stats_.max_queue_depth, stats_.queue_depth);
+}
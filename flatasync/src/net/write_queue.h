@@ -0,0 +1,154 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/intrusive/list.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "net/alias.h"
+#include "util/logger.h"
+
+namespace rms {
+namespace net {
+
+/**
+ * Outbound queue of a socket. Writers which come while a write is in flight are queued and sent together with one
+ * gathered write once it completes, so concurrent writers keep their order and share syscalls. High-water mark limits
+ * amount of pending bytes: writers beyond it are suspended until the queue drains or rejected.
+ */
+class WriteQueue {
+ public:
+  using ConstBuffersType = boost::iterator_range<const boost::asio::const_buffer*>;
+
+  /**
+   * What to do with a writer which would exceed the high-water mark.
+   */
+  enum class OverflowPolicy {
+    /**
+     * Writer waits until pending bytes drop below the mark.
+     */
+    Suspend,
+    /**
+     * Write fails with no_buffer_space, nothing is sent.
+     */
+    Reject
+  };
+
+  /**
+   * Counters of the queue.
+   */
+  struct Stats {
+    // Writes waiting for the next batch (including suspended ones)
+    std::size_t queue_depth = 0u;
+
+    std::size_t max_queue_depth = 0u;
+
+    // Bytes of queued and in flight writes
+    std::size_t pending_bytes = 0u;
+
+    // Gathered writes issued, bytes coalesced per syscall is written_bytes / batch_count
+    std::uint64_t batch_count = 0u;
+
+    std::uint64_t write_count = 0u;
+
+    std::uint64_t written_bytes = 0u;
+
+    std::uint64_t rejected_count = 0u;
+  };
+
+  /**
+   * Create queue.
+   * @param socket Socket to write to. Must outlive the queue.
+   */
+  explicit WriteQueue(AsioTcpSocketType& socket);
+
+  WriteQueue(const WriteQueue&) = delete;
+  WriteQueue& operator=(const WriteQueue&) = delete;
+
+  /**
+   * Set limit of pending bytes. A single write is always admitted to an empty queue.
+   * @param high_water_mark Max amount of queued and in flight bytes.
+   * @param policy Behaviour on overflow.
+   */
+  void SetHighWaterMark(std::size_t high_water_mark, OverflowPolicy policy);
+
+  /**
+   * Write buffers. Should be called within async task. Suspends execution until data is written or failed. Cancel or
+   * Timeout of the task interrupts a queued or suspended write, a write which is already in flight completes first.
+   * @param buffers Data to write, must stay valid until the call returns.
+   * @return Error code of the write.
+   */
+  ErrorType Write(ConstBuffersType buffers);
+
+  /**
+   * Get counters.
+   * @return Snapshot of the counters.
+   */
+  Stats GetStats() const;
+
+ private:
+  DECLARE_GET_LOGGER("Net.WriteQueue")
+
+  using HookType = boost::intrusive::list_member_hook<boost::intrusive::link_mode<boost::intrusive::safe_link>>;
+
+  // Lives on the stack of the suspended writer
+  struct Request {
+    HookType hook;
+
+    ConstBuffersType buffers;
+
+    std::size_t size = 0u;
+
+    IoHandlerType proceed;
+  };
+
+  using RequestListType =
+      boost::intrusive::list<Request, boost::intrusive::member_hook<Request, HookType, &Request::hook>,
+                             boost::intrusive::constant_time_size<true>>;
+
+  void Enqueue(Request& request);
+
+  void Abort(const Request& request);
+
+  // Admits suspended writers which fit under the mark. Called under the lock
+  void AdmitSuspended();
+
+  // Starts gathered write of the queued requests. Called under the lock
+  void StartBatch();
+
+  // Issues write of the batch buffers. Called under the lock
+  void WriteBatch();
+
+  void OnBatchWritten(const ErrorType& error, std::size_t size);
+
+  void UpdateQueueDepth();
+
+  AsioTcpSocketType& socket_;
+
+  mutable std::mutex mutex_;
+
+  RequestListType queued_;
+
+  RequestListType suspended_;
+
+  RequestListType in_flight_;
+
+  // Reused for every batch, used by the in flight write only
+  std::vector<boost::asio::const_buffer> batch_buffers_;
+
+  std::size_t in_flight_bytes_ = 0u;
+
+  std::size_t high_water_mark_ = std::numeric_limits<std::size_t>::max();
+
+  OverflowPolicy policy_ = OverflowPolicy::Suspend;
+
+  Stats stats_;
+};
+
+}  // namespace net
+}  // namespace rms
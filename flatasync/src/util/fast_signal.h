@@ -0,0 +1,162 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "util/inplace_function.h"
+
+namespace rms {
+namespace util {
+
+namespace detail {
+
+/**
+ * Connection state of a FastSignal slot shared with SignalConnection.
+ */
+struct SignalSlotState {
+  std::atomic_bool is_connected{true};
+};
+
+}  // namespace detail
+
+/**
+ * Connection of a FastSignal to its slot. Safe to use from any thread and after the signal is destroyed.
+ */
+class SignalConnection {
+ public:
+  /**
+   * Create connection which is not connected to any slot.
+   */
+  SignalConnection() = default;
+
+  /**
+   * Create connection to the slot.
+   * @param state State of the slot.
+   */
+  explicit SignalConnection(std::weak_ptr<detail::SignalSlotState> state) : state_(std::move(state)) {}
+
+  /**
+   * Disconnect the slot, it won't be called by emissions started afterwards. Emission already in progress on another
+   * thread might still call it.
+   */
+  void Disconnect() const {
+    const auto state = state_.lock();
+    if (state) {
+      state->is_connected.store(false, std::memory_order_release);
+    }
+  }
+
+  /**
+   * Check whether the slot is connected.
+   * @return True if slot is connected and signal is alive.
+   */
+  bool IsConnected() const {
+    const auto state = state_.lock();
+    return state && state->is_connected.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::weak_ptr<detail::SignalSlotState> state_;
+};
+
+template <typename Signature>
+class FastSignal;
+
+/**
+ * Signal for hot path events. Unlike boost::signals2::signal emission takes no lock, copies nothing and never
+ * allocates: slots form an intrusive list which only grows, emission walks it with atomic loads and calls connected
+ * slots in connection order. Single subscriber costs a pointer load and a flag check on top of the call. Connect and
+ * disconnect are lock free as well, so slots can be managed from any thread. Disconnected slots are released with the
+ * signal, so it is meant for long lived subscriptions rather than frequent connect/disconnect.
+ * @tparam Args Types of the arguments.
+ */
+template <typename... Args>
+class FastSignal<void(Args...)> {
+ public:
+  using SubscriberType = InplaceFunction<void(Args...)>;
+
+  FastSignal() = default;
+
+  FastSignal& operator=(const FastSignal&) = delete;
+  FastSignal(const FastSignal&) = delete;
+
+  /**
+   * Destroy signal and all its slots. Must not be emitted concurrently.
+   */
+  ~FastSignal() {
+    auto* slot = head_.load(std::memory_order_acquire);
+    while (slot != nullptr) {
+      auto* next = slot->next.load(std::memory_order_relaxed);
+      // Drops the last strong reference, connections see the slot as gone
+      slot->self.reset();
+      slot = next;
+    }
+  }
+
+  /**
+   * Connect slot to the signal. Slot connected during emission might be called by it.
+   * @param subscriber Slot to call on emission.
+   * @return Connection of the signal to slot.
+   */
+  SignalConnection Connect(SubscriberType subscriber) {
+    auto slot = std::make_shared<Slot>(std::move(subscriber));
+    slot->self = slot;
+    auto* new_slot = slot.get();
+    // Append to the tail, so slots are called in connection order
+    auto* link = &head_;
+    Slot* expected = nullptr;
+    while (!link->compare_exchange_weak(expected, new_slot, std::memory_order_release, std::memory_order_acquire)) {
+      if (expected != nullptr) {
+        link = &expected->next;
+        expected = nullptr;
+      }
+    }
+    return SignalConnection{std::weak_ptr<detail::SignalSlotState>(slot)};
+  }
+
+  /**
+   * Call all connected slots.
+   * @param args Arguments passed to every slot.
+   */
+  void operator()(Args... args) const {
+    for (auto* slot = head_.load(std::memory_order_acquire); slot != nullptr;
+         slot = slot->next.load(std::memory_order_acquire)) {
+      if (slot->is_connected.load(std::memory_order_acquire)) {
+        slot->subscriber(args...);
+      }
+    }
+  }
+
+  /**
+   * Check whether there are no connected slots.
+   * @return True if no slot is connected.
+   */
+  bool IsEmpty() const {
+    for (auto* slot = head_.load(std::memory_order_acquire); slot != nullptr;
+         slot = slot->next.load(std::memory_order_acquire)) {
+      if (slot->is_connected.load(std::memory_order_acquire)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  struct Slot : detail::SignalSlotState {
+    explicit Slot(SubscriberType handler) : subscriber(std::move(handler)) {}
+
+    SubscriberType subscriber;
+
+    std::atomic<Slot*> next{nullptr};
+
+    // Signal owns its slots, connections only observe them
+    std::shared_ptr<Slot> self;
+  };
+
+  std::atomic<Slot*> head_{nullptr};
+};
+
+}  // namespace util
+}  // namespace rms
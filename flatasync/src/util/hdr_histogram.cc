@@ -0,0 +1,145 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/hdr_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Values below kSubBucketCount have a bucket each, every next power of two range is split into kSubBucketHalfCount
+const unsigned kSubBucketBits = 7u;
+
+const std::uint64_t kSubBucketCount = 1u << kSubBucketBits;
+
+const std::uint64_t kSubBucketHalfCount = kSubBucketCount / 2u;
+
+const std::uint64_t kNoMin = std::numeric_limits<std::uint64_t>::max();
+
+void StoreMin(std::atomic<std::uint64_t>& min, std::uint64_t value) {
+  auto current = min.load(std::memory_order_relaxed);
+  while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void StoreMax(std::atomic<std::uint64_t>& max, std::uint64_t value) {
+  auto current = max.load(std::memory_order_relaxed);
+  while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+rms::util::HdrHistogram::HdrHistogram(std::uint64_t highest_trackable_value)
+    : highest_trackable_value_(std::max<std::uint64_t>(highest_trackable_value, 1u)),
+      bucket_count_(GetBucketIndex(highest_trackable_value_) + 1u),
+      counts_(std::make_unique<std::atomic<std::uint64_t>[]>(bucket_count_)),
+      min_(kNoMin) {
+  Reset();
+}
+
+void rms::util::HdrHistogram::Record(std::uint64_t value, std::uint64_t count) {
+  const auto index = GetBucketIndex(std::min(value, highest_trackable_value_));
+  counts_[index].fetch_add(count, std::memory_order_relaxed);
+  sum_.fetch_add(value * count, std::memory_order_relaxed);
+  StoreMin(min_, value);
+  StoreMax(max_, value);
+  total_count_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void rms::util::HdrHistogram::Add(const HdrHistogram& other) {
+  const auto other_count = other.GetCount();
+  if (other_count == 0u) {
+    return;
+  }
+  for (std::size_t index = 0u; index < other.bucket_count_; ++index) {
+    const auto count = other.counts_[index].load(std::memory_order_relaxed);
+    if (count != 0u) {
+      const auto value = std::min(GetBucketUpperBound(index), highest_trackable_value_);
+      counts_[GetBucketIndex(value)].fetch_add(count, std::memory_order_relaxed);
+    }
+  }
+  sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  StoreMin(min_, other.GetMin());
+  StoreMax(max_, other.GetMax());
+  total_count_.fetch_add(other_count, std::memory_order_relaxed);
+}
+
+void rms::util::HdrHistogram::Reset() {
+  for (std::size_t index = 0u; index < bucket_count_; ++index) {
+    counts_[index].store(0u, std::memory_order_relaxed);
+  }
+  total_count_.store(0u, std::memory_order_relaxed);
+  sum_.store(0u, std::memory_order_relaxed);
+  min_.store(kNoMin, std::memory_order_relaxed);
+  max_.store(0u, std::memory_order_relaxed);
+}
+
+std::uint64_t rms::util::HdrHistogram::GetCount() const {
+  return total_count_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t rms::util::HdrHistogram::GetMin() const {
+  const auto min = min_.load(std::memory_order_relaxed);
+  return min == kNoMin ? 0u : min;
+}
+
+std::uint64_t rms::util::HdrHistogram::GetMax() const {
+  return max_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t rms::util::HdrHistogram::GetSum() const {
+  return sum_.load(std::memory_order_relaxed);
+}
+
+double rms::util::HdrHistogram::GetMean() const {
+  const auto count = GetCount();
+  return count == 0u ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(count);
+}
+
+std::uint64_t rms::util::HdrHistogram::GetValueAtPercentile(double percentile) const {
+  // Count of buckets rather than the total, so the result is consistent with buckets while values are recorded
+  std::uint64_t total_count = 0u;
+  for (std::size_t index = 0u; index < bucket_count_; ++index) {
+    total_count += counts_[index].load(std::memory_order_relaxed);
+  }
+  if (total_count == 0u) {
+    return 0u;
+  }
+  const auto ratio = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+  const auto target_count =
+      std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(ratio * static_cast<double>(total_count))), 1u);
+  std::uint64_t count = 0u;
+  for (std::size_t index = 0u; index < bucket_count_; ++index) {
+    count += counts_[index].load(std::memory_order_relaxed);
+    if (count >= target_count) {
+      return std::max(std::min(GetBucketUpperBound(index), GetMax()), GetMin());
+    }
+  }
+  return GetMax();
+}
+
+std::uint64_t rms::util::HdrHistogram::GetHighestTrackableValue() const {
+  return highest_trackable_value_;
+}
+
+std::size_t rms::util::HdrHistogram::GetBucketIndex(std::uint64_t value) {
+  if (value < kSubBucketCount) {
+    return static_cast<std::size_t>(value);
+  }
+  // Keep the top kSubBucketBits - 1 bits of the value below its most significant one
+  const auto msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+  const auto shift = msb - (kSubBucketBits - 1u);
+  return static_cast<std::size_t>(kSubBucketCount + (shift - 1u) * kSubBucketHalfCount +
+                                  ((value >> shift) - kSubBucketHalfCount));
+}
+
+std::uint64_t rms::util::HdrHistogram::GetBucketUpperBound(std::size_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const auto offset = static_cast<std::uint64_t>(index) - kSubBucketCount;
+  const auto shift = offset / kSubBucketHalfCount + 1u;
+  const auto sub_bucket = offset % kSubBucketHalfCount + kSubBucketHalfCount;
+  return ((sub_bucket + 1u) << shift) - 1u;
+}
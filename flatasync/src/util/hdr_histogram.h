@@ -0,0 +1,112 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace rms {
+namespace util {
+
+/**
+ * Histogram of non-negative integer values with high dynamic range, e.g. latencies. Buckets are log-linear: every
+ * power of two range is split into 64 sub-buckets, so recorded values keep relative precision of 1/64 across the
+ * whole range, with exact values below 128. Record is lock free and can be called from any thread; queries see a
+ * recent state and are exact when recording has stopped.
+ */
+class HdrHistogram {
+ public:
+  /**
+   * Create empty histogram.
+   * @param highest_trackable_value Max value tracked with full precision, bigger values are counted as this one.
+   */
+  explicit HdrHistogram(std::uint64_t highest_trackable_value);
+
+  HdrHistogram& operator=(const HdrHistogram&) = delete;
+  HdrHistogram(const HdrHistogram&) = delete;
+
+  /**
+   * Record value.
+   * @param value Value to record.
+   * @param count Count of occurrences of the value.
+   */
+  void Record(std::uint64_t value, std::uint64_t count = 1u);
+
+  /**
+   * Add all values recorded by another histogram.
+   * @param other Histogram to add.
+   */
+  void Add(const HdrHistogram& other);
+
+  /**
+   * Remove all recorded values.
+   */
+  void Reset();
+
+  /**
+   * Get count of recorded values.
+   * @return Count of values.
+   */
+  std::uint64_t GetCount() const;
+
+  /**
+   * Get min recorded value.
+   * @return Min value, 0 if histogram is empty.
+   */
+  std::uint64_t GetMin() const;
+
+  /**
+   * Get max recorded value. Not clamped by the highest trackable value.
+   * @return Max value, 0 if histogram is empty.
+   */
+  std::uint64_t GetMax() const;
+
+  /**
+   * Get sum of recorded values. Not clamped by the highest trackable value.
+   * @return Sum of values, 0 if histogram is empty.
+   */
+  std::uint64_t GetSum() const;
+
+  /**
+   * Get mean of recorded values.
+   * @return Mean value, 0 if histogram is empty.
+   */
+  double GetMean() const;
+
+  /**
+   * Get value below or equal to which given percent of recorded values fall.
+   * @param percentile Percentile in range [0, 100].
+   * @return Highest value equivalent to the bucket of the percentile, 0 if histogram is empty.
+   */
+  std::uint64_t GetValueAtPercentile(double percentile) const;
+
+  /**
+   * Get max value tracked with full precision.
+   * @return Highest trackable value.
+   */
+  std::uint64_t GetHighestTrackableValue() const;
+
+ private:
+  static std::size_t GetBucketIndex(std::uint64_t value);
+
+  static std::uint64_t GetBucketUpperBound(std::size_t index);
+
+  const std::uint64_t highest_trackable_value_;
+
+  const std::size_t bucket_count_;
+
+  std::unique_ptr<std::atomic<std::uint64_t>[]> counts_;
+
+  std::atomic<std::uint64_t> total_count_{0u};
+
+  std::atomic<std::uint64_t> sum_{0u};
+
+  std::atomic<std::uint64_t> min_;
+
+  std::atomic<std::uint64_t> max_{0u};
+};
+
+}  // namespace util
+}  // namespace rms
@@ -0,0 +1,238 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace rms {
+namespace util {
+
+template <typename Signature, std::size_t InlineSize = 64u>
+class InplaceFunction;
+
+/**
+ * Move-only replacement of std::function with inline buffer of configurable size. Callables which fit into the buffer
+ * (and are nothrow move constructible) are stored inline without heap allocation, bigger ones are stored on the heap.
+ * Unlike std::function allows move-only callables, e.g. lambdas capturing std::unique_ptr.
+ * @tparam R Return type.
+ * @tparam Args Types of the arguments.
+ * @tparam InlineSize Size of the inline buffer in bytes.
+ */
+template <typename R, typename... Args, std::size_t InlineSize>
+class InplaceFunction<R(Args...), InlineSize> {
+  template <typename F>
+  using DecayType = typename std::decay<F>::type;
+
+  template <typename F>
+  using EnableIfCallableType = typename std::enable_if<
+      !std::is_same<DecayType<F>, InplaceFunction>::value && !std::is_same<DecayType<F>, std::nullptr_t>::value &&
+      (std::is_void<R>::value ||
+       std::is_convertible<decltype(std::declval<DecayType<F>&>()(std::declval<Args>()...)), R>::value)>::type;
+
+ public:
+  /**
+   * Create empty function.
+   */
+  InplaceFunction() noexcept = default;
+
+  /**
+   * Create empty function.
+   */
+  InplaceFunction(std::nullptr_t) noexcept {}  // NOLINT
+
+  /**
+   * Create function from any callable.
+   * @param f Callable to be stored.
+   */
+  template <typename F, typename = EnableIfCallableType<F>>
+  InplaceFunction(F&& f);  // NOLINT
+
+  InplaceFunction(InplaceFunction&& other) noexcept;
+
+  InplaceFunction& operator=(InplaceFunction&& other) noexcept;
+
+  /**
+   * Destroy stored callable and make function empty.
+   */
+  InplaceFunction& operator=(std::nullptr_t) noexcept;
+
+  InplaceFunction(const InplaceFunction&) = delete;
+  InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+  ~InplaceFunction();
+
+  /**
+   * Call stored callable. Function must not be empty.
+   * @param args Arguments to be passed to callable.
+   * @return Result of the callable.
+   */
+  R operator()(Args... args);
+
+  /**
+   * Check whether function holds callable.
+   * @return True if function is not empty.
+   */
+  explicit operator bool() const noexcept;
+
+  /**
+   * Check whether callable is stored in the inline buffer.
+   * @return True if callable is stored inline. False if it is stored on the heap or function is empty.
+   */
+  bool IsInline() const noexcept;
+
+ private:
+  using StorageType = typename std::aligned_storage<InlineSize, alignof(std::max_align_t)>::type;
+
+  struct Operations {
+    R (*invoke)(StorageType& storage, Args&&... args);
+
+    // Move constructs callable in dst from src and destroys src
+    void (*relocate)(StorageType& dst, StorageType& src) noexcept;
+
+    void (*destroy)(StorageType& storage) noexcept;
+
+    bool is_inline;
+  };
+
+  template <typename F>
+  struct IsInlineable
+      : std::integral_constant<bool, sizeof(F) <= sizeof(StorageType) && alignof(F) <= alignof(StorageType) &&
+                                         std::is_nothrow_move_constructible<F>::value> {};
+
+  template <typename F>
+  struct InlineOperations {
+    static F& Get(StorageType& storage) {
+      return *reinterpret_cast<F*>(&storage);
+    }
+
+    static R Invoke(StorageType& storage, Args&&... args) {
+      return Get(storage)(std::forward<Args>(args)...);
+    }
+
+    static void Relocate(StorageType& dst, StorageType& src) noexcept {
+      new (&dst) F(std::move(Get(src)));
+      Get(src).~F();
+    }
+
+    static void Destroy(StorageType& storage) noexcept {
+      Get(storage).~F();
+    }
+
+    static constexpr Operations value{&Invoke, &Relocate, &Destroy, true};
+  };
+
+  template <typename F>
+  struct HeapOperations {
+    static F*& Get(StorageType& storage) {
+      return *reinterpret_cast<F**>(&storage);
+    }
+
+    static R Invoke(StorageType& storage, Args&&... args) {
+      return (*Get(storage))(std::forward<Args>(args)...);
+    }
+
+    static void Relocate(StorageType& dst, StorageType& src) noexcept {
+      new (&dst) F*(Get(src));
+    }
+
+    static void Destroy(StorageType& storage) noexcept {
+      delete Get(storage);
+    }
+
+    static constexpr Operations value{&Invoke, &Relocate, &Destroy, false};
+  };
+
+  template <typename F>
+  void Construct(F&& f, std::true_type /* is_inlineable */) {
+    new (&storage_) DecayType<F>(std::forward<F>(f));
+    operations_ = &InlineOperations<DecayType<F>>::value;
+  }
+
+  template <typename F>
+  void Construct(F&& f, std::false_type /* is_inlineable */) {
+    new (&storage_) DecayType<F>*(new DecayType<F>(std::forward<F>(f)));
+    operations_ = &HeapOperations<DecayType<F>>::value;
+  }
+
+  StorageType storage_;
+
+  const Operations* operations_ = nullptr;
+};
+
+template <typename R, typename... Args, std::size_t InlineSize>
+template <typename F>
+constexpr typename InplaceFunction<R(Args...), InlineSize>::Operations
+    InplaceFunction<R(Args...), InlineSize>::InlineOperations<F>::value;
+
+template <typename R, typename... Args, std::size_t InlineSize>
+template <typename F>
+constexpr typename InplaceFunction<R(Args...), InlineSize>::Operations
+    InplaceFunction<R(Args...), InlineSize>::HeapOperations<F>::value;
+
+template <typename R, typename... Args, std::size_t InlineSize>
+template <typename F, typename>
+InplaceFunction<R(Args...), InlineSize>::InplaceFunction(F&& f) {
+  Construct(std::forward<F>(f), IsInlineable<DecayType<F>>{});
+}
+
+template <typename R, typename... Args, std::size_t InlineSize>
+InplaceFunction<R(Args...), InlineSize>::InplaceFunction(InplaceFunction&& other) noexcept
+    : operations_(other.operations_) {
+  if (operations_ != nullptr) {
+    operations_->relocate(storage_, other.storage_);
+    other.operations_ = nullptr;
+  }
+}
+
+template <typename R, typename... Args, std::size_t InlineSize>
+InplaceFunction<R(Args...), InlineSize>& InplaceFunction<R(Args...), InlineSize>::operator=(
+    InplaceFunction&& other) noexcept {
+  if (this != &other) {
+    *this = nullptr;
+    if (other.operations_ != nullptr) {
+      other.operations_->relocate(storage_, other.storage_);
+      operations_ = other.operations_;
+      other.operations_ = nullptr;
+    }
+  }
+  return *this;
+}
+
+template <typename R, typename... Args, std::size_t InlineSize>
+InplaceFunction<R(Args...), InlineSize>& InplaceFunction<R(Args...), InlineSize>::operator=(std::nullptr_t) noexcept {
+  if (operations_ != nullptr) {
+    // Reset first: destroyed callable might own the object which owns this function
+    const auto* operations = operations_;
+    operations_ = nullptr;
+    operations->destroy(storage_);
+  }
+  return *this;
+}
+
+template <typename R, typename... Args, std::size_t InlineSize>
+InplaceFunction<R(Args...), InlineSize>::~InplaceFunction() {
+  *this = nullptr;
+}
+
+template <typename R, typename... Args, std::size_t InlineSize>
+R InplaceFunction<R(Args...), InlineSize>::operator()(Args... args) {
+  assert(operations_ != nullptr && "Calling empty InplaceFunction");
+  return operations_->invoke(storage_, std::forward<Args>(args)...);
+}
+
+template <typename R, typename... Args, std::size_t InlineSize>
+InplaceFunction<R(Args...), InlineSize>::operator bool() const noexcept {
+  return operations_ != nullptr;
+}
+
+template <typename R, typename... Args, std::size_t InlineSize>
+bool InplaceFunction<R(Args...), InlineSize>::IsInline() const noexcept {
+  return operations_ != nullptr && operations_->is_inline;
+}
+
+}  // namespace util
+}  // namespace rms
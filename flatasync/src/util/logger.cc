@@ -48,4 +48,9 @@ IMPL_LOGGER_NAMESPACE_::NDCWrapper::~NDCWrapper() {
   log4cplus::getNDC().pop_void();
 }
 
+void IMPL_LOGGER_NAMESPACE_::AutoTrace::Log(const char* prefix) const {
+  logger_->forcedLog(log4cplus::TRACE_LOG_LEVEL, LOG4CPLUS_TEXT(prefix) + log4cplus::tstring(message_), file_, line_,
+                     function_);
+}
+
 #endif
@@ -6,6 +6,33 @@
   do {                    \
   } while (0)
 
+// Compile-time log levels. Log lines below FLATASYNC_MIN_LOG_LEVEL are compiled out, set per target by CMake
+// Level differs between targets, so log macros are used in translation units only: inline or template code of headers
+// would be compiled with different levels in different targets
+#define FLATASYNC_LOG_LEVEL_TRACE 0
+#define FLATASYNC_LOG_LEVEL_DEBUG 1
+#define FLATASYNC_LOG_LEVEL_INFO 2
+#define FLATASYNC_LOG_LEVEL_WARN 3
+#define FLATASYNC_LOG_LEVEL_ERROR 4
+#define FLATASYNC_LOG_LEVEL_FATAL 5
+#define FLATASYNC_LOG_LEVEL_OFF 6
+
+#if !defined(FLATASYNC_MIN_LOG_LEVEL)
+#define FLATASYNC_MIN_LOG_LEVEL FLATASYNC_LOG_LEVEL_TRACE
+#endif
+
+#if FLATASYNC_MIN_LOG_LEVEL < FLATASYNC_LOG_LEVEL_TRACE || FLATASYNC_MIN_LOG_LEVEL > FLATASYNC_LOG_LEVEL_OFF
+#error "FLATASYNC_MIN_LOG_LEVEL must be one of FLATASYNC_LOG_LEVEL_* values"
+#endif
+
+// Stripped log line: message is still compiled (variables are used, typos are caught), but the code is dead
+#define LOG_STRIPPED_(log_macro, logger, message) \
+  do {                                            \
+    if (false) {                                  \
+      log_macro(logger, message);                 \
+    }                                             \
+  } while (0)
+
 #if defined(DISABLE_LOGGER)
 
 #define INIT_LOGGER(log_config) DOWHILE_NOTHING()
@@ -87,6 +114,42 @@ class NDCWrapper {
   ~NDCWrapper();
 };
 
+/**
+ * Logs ENTER\EXIT trace lines on scope entry\exit. Unlike log4cplus::TraceLogger does not build the message when
+ * TRACE level is disabled, thus has no allocations on the hot path.
+ */
+class AutoTrace {
+ public:
+  AutoTrace(const log4cplus::Logger& logger, const char* message, const char* file, int line, const char* function)
+      : logger_(logger.isEnabledFor(log4cplus::TRACE_LOG_LEVEL) ? &logger : nullptr),
+        message_(message),
+        file_(file),
+        line_(line),
+        function_(function) {
+    if (logger_ != nullptr) {
+      Log("ENTER: ");
+    }
+  }
+
+  ~AutoTrace() {
+    if (logger_ != nullptr) {
+      Log("EXIT:  ");
+    }
+  }
+
+  AutoTrace(const AutoTrace&) = delete;
+  AutoTrace& operator=(const AutoTrace&) = delete;
+
+ private:
+  void Log(const char* prefix) const;
+
+  const log4cplus::Logger* logger_;
+  const char* message_;
+  const char* file_;
+  int line_;
+  const char* function_;
+};
+
 }  // namespace logging
 }  // namespace util
 }  // namespace rms
@@ -94,12 +157,41 @@ class NDCWrapper {
 #define INIT_LOGGER(log_config) IMPL_LOGGER_NAMESPACE_::LogManager log_manager__(log_config)
 #define SHUTDOWN_LOGGER() IMPL_LOGGER_NAMESPACE_::LogManager::Shutdown();
 
+#if FLATASYNC_MIN_LOG_LEVEL <= FLATASYNC_LOG_LEVEL_TRACE
 #define LOG_TRACEL(logger, message) LOG4CPLUS_TRACE(logger, LOG4CPLUS_TEXT(message))
+#else
+#define LOG_TRACEL(logger, message) LOG_STRIPPED_(LOG4CPLUS_TRACE, logger, LOG4CPLUS_TEXT(message))
+#endif
+
+#if FLATASYNC_MIN_LOG_LEVEL <= FLATASYNC_LOG_LEVEL_DEBUG
 #define LOG_DEBUGL(logger, message) LOG4CPLUS_DEBUG(logger, LOG4CPLUS_TEXT(message))
+#else
+#define LOG_DEBUGL(logger, message) LOG_STRIPPED_(LOG4CPLUS_DEBUG, logger, LOG4CPLUS_TEXT(message))
+#endif
+
+#if FLATASYNC_MIN_LOG_LEVEL <= FLATASYNC_LOG_LEVEL_INFO
 #define LOG_INFOL(logger, message) LOG4CPLUS_INFO(logger, LOG4CPLUS_TEXT(message))
+#else
+#define LOG_INFOL(logger, message) LOG_STRIPPED_(LOG4CPLUS_INFO, logger, LOG4CPLUS_TEXT(message))
+#endif
+
+#if FLATASYNC_MIN_LOG_LEVEL <= FLATASYNC_LOG_LEVEL_WARN
 #define LOG_WARNL(logger, message) LOG4CPLUS_WARN(logger, LOG4CPLUS_TEXT(message))
+#else
+#define LOG_WARNL(logger, message) LOG_STRIPPED_(LOG4CPLUS_WARN, logger, LOG4CPLUS_TEXT(message))
+#endif
+
+#if FLATASYNC_MIN_LOG_LEVEL <= FLATASYNC_LOG_LEVEL_ERROR
 #define LOG_ERRORL(logger, message) LOG4CPLUS_ERROR(logger, LOG4CPLUS_TEXT(message))
+#else
+#define LOG_ERRORL(logger, message) LOG_STRIPPED_(LOG4CPLUS_ERROR, logger, LOG4CPLUS_TEXT(message))
+#endif
+
+#if FLATASYNC_MIN_LOG_LEVEL <= FLATASYNC_LOG_LEVEL_FATAL
 #define LOG_FATALL(logger, message) LOG4CPLUS_FATAL(logger, LOG4CPLUS_TEXT(message))
+#else
+#define LOG_FATALL(logger, message) LOG_STRIPPED_(LOG4CPLUS_FATAL, logger, LOG4CPLUS_TEXT(message))
+#endif
 
 #define IMPLEMENT_STATIC_LOGGER(logger_name) \
   static auto logger = IMPL_LOGGER_CLASS_TYPE_::getInstance(LOG4CPLUS_TEXT(logger_name))
@@ -122,7 +214,12 @@ class NDCWrapper {
 #define LOG_ERROR(message) LOG_ERRORL(GetLogger(), message)
 #define LOG_FATAL(message) LOG_FATALL(GetLogger(), message)
 
-#define LOG_AUTO_TRACEL(logger, message) LOG4CPLUS_TRACE_METHOD(logger, message)
+#if defined(LOG4CPLUS_DISABLE_TRACE) || FLATASYNC_MIN_LOG_LEVEL > FLATASYNC_LOG_LEVEL_TRACE
+#define LOG_AUTO_TRACEL(logger, message) DOWHILE_NOTHING()
+#else
+#define LOG_AUTO_TRACEL(logger, message) \
+  IMPL_LOGGER_NAMESPACE_::AutoTrace auto_trace__(logger, message, __FILE__, __LINE__, __func__)
+#endif
 #define LOG_AUTO_TRACE() LOG_AUTO_TRACEL(GetLogger(), LOG4CPLUS_TEXT(__func__))
 
 #define LOG_TRACEF(text, ...) LOG_TRACEL(GetLogger(), fmt::format(text, __VA_ARGS__))
@@ -0,0 +1,238 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/metrics.h"
+#include <cassert>
+#include <sstream>
+
+namespace {
+
+// Quantiles of the summaries made from histograms
+const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+std::atomic<std::size_t> next_stripe_index{0u};
+
+void WriteEscaped(std::ostream& stream, const std::string& text, bool is_label_value) {
+  for (const auto symbol : text) {
+    if (symbol == '\\') {
+      stream << "\\\\";
+    } else if (symbol == '\n') {
+      stream << "\\n";
+    } else if (symbol == '"' && is_label_value) {
+      stream << "\\\"";
+    } else {
+      stream << symbol;
+    }
+  }
+}
+
+std::string FormatLabels(const rms::util::MetricLabelsType& labels) {
+  std::ostringstream stream;
+  for (const auto& label : labels) {
+    if (stream.tellp() != 0) {
+      stream << ',';
+    }
+    stream << label.first << "=\"";
+    WriteEscaped(stream, label.second, true);
+    stream << '"';
+  }
+  return stream.str();
+}
+
+// Writes name{labels,extra_label} or name{labels} or name
+void WriteSeriesName(std::ostream& stream,
+                     const std::string& name,
+                     const std::string& labels,
+                     const std::string& extra_label = std::string()) {
+  stream << name;
+  if (labels.empty() && extra_label.empty()) {
+    return;
+  }
+  stream << '{' << labels;
+  if (!labels.empty() && !extra_label.empty()) {
+    stream << ',';
+  }
+  stream << extra_label << '}';
+}
+
+}  // namespace
+
+std::size_t rms::util::detail::GetMetricStripeIndex() {
+  static thread_local const std::size_t index = next_stripe_index++ % kMetricStripeCount;
+  return index;
+}
+
+std::uint64_t rms::util::MetricCounter::GetValue() const {
+  std::uint64_t value = 0u;
+  for (const auto& stripe : stripes_) {
+    value += stripe.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+rms::util::MetricHistogram::MetricHistogram(std::uint64_t highest_trackable_value)
+    : highest_trackable_value_(highest_trackable_value) {
+  for (auto& stripe : stripes_) {
+    stripe.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+rms::util::MetricHistogram::~MetricHistogram() {
+  for (auto& stripe : stripes_) {
+    delete stripe.load(std::memory_order_relaxed);
+  }
+}
+
+void rms::util::MetricHistogram::GetSnapshot(HdrHistogram& snapshot) const {
+  assert(snapshot.GetHighestTrackableValue() == highest_trackable_value_);
+  for (const auto& stripe : stripes_) {
+    const auto* histogram = stripe.load(std::memory_order_acquire);
+    if (histogram != nullptr) {
+      snapshot.Add(*histogram);
+    }
+  }
+}
+
+std::uint64_t rms::util::MetricHistogram::GetHighestTrackableValue() const {
+  return highest_trackable_value_;
+}
+
+rms::util::HdrHistogram& rms::util::MetricHistogram::CreateStripe() {
+  auto& stripe = stripes_[detail::GetMetricStripeIndex()];
+  auto histogram = std::make_unique<HdrHistogram>(highest_trackable_value_);
+  HdrHistogram* expected = nullptr;
+  // Another thread of the same stripe might have been first
+  if (!stripe.compare_exchange_strong(expected, histogram.get(), std::memory_order_acq_rel)) {
+    return *expected;
+  }
+  return *histogram.release();
+}
+
+struct rms::util::MetricsRegistry::Series {
+  std::unique_ptr<MetricCounter> counter;
+
+  std::unique_ptr<MetricGauge> gauge;
+
+  std::unique_ptr<MetricHistogram> histogram;
+
+  GaugeCallbackType gauge_callback;
+};
+
+rms::util::MetricsRegistry::MetricsRegistry() = default;
+
+rms::util::MetricsRegistry::~MetricsRegistry() = default;
+
+rms::util::MetricCounter& rms::util::MetricsRegistry::GetCounter(const std::string& name,
+                                                                 const std::string& help,
+                                                                 const MetricLabelsType& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& series = GetSeries(name, help, Type::Counter, labels);
+  if (!series.counter) {
+    series.counter = std::make_unique<MetricCounter>();
+  }
+  return *series.counter;
+}
+
+rms::util::MetricGauge& rms::util::MetricsRegistry::GetGauge(const std::string& name,
+                                                             const std::string& help,
+                                                             const MetricLabelsType& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& series = GetSeries(name, help, Type::Gauge, labels);
+  assert(!series.gauge_callback && "Gauge is computed by callback");
+  if (!series.gauge) {
+    series.gauge = std::make_unique<MetricGauge>();
+  }
+  return *series.gauge;
+}
+
+rms::util::MetricHistogram& rms::util::MetricsRegistry::GetHistogram(const std::string& name,
+                                                                     const std::string& help,
+                                                                     std::uint64_t highest_trackable_value,
+                                                                     const MetricLabelsType& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& series = GetSeries(name, help, Type::Histogram, labels);
+  if (!series.histogram) {
+    series.histogram = std::make_unique<MetricHistogram>(highest_trackable_value);
+  }
+  return *series.histogram;
+}
+
+void rms::util::MetricsRegistry::SetGaugeCallback(const std::string& name,
+                                                  const std::string& help,
+                                                  GaugeCallbackType callback,
+                                                  const MetricLabelsType& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& series = GetSeries(name, help, Type::Gauge, labels);
+  assert(!series.gauge && "Gauge is set explicitly");
+  series.gauge_callback = std::move(callback);
+}
+
+std::string rms::util::MetricsRegistry::FormatPrometheusText() const {
+  std::ostringstream stream;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& family_item : families_) {
+    const auto& name = family_item.first;
+    const auto& family = family_item.second;
+    stream << "# HELP " << name << ' ';
+    WriteEscaped(stream, family.help, false);
+    stream << "\n# TYPE " << name << ' ';
+    switch (family.type) {
+      case Type::Counter:
+        stream << "counter\n";
+        break;
+      case Type::Gauge:
+        stream << "gauge\n";
+        break;
+      case Type::Histogram:
+        stream << "summary\n";
+        break;
+    }
+    for (const auto& series_item : family.series) {
+      const auto& labels = series_item.first;
+      const auto& series = *series_item.second;
+      if (family.type == Type::Counter) {
+        WriteSeriesName(stream, name, labels);
+        stream << ' ' << series.counter->GetValue() << '\n';
+      } else if (family.type == Type::Gauge) {
+        WriteSeriesName(stream, name, labels);
+        stream << ' ' << (series.gauge_callback ? series.gauge_callback() : series.gauge->GetValue()) << '\n';
+      } else {
+        HdrHistogram snapshot(series.histogram->GetHighestTrackableValue());
+        series.histogram->GetSnapshot(snapshot);
+        for (const auto quantile : kQuantiles) {
+          std::ostringstream quantile_label;
+          quantile_label << "quantile=\"" << quantile << '"';
+          WriteSeriesName(stream, name, labels, quantile_label.str());
+          stream << ' ' << snapshot.GetValueAtPercentile(quantile * 100.0) << '\n';
+        }
+        WriteSeriesName(stream, name + "_sum", labels);
+        stream << ' ' << snapshot.GetSum() << '\n';
+        WriteSeriesName(stream, name + "_count", labels);
+        stream << ' ' << snapshot.GetCount() << '\n';
+      }
+    }
+  }
+  return stream.str();
+}
+
+rms::util::MetricsRegistry::Series& rms::util::MetricsRegistry::GetSeries(const std::string& name,
+                                                                          const std::string& help,
+                                                                          Type type,
+                                                                          const MetricLabelsType& labels) {
+  auto family_it = families_.find(name);
+  if (family_it == families_.end()) {
+    family_it = families_.emplace(name, Family{type, help, {}}).first;
+  }
+  auto& family = family_it->second;
+  assert(family.type == type && "Metric is registered with another type");
+  auto& series = family.series[FormatLabels(labels)];
+  if (!series) {
+    series = std::make_unique<Series>();
+  }
+  return *series;
+}
+
+rms::util::MetricsRegistry& rms::util::GetMetricsRegistryInstance() {
+  // Intentionally leaked: metrics are updated by threads which might outlive static deinitialization
+  static auto* registry = new MetricsRegistry();
+  return *registry;
+}
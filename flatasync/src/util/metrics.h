@@ -0,0 +1,257 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "util/hdr_histogram.h"
+
+namespace rms {
+namespace util {
+
+namespace detail {
+
+// Threads are spread over stripes round-robin, so with up to kMetricStripeCount threads every thread owns a stripe
+const std::size_t kMetricStripeCount = 16u;
+
+/**
+ * Get stripe of the current thread.
+ * @return Index in range [0, kMetricStripeCount).
+ */
+std::size_t GetMetricStripeIndex();
+
+}  // namespace detail
+
+/**
+ * Monotonic counter. Every thread increments its own stripe, so hot paths don't contend on a single cache line.
+ * Stripes are summed by GetValue.
+ */
+class MetricCounter {
+ public:
+  MetricCounter() = default;
+
+  MetricCounter& operator=(const MetricCounter&) = delete;
+  MetricCounter(const MetricCounter&) = delete;
+
+  /**
+   * Increase counter.
+   * @param value Amount to add.
+   */
+  void Increment(std::uint64_t value = 1u) {
+    stripes_[detail::GetMetricStripeIndex()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Get sum of all stripes.
+   * @return Value of the counter.
+   */
+  std::uint64_t GetValue() const;
+
+ private:
+  struct Stripe {
+    std::atomic<std::uint64_t> value{0u};
+
+    // Values of neighbouring stripes never share a cache line
+    char padding[64u - sizeof(std::atomic<std::uint64_t>)];
+  };
+
+  std::array<Stripe, detail::kMetricStripeCount> stripes_;
+};
+
+/**
+ * Value which goes up and down, e.g. count of connections.
+ */
+class MetricGauge {
+ public:
+  MetricGauge() = default;
+
+  MetricGauge& operator=(const MetricGauge&) = delete;
+  MetricGauge(const MetricGauge&) = delete;
+
+  /**
+   * Set value.
+   * @param value New value.
+   */
+  void Set(std::int64_t value) {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Change value.
+   * @param delta Amount to add, negative to subtract.
+   */
+  void Add(std::int64_t delta) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  /**
+   * Get value.
+   * @return Current value.
+   */
+  std::int64_t GetValue() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::int64_t> value_{0};
+};
+
+/**
+ * Distribution of values, e.g. latencies. Every thread records to its own HdrHistogram, allocated on first record
+ * of the stripe, histograms are merged by GetSnapshot.
+ */
+class MetricHistogram {
+ public:
+  /**
+   * Create empty histogram.
+   * @param highest_trackable_value Max value tracked with full precision, see HdrHistogram.
+   */
+  explicit MetricHistogram(std::uint64_t highest_trackable_value);
+
+  ~MetricHistogram();
+
+  MetricHistogram& operator=(const MetricHistogram&) = delete;
+  MetricHistogram(const MetricHistogram&) = delete;
+
+  /**
+   * Record value.
+   * @param value Value to record.
+   */
+  void Record(std::uint64_t value) {
+    auto* histogram = stripes_[detail::GetMetricStripeIndex()].load(std::memory_order_acquire);
+    if (histogram == nullptr) {
+      histogram = &CreateStripe();
+    }
+    histogram->Record(value);
+  }
+
+  /**
+   * Merge values recorded by all threads.
+   * @param snapshot Histogram to add recorded values to, must have the same highest trackable value.
+   */
+  void GetSnapshot(HdrHistogram& snapshot) const;
+
+  /**
+   * Get max value tracked with full precision.
+   * @return Highest trackable value.
+   */
+  std::uint64_t GetHighestTrackableValue() const;
+
+ private:
+  HdrHistogram& CreateStripe();
+
+  const std::uint64_t highest_trackable_value_;
+
+  std::array<std::atomic<HdrHistogram*>, detail::kMetricStripeCount> stripes_;
+};
+
+/**
+ * Labels of the metric as name and value pairs.
+ */
+using MetricLabelsType = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Registry of named metrics. Metric is identified by name and labels: the first request creates it, the next ones
+ * return the same instance, so it can be shared by objects of the same kind. Metrics live as long as the registry,
+ * references should be kept by the callers instead of looking metrics up on hot paths. Values are read only when the
+ * registry is formatted.
+ */
+class MetricsRegistry {
+ public:
+  using GaugeCallbackType = std::function<std::int64_t()>;
+
+  MetricsRegistry();
+
+  ~MetricsRegistry();
+
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+  MetricsRegistry(const MetricsRegistry&) = delete;
+
+  /**
+   * Get or create counter.
+   * @param name Metric name, should end with _total.
+   * @param help Description of the metric, the first one given for the name is used.
+   * @param labels Labels of the metric.
+   * @return Counter which lives as long as the registry.
+   */
+  MetricCounter& GetCounter(const std::string& name, const std::string& help, const MetricLabelsType& labels = {});
+
+  /**
+   * Get or create gauge.
+   * @param name Metric name.
+   * @param help Description of the metric, the first one given for the name is used.
+   * @param labels Labels of the metric.
+   * @return Gauge which lives as long as the registry.
+   */
+  MetricGauge& GetGauge(const std::string& name, const std::string& help, const MetricLabelsType& labels = {});
+
+  /**
+   * Get or create histogram.
+   * @param name Metric name.
+   * @param help Description of the metric, the first one given for the name is used.
+   * @param highest_trackable_value Max value tracked with full precision, used when histogram is created.
+   * @param labels Labels of the metric.
+   * @return Histogram which lives as long as the registry.
+   */
+  MetricHistogram& GetHistogram(const std::string& name,
+                                const std::string& help,
+                                std::uint64_t highest_trackable_value,
+                                const MetricLabelsType& labels = {});
+
+  /**
+   * Set gauge whose value is computed when the registry is formatted, e.g. from other metrics. Replaces callback
+   * previously set for the same name and labels.
+   * @param name Metric name.
+   * @param help Description of the metric, the first one given for the name is used.
+   * @param callback Returns the value. Called under the lock of the registry, must not access the registry.
+   * @param labels Labels of the metric.
+   */
+  void SetGaugeCallback(const std::string& name,
+                        const std::string& help,
+                        GaugeCallbackType callback,
+                        const MetricLabelsType& labels = {});
+
+  /**
+   * Format all metrics in Prometheus text exposition format. Histograms are exposed as summaries with quantiles.
+   * @return Text with metrics sorted by name.
+   */
+  std::string FormatPrometheusText() const;
+
+ private:
+  enum class Type { Counter, Gauge, Histogram };
+
+  struct Series;
+
+  struct Family {
+    Type type;
+
+    std::string help;
+
+    // Keyed by formatted labels
+    std::map<std::string, std::unique_ptr<Series>> series;
+  };
+
+  Series& GetSeries(const std::string& name, const std::string& help, Type type, const MetricLabelsType& labels);
+
+  mutable std::mutex mutex_;
+
+  std::map<std::string, Family> families_;
+};
+
+/**
+ * Get registry which collects metrics of the library.
+ * @return Process wide registry.
+ */
+MetricsRegistry& GetMetricsRegistryInstance();
+
+}  // namespace util
+}  // namespace rms
@@ -0,0 +1,171 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <boost/align/aligned_alloc.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace rms {
+namespace util {
+
+template <typename Tag>
+class ShardedCounter;
+
+/**
+ * Shard of ShardedCounter owned by a single thread. Every field is on its own cache line, so neighbouring shards and
+ * increments \ decrements of the same shard never share one.
+ */
+class ShardedCounterSlot {
+  template <typename Tag>
+  friend class ShardedCounter;
+
+  static constexpr std::size_t kCacheLineSize = 64u;
+
+  // Written by the owner thread only
+  alignas(kCacheLineSize) std::atomic<std::int64_t> increments_{0};
+
+  // Written by any thread which decrements value counted on this slot
+  alignas(kCacheLineSize) std::atomic<std::int64_t> decrements_{0};
+
+  // Read only after registration
+  alignas(kCacheLineSize) ShardedCounterSlot* next_ = nullptr;
+};
+
+/**
+ * Counter of live objects split into per thread slots, so increments and decrements on different threads do not
+ * contend on a single cache line. Decrement must be applied to the slot returned by the matching Increment, which
+ * keeps it on the same thread unless the object migrates. Total value is aggregated lazily by GetCount.
+ * @tparam Tag Allows to create independent counters.
+ */
+template <typename Tag>
+class ShardedCounter {
+ public:
+  /**
+   * Increment slot of current thread.
+   * @return Slot to be passed to Decrement.
+   */
+  static ShardedCounterSlot& Increment();
+
+  /**
+   * Decrement slot. Can be called from any thread.
+   * @param slot Slot returned by Increment.
+   * @return True if no values counted on the slot are left, i.e. total count might have become 0.
+   */
+  static bool Decrement(ShardedCounterSlot& slot);
+
+  /**
+   * Aggregate slots of all threads. Never underestimates: result is not less than the count at some moment during
+   * the call. Therefore 0 means that the count has actually been 0.
+   * @return Count of incremented but not yet decremented values.
+   */
+  static std::int64_t GetCount();
+
+ private:
+  class Registry {
+   public:
+    ShardedCounterSlot* Acquire();
+
+    void Release(ShardedCounterSlot* slot);
+
+    ShardedCounterSlot* GetHead() const {
+      return head_.load(std::memory_order_acquire);
+    }
+
+   private:
+    std::mutex mutex_;
+
+    // Slots are never freed: values counted on them can be decremented after the owner thread exits
+    std::atomic<ShardedCounterSlot*> head_{nullptr};
+
+    std::vector<ShardedCounterSlot*> free_slots_;
+  };
+
+  class ThreadSlot {
+   public:
+    ~ThreadSlot() {
+      if (slot != nullptr) {
+        GetRegistry().Release(slot);
+      }
+    }
+
+    ShardedCounterSlot* slot = nullptr;
+  };
+
+  static Registry& GetRegistry() {
+    // Intentionally leaked: runners might be destroyed during static deinitialization
+    static auto* registry = new Registry();
+    return *registry;
+  }
+
+  static ShardedCounterSlot& GetThreadSlot() {
+    static thread_local ThreadSlot thread_slot;
+    if (thread_slot.slot == nullptr) {
+      thread_slot.slot = GetRegistry().Acquire();
+    }
+    return *thread_slot.slot;
+  }
+};
+
+template <typename Tag>
+ShardedCounterSlot* ShardedCounter<Tag>::Registry::Acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!free_slots_.empty()) {
+    auto* slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+  }
+  // Plain new does not guarantee alignment above alignof(std::max_align_t) before C++17
+  void* memory = boost::alignment::aligned_alloc(alignof(ShardedCounterSlot), sizeof(ShardedCounterSlot));
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  auto* slot = new (memory) ShardedCounterSlot();
+  slot->next_ = head_.load(std::memory_order_relaxed);
+  head_.store(slot, std::memory_order_release);
+  return slot;
+}
+
+template <typename Tag>
+void ShardedCounter<Tag>::Registry::Release(ShardedCounterSlot* slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_slots_.push_back(slot);
+}
+
+template <typename Tag>
+ShardedCounterSlot& ShardedCounter<Tag>::Increment() {
+  auto& slot = GetThreadSlot();
+  // Only the owner writes increments, no read-modify-write is needed
+  slot.increments_.store(slot.increments_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  return slot;
+}
+
+template <typename Tag>
+bool ShardedCounter<Tag>::Decrement(ShardedCounterSlot& slot) {
+  const auto decrements = slot.decrements_.fetch_add(1, std::memory_order_acq_rel) + 1;
+  return decrements >= slot.increments_.load(std::memory_order_acquire);
+}
+
+template <typename Tag>
+std::int64_t ShardedCounter<Tag>::GetCount() {
+  // Decrement of a value happens after its increment, so reading all decrements before all increments never misses
+  // increment of the value whose decrement has been counted
+  std::int64_t decrements = 0;
+  for (const auto* slot = GetRegistry().GetHead(); slot != nullptr; slot = slot->next_) {
+    decrements += slot->decrements_.load(std::memory_order_acquire);
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // Slots are prepended, so list is reloaded to include slots registered meanwhile
+  std::int64_t increments = 0;
+  for (const auto* slot = GetRegistry().GetHead(); slot != nullptr; slot = slot->next_) {
+    increments += slot->increments_.load(std::memory_order_acquire);
+  }
+  return increments - decrements;
+}
+
+}  // namespace util
+}  // namespace rms
@@ -0,0 +1,193 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <utility>
+
+namespace rms {
+namespace util {
+
+/**
+ * Container which assigns ids to its values. Insert, erase, lookup and size are O(1): free slots are chained into a
+ * list, id is built from the slot index and generation of the slot. Generation is incremented on every erase, so stale
+ * id of an erased value never refers to another value which reuses the slot. Slots are allocated on demand up to the
+ * capacity and never move, so growth doesn't copy stored values. Not thread safe.
+ * @tparam T Type of the value. Must be default constructible and movable.
+ */
+template <typename T>
+class SlotMap {
+ public:
+  /**
+   * Identifier of the value. Never 0: lower half holds 1-based slot index, upper half holds generation of the slot.
+   */
+  using IdType = std::uint64_t;
+
+  /**
+   * Create empty map.
+   * @param capacity Max count of values. Slots are not preallocated.
+   */
+  explicit SlotMap(std::size_t capacity) {
+    SetCapacity(capacity);
+  }
+
+  /**
+   * Store value in a free slot.
+   * @param value Value to store.
+   * @return Id of the value, none if capacity is reached.
+   */
+  boost::optional<IdType> Insert(T value) {
+    if (size_ >= capacity_) {
+      return boost::none;
+    }
+    std::uint32_t index = 0u;
+    if (free_head_ != kNoIndex) {
+      index = free_head_;
+      free_head_ = slots_[index].next_free;
+    } else {
+      index = static_cast<std::uint32_t>(slots_.size());
+      slots_.emplace_back();
+    }
+    auto& slot = slots_[index];
+    slot.value = std::move(value);
+    slot.is_occupied = true;
+    ++size_;
+    return MakeId(index, slot.generation);
+  }
+
+  /**
+   * Remove value and release its slot. Id of the value becomes invalid.
+   * @param id Id returned by Insert.
+   * @return Removed value, none if id is invalid.
+   */
+  boost::optional<T> Erase(IdType id) {
+    auto* slot = FindSlot(id);
+    if (slot == nullptr) {
+      return boost::none;
+    }
+    boost::optional<T> value{std::move(slot->value)};
+    slot->value = T();
+    slot->is_occupied = false;
+    ++slot->generation;
+    slot->next_free = free_head_;
+    free_head_ = GetIndex(id);
+    --size_;
+    return value;
+  }
+
+  /**
+   * Find value by id.
+   * @param id Id returned by Insert.
+   * @return Pointer to the value, nullptr if id is invalid. Valid until the value is erased.
+   */
+  T* Find(IdType id) {
+    auto* slot = FindSlot(id);
+    return slot != nullptr ? &slot->value : nullptr;
+  }
+
+  /**
+   * Find value by id.
+   * @param id Id returned by Insert.
+   * @return Pointer to the value, nullptr if id is invalid. Valid until the value is erased.
+   */
+  const T* Find(IdType id) const {
+    return const_cast<SlotMap*>(this)->Find(id);
+  }
+
+  /**
+   * Call function for all stored values. Walks all allocated slots.
+   * @param function Callable with signature void(IdType, T&).
+   */
+  template <typename Function>
+  void ForEach(Function&& function) {
+    for (std::size_t index = 0u; index < slots_.size(); ++index) {
+      auto& slot = slots_[index];
+      if (slot.is_occupied) {
+        function(MakeId(static_cast<std::uint32_t>(index), slot.generation), slot.value);
+      }
+    }
+  }
+
+  /**
+   * Get count of stored values.
+   * @return Count of values.
+   */
+  std::size_t GetSize() const {
+    return size_;
+  }
+
+  /**
+   * Get max count of values.
+   * @return Current capacity.
+   */
+  std::size_t GetCapacity() const {
+    return capacity_;
+  }
+
+  /**
+   * Change max count of values. Stored values are kept if there are more of them than the new capacity, Insert fails
+   * until enough of them are erased. Allocated slots are not released.
+   * @param capacity New max count of values.
+   */
+  void SetCapacity(std::size_t capacity) {
+    if (capacity > kMaxCapacity) {
+      capacity = kMaxCapacity;
+    }
+    capacity_ = capacity;
+  }
+
+ private:
+  static constexpr std::uint32_t kNoIndex = std::numeric_limits<std::uint32_t>::max();
+
+  // Index is stored 1-based, so the top index is reserved for kNoIndex
+  static constexpr std::size_t kMaxCapacity = kNoIndex - 1u;
+
+  static constexpr unsigned kIndexBits = 32u;
+
+  struct Slot {
+    T value{};
+
+    // Wraps around after 2^32 reuses of the slot
+    std::uint32_t generation = 0u;
+
+    bool is_occupied = false;
+
+    std::uint32_t next_free = kNoIndex;
+  };
+
+  static IdType MakeId(std::uint32_t index, std::uint32_t generation) {
+    return (static_cast<IdType>(generation) << kIndexBits) | (static_cast<IdType>(index) + 1u);
+  }
+
+  static std::uint32_t GetIndex(IdType id) {
+    // Wraps invalid id 0 to kNoIndex which is never allocated
+    return static_cast<std::uint32_t>(id) - 1u;
+  }
+
+  Slot* FindSlot(IdType id) {
+    const auto index = GetIndex(id);
+    if (index >= slots_.size()) {
+      return nullptr;
+    }
+    auto& slot = slots_[index];
+    if (!slot.is_occupied || slot.generation != static_cast<std::uint32_t>(id >> kIndexBits)) {
+      return nullptr;
+    }
+    return &slot;
+  }
+
+  std::size_t capacity_ = 0u;
+
+  std::deque<Slot> slots_;
+
+  std::uint32_t free_head_ = kNoIndex;
+
+  std::size_t size_ = 0u;
+};
+
+}  // namespace util
+}  // namespace rms
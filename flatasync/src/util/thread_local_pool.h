@@ -0,0 +1,134 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace rms {
+namespace util {
+
+/**
+ * Free list of memory blocks for objects of type T. Every thread has its own list, so no synchronization is required.
+ * Block released on another thread than allocated migrates to the list of the releasing thread. Designed to be used
+ * from class specific operator new\delete.
+ * @tparam T Type of the objects.
+ * @tparam MaxCachedCount Max count of free blocks kept by every thread. Extra blocks are returned to the heap.
+ */
+template <typename T, std::size_t MaxCachedCount = 1024u>
+class ThreadLocalPool {
+  static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported by ThreadLocalPool");
+
+ public:
+  /**
+   * Get memory block from the free list of current thread or from the heap if the list is empty.
+   * @return Memory block suitable to hold object of type T.
+   */
+  static void* Allocate();
+
+  /**
+   * Return memory block to the free list of current thread.
+   * @param ptr Memory block previously returned by Allocate(). Can be null.
+   */
+  static void Deallocate(void* ptr) noexcept;
+
+  /**
+   * Get count of free blocks kept by current thread.
+   * @return Count of free blocks.
+   */
+  static std::size_t GetCachedCount();
+
+  /**
+   * Return all free blocks of current thread to the heap.
+   */
+  static void ReleaseCached();
+
+ private:
+  union Node {
+    Node* next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  class FreeList {
+   public:
+    ~FreeList() {
+      Clear();
+    }
+
+    Node* Pop() {
+      Node* node = head_;
+      if (node != nullptr) {
+        head_ = node->next;
+        --count_;
+      }
+      return node;
+    }
+
+    bool Push(Node* node) {
+      if (count_ >= MaxCachedCount) {
+        return false;
+      }
+      node->next = head_;
+      head_ = node;
+      ++count_;
+      return true;
+    }
+
+    std::size_t GetCount() const {
+      return count_;
+    }
+
+    void Clear() {
+      while (head_ != nullptr) {
+        Node* node = head_;
+        head_ = node->next;
+        ::operator delete(node);
+      }
+      count_ = 0u;
+    }
+
+   private:
+    Node* head_ = nullptr;
+
+    std::size_t count_ = 0u;
+  };
+
+  static FreeList& GetFreeList() {
+    static thread_local FreeList free_list;
+    return free_list;
+  }
+};
+
+template <typename T, std::size_t MaxCachedCount>
+void* ThreadLocalPool<T, MaxCachedCount>::Allocate() {
+  Node* node = GetFreeList().Pop();
+  if (node == nullptr) {
+    node = static_cast<Node*>(::operator new(sizeof(Node)));
+  }
+  return node;
+}
+
+template <typename T, std::size_t MaxCachedCount>
+void ThreadLocalPool<T, MaxCachedCount>::Deallocate(void* ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto* node = static_cast<Node*>(ptr);
+  if (!GetFreeList().Push(node)) {
+    ::operator delete(node);
+  }
+}
+
+template <typename T, std::size_t MaxCachedCount>
+std::size_t ThreadLocalPool<T, MaxCachedCount>::GetCachedCount() {
+  return GetFreeList().GetCount();
+}
+
+template <typename T, std::size_t MaxCachedCount>
+void ThreadLocalPool<T, MaxCachedCount>::ReleaseCached() {
+  GetFreeList().Clear();
+}
+
+}  // namespace util
+}  // namespace rms
@@ -3,6 +3,7 @@
 #include "util/thread_util.h"
 #include <cassert>
 #include <chrono>
+#include <exception>
 #include <thread>
 
 namespace {
@@ -47,3 +48,21 @@ rms::core::IIoService& rms::util::ThreadUtil::GetCurrentThreadIoService() {
   assert(thrd_ptr_ioservice != nullptr);
   return *thrd_ptr_ioservice;
 }
+
+std::thread rms::util::ThreadUtil::CreateThreadImpl(std::function<void()> action, const char* name) {
+  LOG_AUTO_TRACE();
+  return std::thread([action = std::move(action), name] {
+    SetCurrentThreadName(name);
+    SetCurrentThreadNumber(++GetAtomicInstance<DefaultThreadCounterTag>());
+    const auto& id = GetCurrentThreadId();
+    (void)id;
+    LOG_TRACE("Created thread " << id);
+    LOG_AUTO_NDC(id);
+    try {
+      action();
+    } catch (std::exception& e) {
+      (void)e;
+      LOG_ERROR(id << ": Thread ended with error: " << e.what());
+    }
+  });
+}
@@ -3,9 +3,10 @@
 #pragma once
 
 #include <atomic>
-#include <exception>
+#include <functional>
 #include <string>
 #include <thread>
+#include <utility>
 #include "util/logger.h"
 #include "util/singleton.h"
 
@@ -84,6 +85,10 @@ class ThreadUtil {
    */
   template <typename Action>
   static std::thread CreateThread(Action action, const char* name);
+
+ private:
+  // Logs out of line, so the log level of the flatasync library applies regardless of the including target
+  static std::thread CreateThreadImpl(std::function<void()> action, const char* name);
 };
 
 /**
@@ -113,21 +118,7 @@ std::atomic<int>& GetAtomicInstance() {
 
 template <typename Action>
 std::thread ThreadUtil::CreateThread(Action action, const char* name) {
-  LOG_AUTO_TRACE();
-  return std::thread([action, name] {
-    SetCurrentThreadName(name);
-    SetCurrentThreadNumber(++GetAtomicInstance<DefaultThreadCounterTag>());
-    const auto& id = GetCurrentThreadId();
-    (void)id;
-    LOG_TRACE("Created thread " << id);
-    LOG_AUTO_NDC(id);
-    try {
-      action();
-    } catch (std::exception& e) {
-      (void)e;
-      LOG_ERROR(id << ": Thread ended with error: " << e.what());
-    }
-  });
+  return CreateThreadImpl(std::move(action), name);
 }
 
 }  // namespace util
@@ -0,0 +1,90 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/async_op_state.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using rms::core::AsyncOpState;
+using rms::core::AsyncOpStatus;
+
+TEST(TestAsyncOpState, StatusChangesOnce) {
+  AsyncOpState op_state;
+  ASSERT_EQ(AsyncOpStatus::Normal, op_state.GetStatus());
+  ASSERT_TRUE(op_state.Timedout());
+  ASSERT_FALSE(op_state.Cancel());
+  ASSERT_EQ(AsyncOpStatus::Timedout, op_state.GetStatus());
+  ASSERT_EQ(AsyncOpStatus::Timedout, op_state.Reset());
+  ASSERT_EQ(AsyncOpStatus::Normal, op_state.GetView().GetStatus());
+  ASSERT_TRUE(op_state.GetView().Cancel());
+  ASSERT_EQ(AsyncOpStatus::Cancelled, op_state.GetStatus());
+}
+
+TEST(TestAsyncOpState, ConcurrentTransitions) {
+  const int thread_count = 8;
+  for (int i = 0; i < 100; ++i) {
+    AsyncOpState op_state;
+    std::atomic<int> changed_count{0};
+    std::atomic<int> handler_count{0};
+    op_state.GetView().SetCancelHandler([&handler_count] { ++handler_count; });
+    std::vector<std::thread> threads;
+    for (int j = 0; j < thread_count; ++j) {
+      threads.emplace_back([&op_state, &changed_count, j] {
+        const bool is_changed = j % 2 == 0 ? op_state.Cancel() : op_state.Timedout();
+        if (is_changed) {
+          ++changed_count;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    ASSERT_EQ(1, changed_count);
+    ASSERT_EQ(1, handler_count);
+  }
+}
+
+TEST(TestAsyncOpState, CancelHandler) {
+  AsyncOpState op_state;
+  const auto view = op_state.GetView();
+  int handler_count = 0;
+
+  view.SetCancelHandler([&handler_count] { ++handler_count; });
+  view.ResetCancelHandler();
+  ASSERT_TRUE(op_state.Cancel());
+  ASSERT_EQ(0, handler_count);
+
+  // Already cancelled: handler is invoked immediately
+  view.SetCancelHandler([&handler_count] { ++handler_count; });
+  ASSERT_EQ(1, handler_count);
+  view.ResetCancelHandler();
+
+  op_state.Reset();
+  view.SetCancelHandler([&handler_count] { ++handler_count; });
+  ASSERT_EQ(1, handler_count);
+  ASSERT_TRUE(op_state.Timedout());
+  ASSERT_EQ(2, handler_count);
+  view.ResetCancelHandler();
+}
+
+TEST(TestAsyncOpState, InvokeCancelHandler) {
+  AsyncOpState op_state;
+  const auto view = op_state.GetView();
+  int handler_count = 0;
+
+  // Normal status: nothing to abort
+  view.SetCancelHandler([&handler_count] { ++handler_count; });
+  ASSERT_FALSE(view.InvokeCancelHandler());
+  ASSERT_EQ(0, handler_count);
+
+  ASSERT_TRUE(op_state.Cancel());
+  ASSERT_EQ(1, handler_count);
+  ASSERT_TRUE(view.InvokeCancelHandler());
+  ASSERT_EQ(2, handler_count);
+
+  // Removed by the owner: never invoked again
+  view.ResetCancelHandler();
+  ASSERT_FALSE(view.InvokeCancelHandler());
+  ASSERT_EQ(2, handler_count);
+}
@@ -0,0 +1,147 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/async_runner.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/thread_pool.h"
+#include "util/logger.h"
+
+using rms::core::AsyncOpState;
+using rms::core::AsyncOpStatus;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+
+namespace {
+
+std::atomic<bool> is_counting_allocations{false};
+
+std::atomic<std::size_t> allocation_count{0u};
+
+void* CountingAllocate(std::size_t size) {
+  if (is_counting_allocations.load(std::memory_order_relaxed)) {
+    allocation_count.fetch_add(1u, std::memory_order_relaxed);
+  }
+  void* ptr = std::malloc(size == 0u ? 1u : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+/**
+ * Switches logging off within its scope, since formatting of log lines allocates.
+ */
+class LoggingOffGuard {
+ public:
+  LoggingOffGuard() {
+#if !defined(DISABLE_LOGGER)
+    log_level_ = log4cplus::Logger::getRoot().getLogLevel();
+    log4cplus::Logger::getRoot().setLogLevel(log4cplus::OFF_LOG_LEVEL);
+#endif
+  }
+
+  ~LoggingOffGuard() {
+#if !defined(DISABLE_LOGGER)
+    log4cplus::Logger::getRoot().setLogLevel(log_level_);
+#endif
+  }
+
+ private:
+#if !defined(DISABLE_LOGGER)
+  log4cplus::LogLevel log_level_;
+#endif
+};
+
+/**
+ * Runs chain of async tasks: every task starts the next one, so only one task is alive at a time. Counts global heap
+ * allocations made by any thread from the start of the first task till the end of the last one.
+ * @param length Count of tasks in the chain.
+ * @return Count of allocations.
+ */
+std::size_t RunAsyncChain(int length) {
+  std::atomic<int> remaining{length};
+  std::function<void()> step;
+  step = [&] {
+    if (remaining.load() == length) {
+      allocation_count.store(0u);
+      is_counting_allocations.store(true);
+    }
+    if (--remaining > 0) {
+      RunAsync([&step] { step(); });
+    } else {
+      is_counting_allocations.store(false);
+    }
+  };
+  RunAsync([&step] { step(); });
+  WaitAll();
+  return allocation_count.load();
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  return CountingAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return CountingAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+class TestAsyncRunnerAllocation : public ::testing::TestWithParam<ThreadPool::Mode> {};
+
+TEST_P(TestAsyncRunnerAllocation, SteadyStateRunAsyncDoesNotAllocate) {
+  ThreadPool thread_pool_main{1u, "main", GetParam()};
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool_main);
+
+  const int chain_length = 1000;
+  LoggingOffGuard logging_off_guard;
+  // Warm up per thread pools: runners, op states, coroutine stacks, io service handlers
+  RunAsyncChain(chain_length);
+  ASSERT_EQ(0u, RunAsyncChain(chain_length));
+  GetDefaultSchedulerAccessorInstance().Detach();
+}
+
+INSTANTIATE_TEST_CASE_P(AllModes, TestAsyncRunnerAllocation,
+                        ::testing::Values(ThreadPool::Mode::Shared, ThreadPool::Mode::WorkStealing,
+                                          ThreadPool::Mode::Sharded));
+
+TEST(TestAsyncRunner, OpStateOutlivesRunner) {
+  ThreadPool thread_pool_main{1u, "main"};
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool_main);
+
+  AsyncOpState op_state = RunAsync([] {});
+  WaitAll();
+  ASSERT_EQ(AsyncOpStatus::Normal, op_state.GetStatus());
+  ASSERT_TRUE(op_state.Cancel());
+  ASSERT_EQ(AsyncOpStatus::Cancelled, op_state.GetStatus());
+
+  AsyncOpState copy = op_state;
+  ASSERT_EQ(AsyncOpStatus::Cancelled, copy.GetStatus());
+  ASSERT_EQ(AsyncOpStatus::Cancelled, copy.Reset());
+  ASSERT_EQ(AsyncOpStatus::Normal, op_state.GetStatus());
+
+  GetDefaultSchedulerAccessorInstance().Detach();
+}
@@ -5,10 +5,12 @@
 #include "core/default_scheduler_accessor.h"
 #include "core/sequential_scheduler.h"
 #include "core/thread_pool.h"
+#include "core/timer_wheel.h"
 #include "util/logger.h"
 #include "util/thread_util.h"
 
 #include <boost/thread/barrier.hpp>
+#include <chrono>
 #include <exception>
 #include <stdexcept>
 #include "core/iioservice.h"
@@ -16,12 +18,14 @@
 using rms::core::AsyncOpStatus;
 using rms::core::GetDefaultSchedulerAccessorInstance;
 using rms::core::GetTimeoutServiceAccessorInstance;
+using rms::core::GetTimerWheelAccessorInstance;
 using rms::core::HandleEvents;
 using rms::core::RunAsync;
 using rms::core::RunAsyncTimes;
 using rms::core::SequentialScheduler;
 using rms::core::ThreadPool;
 using rms::core::Timeout;
+using rms::core::TimerWheel;
 using rms::core::WaitAll;
 using rms::util::SleepFor;
 using rms::util::ThreadUtil;
@@ -48,6 +52,20 @@ TEST(TestAsync, RunAsyncOnce) {
   ASSERT_EQ(1, counter);
 }
 
+TEST(TestAsync, WaitAllWithTimeout) {
+  ThreadPool thread_pool_main{1u, "main"};
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool_main);
+
+  boost::barrier barrier{2};
+  ASSERT_TRUE(WaitAll(std::chrono::milliseconds(0)));
+
+  RunAsync([&]() { barrier.wait(); });
+  ASSERT_FALSE(WaitAll(std::chrono::milliseconds(10)));
+  barrier.wait();
+
+  ASSERT_TRUE(WaitAll(std::chrono::milliseconds(5000)));
+}
+
 TEST(TestAsync, RunAsyncNTimes) {
   ThreadPool thread_pool_main{1u, "main"};
   GetDefaultSchedulerAccessorInstance().Attach(thread_pool_main);
@@ -491,3 +509,35 @@ TEST(TestAsync, RunAsyncTimeoutThrowBeforeHandling) {
   ASSERT_EQ(AsyncOpStatus::Timedout, timedout_state.GetStatus());
   ASSERT_EQ(4, counter);
 }
+
+TEST(TestAsync, RunAsyncTimeoutWithTimerWheel) {
+  ThreadPool thread_pool_main{3u, "main"};
+  TimerWheel timer_wheel{std::chrono::milliseconds(5)};
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool_main);
+  GetTimerWheelAccessorInstance().Attach(timer_wheel);
+
+  std::atomic<int> counter{0};
+
+  const auto normal_state = RunAsync([&]() {
+    Timeout timeout(100);
+    ++counter;
+    SleepFor(20);
+    HandleEvents();
+    ++counter;
+  });
+
+  const auto timedout_state = RunAsync([&]() {
+    Timeout timeout(20);
+    ++counter;
+    SleepFor(100);
+    HandleEvents();  // This line should catch timeout and break execution
+    ++counter;       // this inc should not happen
+  });
+
+  WaitAll();
+  GetTimerWheelAccessorInstance().Detach();
+  ASSERT_EQ(AsyncOpStatus::Normal, normal_state.GetStatus());
+  ASSERT_EQ(AsyncOpStatus::Timedout, timedout_state.GetStatus());
+  ASSERT_EQ(3, counter);
+  ASSERT_EQ(0u, timer_wheel.GetArmedCount());
+}
@@ -0,0 +1,110 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/coro_stack_pool.h"
+#include <gtest/gtest.h>
+#include <boost/context/stack_traits.hpp>
+#include <memory>
+#include <vector>
+#include "core/async.h"
+#include "core/coro_helper.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/thread_pool.h"
+
+using rms::core::CoroHelper;
+using rms::core::CoroStackPool;
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+using rms::core::Yield;
+
+namespace {
+
+class TestCoroStackPool : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    CoroStackPool::ReleaseCachedStacks();
+    CoroStackPool::ResetStatistics();
+  }
+
+  void TearDown() override {
+    CoroStackPool::SetStackSize(boost::context::stack_traits::default_size());
+    CoroStackPool::SetMaxCachedStacks(64u);
+    CoroStackPool::ReleaseCachedStacks();
+  }
+};
+
+}  // namespace
+
+TEST_F(TestCoroStackPool, FinishedCoroReturnsStackToCache) {
+  {
+    CoroHelper coro_helper{[] {}};
+  }
+  ASSERT_EQ(1u, CoroStackPool::GetCachedStacksCount());
+
+  for (int i = 0; i < 10; ++i) {
+    CoroHelper coro_helper{[] { Yield(); }};
+    ASSERT_EQ(0u, CoroStackPool::GetCachedStacksCount());
+  }
+  ASSERT_EQ(1u, CoroStackPool::GetCachedStacksCount());
+
+  const auto statistics = CoroStackPool::GetStatistics();
+  ASSERT_EQ(1u, statistics.misses);
+  ASSERT_EQ(10u, statistics.hits);
+}
+
+TEST_F(TestCoroStackPool, RestartReusesStack) {
+  int value = 0;
+  CoroHelper coro_helper;
+  for (int i = 0; i < 5; ++i) {
+    coro_helper.Start([&value] { ++value; });
+  }
+  ASSERT_EQ(5, value);
+  ASSERT_EQ(1u, CoroStackPool::GetStatistics().misses);
+  ASSERT_EQ(4u, CoroStackPool::GetStatistics().hits);
+}
+
+TEST_F(TestCoroStackPool, CacheIsCapped) {
+  CoroStackPool::SetMaxCachedStacks(2u);
+  {
+    std::vector<std::unique_ptr<CoroHelper>> coros;
+    for (int i = 0; i < 4; ++i) {
+      coros.emplace_back(std::make_unique<CoroHelper>([] { Yield(); }));
+    }
+  }
+  ASSERT_EQ(2u, CoroStackPool::GetCachedStacksCount());
+  ASSERT_EQ(4u, CoroStackPool::GetStatistics().misses);
+}
+
+TEST_F(TestCoroStackPool, CachedStacksOfOldSizeAreNotReused) {
+  {
+    CoroHelper coro_helper{[] {}};
+  }
+  ASSERT_EQ(1u, CoroStackPool::GetCachedStacksCount());
+
+  CoroStackPool::SetStackSize(2u * boost::context::stack_traits::default_size());
+  ASSERT_EQ(2u * boost::context::stack_traits::default_size(), CoroStackPool::GetStackSize());
+  {
+    CoroHelper coro_helper{[] { Yield(); }};
+    ASSERT_EQ(0u, CoroStackPool::GetCachedStacksCount());
+  }
+  ASSERT_EQ(1u, CoroStackPool::GetCachedStacksCount());
+  ASSERT_EQ(2u, CoroStackPool::GetStatistics().misses);
+  ASSERT_EQ(0u, CoroStackPool::GetStatistics().hits);
+}
+
+TEST_F(TestCoroStackPool, SteadyStateRunAsyncDoesNotAllocate) {
+  ThreadPool thread_pool_main{1u, "main"};
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool_main);
+
+  const int count = 100;
+  for (int i = 0; i < count; ++i) {
+    RunAsync([] {});
+    WaitAll();
+  }
+  const auto statistics = CoroStackPool::GetStatistics();
+  ASSERT_EQ(static_cast<std::uint64_t>(count), statistics.hits + statistics.misses);
+  ASSERT_EQ(1u, statistics.misses);
+
+  GetDefaultSchedulerAccessorInstance().Detach();
+}
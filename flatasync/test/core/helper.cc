@@ -13,13 +13,13 @@ using rms::core::ThreadPool;
 using rms::net::GetNetworkSchedulerAccessorInstance;
 using rms::net::GetNetworkServiceAccessorInstance;
 
-rms::core::SchedulersInitiator::SchedulersInitiator() {
+rms::core::SchedulersInitiator::SchedulersInitiator(ThreadPool::Mode mode) {
   const auto hardware_threads_count = std::thread::hardware_concurrency();
   const int thread_pool_size = hardware_threads_count * 2;
 
-  thread_pool_net_ = std::make_unique<ThreadPool>(thread_pool_size, "net");
+  thread_pool_net_ = std::make_unique<ThreadPool>(thread_pool_size, "net", mode);
 
-  thread_pool_main_ = std::make_unique<ThreadPool>(thread_pool_size, "main");
+  thread_pool_main_ = std::make_unique<ThreadPool>(thread_pool_size, "main", mode);
 
   GetDefaultIoServiceAccessorInstance().Attach(*thread_pool_main_);
   GetDefaultSchedulerAccessorInstance().Attach(*thread_pool_main_);
@@ -3,15 +3,14 @@
 #pragma once
 
 #include <memory>
+#include "core/thread_pool.h"
 
 namespace rms {
 namespace core {
 
-class ThreadPool;
-
 class SchedulersInitiator {
  public:
-  SchedulersInitiator();
+  explicit SchedulersInitiator(ThreadPool::Mode mode = ThreadPool::Mode::Shared);
 
   ~SchedulersInitiator();
 
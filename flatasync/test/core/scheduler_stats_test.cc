@@ -0,0 +1,109 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/scheduler_stats.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "core/sequential_scheduler.h"
+#include "core/thread_pool.h"
+#include "util/metrics.h"
+#include "util/scope_guard.h"
+
+using rms::core::SchedulerStats;
+using rms::core::SequentialScheduler;
+using rms::core::ThreadPool;
+using rms::util::GetMetricsRegistryInstance;
+using rms::util::HdrHistogram;
+using rms::util::MakeScopeGuard;
+
+namespace {
+
+const std::uint64_t kHighestTimeNs = 60ull * 1000u * 1000u * 1000u;
+
+std::uint64_t GetTaskCount(const char* histogram_name, const char* scheduler_name) {
+  HdrHistogram snapshot{kHighestTimeNs};
+  GetMetricsRegistryInstance()
+      .GetHistogram(histogram_name, "", kHighestTimeNs, {{"scheduler", scheduler_name}})
+      .GetSnapshot(snapshot);
+  return snapshot.GetCount();
+}
+
+std::uint64_t GetBusyTime(const char* pool_name, std::size_t thread_count) {
+  std::uint64_t busy_time = 0u;
+  for (std::size_t i = 0u; i < thread_count; ++i) {
+    busy_time += GetMetricsRegistryInstance()
+                     .GetCounter("flatasync_thread_pool_worker_busy_nanoseconds_total",
+                                 "",
+                                 {{"pool", pool_name}, {"worker", std::to_string(i)}})
+                     .GetValue();
+  }
+  return busy_time;
+}
+
+// Run tasks from outside and from inside the pool, half of them through sequential scheduler
+void RunTasks(ThreadPool& thread_pool, SequentialScheduler& sequential_scheduler, int count) {
+  std::atomic<int> counter{0};
+  std::mutex mutex;
+  std::condition_variable waiter;
+  auto task = [&] {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    if (++counter == 3 * count) {
+      std::lock_guard<std::mutex> lock(mutex);
+      waiter.notify_one();
+    }
+  };
+  for (int i = 0; i < count; ++i) {
+    thread_pool.Schedule([&thread_pool, task] {
+      task();
+      thread_pool.Schedule(task);
+    });
+    sequential_scheduler.Schedule(task);
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  waiter.wait(lock, [&] { return counter == 3 * count; });
+}
+
+}  // namespace
+
+TEST(TestSchedulerStats, RecordsEnabledSchedulers) {
+  const std::size_t thread_count = 2u;
+  const int count = 20;
+  for (const auto mode : {ThreadPool::Mode::Shared, ThreadPool::Mode::WorkStealing, ThreadPool::Mode::Sharded}) {
+    const auto pool_count = GetTaskCount("flatasync_scheduler_queue_wait_nanoseconds", "stats_pool");
+    const auto sequential_count = GetTaskCount("flatasync_scheduler_run_time_nanoseconds", "stats_sequential");
+    const auto busy_time = GetBusyTime("stats_pool", thread_count);
+    {
+      SchedulerStats::SetIsEnabled(true);
+      auto guard = MakeScopeGuard([] { SchedulerStats::SetIsEnabled(false); });
+      ThreadPool thread_pool{thread_count, "stats_pool", mode};
+      SequentialScheduler sequential_scheduler{thread_pool, "stats_sequential"};
+      RunTasks(thread_pool, sequential_scheduler, count);
+      // Stats of the last tasks are recorded after they have notified, joining threads waits for them
+    }
+
+    ASSERT_EQ(pool_count + 2u * count, GetTaskCount("flatasync_scheduler_queue_wait_nanoseconds", "stats_pool"));
+    ASSERT_EQ(pool_count + 2u * count, GetTaskCount("flatasync_scheduler_run_time_nanoseconds", "stats_pool"));
+    ASSERT_EQ(sequential_count + count,
+              GetTaskCount("flatasync_scheduler_run_time_nanoseconds", "stats_sequential"));
+    // Each task sleeps for 100us
+    ASSERT_LE(busy_time + 3u * count * 100u * 1000u, GetBusyTime("stats_pool", thread_count));
+  }
+}
+
+TEST(TestSchedulerStats, DisabledByDefault) {
+  ASSERT_FALSE(SchedulerStats::GetIsEnabled());
+  {
+    ThreadPool thread_pool{2u, "stats_disabled_pool"};
+    SequentialScheduler sequential_scheduler{thread_pool, "stats_disabled_sequential"};
+    RunTasks(thread_pool, sequential_scheduler, 10);
+  }
+
+  ASSERT_EQ(0u, GetTaskCount("flatasync_scheduler_queue_wait_nanoseconds", "stats_disabled_pool"));
+  ASSERT_EQ(0u, GetTaskCount("flatasync_scheduler_run_time_nanoseconds", "stats_disabled_sequential"));
+  ASSERT_EQ(0u, GetBusyTime("stats_disabled_pool", 2u));
+}
@@ -0,0 +1,217 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include "core/async.h"
+#include "core/default_scheduler_accessor.h"
+#include "core/sequential_scheduler.h"
+#include "util/thread_util.h"
+
+using rms::core::GetDefaultSchedulerAccessorInstance;
+using rms::core::RunAsync;
+using rms::core::SequentialScheduler;
+using rms::core::ThreadPool;
+using rms::core::WaitAll;
+using rms::util::ThreadUtil;
+
+namespace {
+
+class TestThreadPool : public ::testing::TestWithParam<ThreadPool::Mode> {};
+
+// Modes which allow any thread of the pool to pick up scheduled task
+class TestThreadPoolBalancing : public ::testing::TestWithParam<ThreadPool::Mode> {};
+
+void WaitFor(std::mutex& mutex, std::condition_variable& waiter, const std::function<bool()>& predicate) {
+  std::unique_lock<std::mutex> lock(mutex);
+  waiter.wait(lock, predicate);
+}
+
+}  // namespace
+
+TEST_P(TestThreadPool, ScheduleFromOutside) {
+  ThreadPool thread_pool{4u, "main", GetParam()};
+  ASSERT_EQ(GetParam(), thread_pool.GetMode());
+  const int count = 1000;
+  std::atomic<int> counter{0};
+  std::mutex mutex;
+  std::condition_variable waiter;
+
+  for (int i = 0; i < count; ++i) {
+    thread_pool.Schedule([&] {
+      ASSERT_EQ(std::string("main"), ThreadUtil::GetCurrentThreadName());
+      if (++counter == count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiter.notify_one();
+      }
+    });
+  }
+  WaitFor(mutex, waiter, [&] { return counter == count; });
+  ASSERT_EQ(count, counter);
+}
+
+TEST_P(TestThreadPoolBalancing, ScheduleFromInsideIsSpreadAcrossThreads) {
+  const std::size_t thread_count = 4u;
+  ThreadPool thread_pool{thread_count, "main", GetParam()};
+  const int count = 64;
+  std::atomic<int> counter{0};
+  std::mutex mutex;
+  std::condition_variable waiter;
+  std::set<int> thread_numbers;
+
+  thread_pool.Schedule([&] {
+    for (int i = 0; i < count; ++i) {
+      thread_pool.Schedule([&] {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          thread_numbers.insert(ThreadUtil::GetCurrentThreadNumber());
+        }
+        // Keep thread busy so other threads have to pick up the rest of tasks
+        rms::util::SleepFor(2);
+        if (++counter == count) {
+          std::lock_guard<std::mutex> lock(mutex);
+          waiter.notify_one();
+        }
+      });
+    }
+  });
+  WaitFor(mutex, waiter, [&] { return counter == count; });
+  ASSERT_EQ(count, counter);
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_LT(1u, thread_numbers.size());
+}
+
+TEST_P(TestThreadPoolBalancing, BlockedTaskDoesNotHoldScheduledTask) {
+  ThreadPool thread_pool{2u, "main", GetParam()};
+  std::atomic_bool is_done{false};
+  std::mutex mutex;
+  std::condition_variable waiter;
+
+  thread_pool.Schedule([&] {
+    std::atomic_bool is_child_done{false};
+    thread_pool.Schedule([&] { is_child_done = true; });
+    // Child is scheduled to the local queue of this thread, it must be picked up by another one
+    while (!is_child_done) {
+      std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    is_done = true;
+    waiter.notify_one();
+  });
+  WaitFor(mutex, waiter, [&] { return is_done.load(); });
+  ASSERT_TRUE(is_done);
+}
+
+TEST_P(TestThreadPool, RunAsyncAndSwitch) {
+  ThreadPool thread_pool_main{2u, "main", GetParam()};
+  ThreadPool thread_pool_net{2u, "net", GetParam()};
+  GetDefaultSchedulerAccessorInstance().Attach(thread_pool_main);
+
+  std::atomic<int> counter{0};
+  for (int i = 0; i < 100; ++i) {
+    RunAsync([&] {
+      ASSERT_EQ(std::string("main"), ThreadUtil::GetCurrentThreadName());
+      SwitchTo(thread_pool_net);
+      ASSERT_EQ(std::string("net"), ThreadUtil::GetCurrentThreadName());
+      SwitchTo(thread_pool_main);
+      ASSERT_EQ(std::string("main"), ThreadUtil::GetCurrentThreadName());
+      ++counter;
+    });
+  }
+  WaitAll();
+  ASSERT_EQ(100, counter);
+}
+
+TEST_P(TestThreadPool, WaitForAllWork) {
+  const std::size_t thread_count = 2u;
+  ThreadPool thread_pool{thread_count, "main", GetParam()};
+  // Sequential schedulers are bound to different shards in Sharded mode
+  SequentialScheduler sequential_scheduler_first{thread_pool, "first"};
+  SequentialScheduler sequential_scheduler_second{thread_pool, "second"};
+  const int count = 5;
+  std::atomic<int> counter{0};
+
+  for (int i = 0; i < 3; ++i) {
+    // Work hops between the schedulers, so a thread which has run out of work gets it again from the busy one
+    std::function<void(int)> hop = [&](int hop_count) {
+      rms::util::SleepFor(5);
+      if (hop_count == count) {
+        ++counter;
+        return;
+      }
+      auto& destination = (hop_count % 2 == 0) ? sequential_scheduler_second : sequential_scheduler_first;
+      destination.Schedule([&hop, hop_count] { hop(hop_count + 1); });
+    };
+    thread_pool.Schedule([&] {
+      // Children are scheduled locally in WorkStealing and Sharded modes
+      thread_pool.Schedule([&] { sequential_scheduler_first.Schedule([&] { hop(1); }); });
+    });
+    thread_pool.Wait();
+    ASSERT_EQ(i + 1, counter);
+  }
+}
+
+TEST(TestThreadPoolSharded, ScheduleFromInsideStaysOnShard) {
+  ThreadPool thread_pool{4u, "main", ThreadPool::Mode::Sharded};
+  const int count = 64;
+  std::atomic<int> counter{0};
+  std::atomic<int> foreign_count{0};
+  std::mutex mutex;
+  std::condition_variable waiter;
+
+  thread_pool.Schedule([&] {
+    const auto thread_number = ThreadUtil::GetCurrentThreadNumber();
+    for (int i = 0; i < count; ++i) {
+      thread_pool.Schedule([&, thread_number] {
+        if (thread_number != ThreadUtil::GetCurrentThreadNumber()) {
+          ++foreign_count;
+        }
+        if (++counter == count) {
+          std::lock_guard<std::mutex> lock(mutex);
+          waiter.notify_one();
+        }
+      });
+    }
+  });
+  WaitFor(mutex, waiter, [&] { return counter == count; });
+  ASSERT_EQ(0, foreign_count);
+}
+
+TEST(TestThreadPoolSharded, ScheduleFromOutsideIsSpreadAcrossShards) {
+  const std::size_t thread_count = 4u;
+  ThreadPool thread_pool{thread_count, "main", ThreadPool::Mode::Sharded};
+  const int count = 64;
+  std::atomic<int> counter{0};
+  std::mutex mutex;
+  std::condition_variable waiter;
+  std::set<int> thread_numbers;
+
+  for (int i = 0; i < count; ++i) {
+    thread_pool.Schedule([&] {
+      std::lock_guard<std::mutex> lock(mutex);
+      thread_numbers.insert(ThreadUtil::GetCurrentThreadNumber());
+      if (++counter == count) {
+        waiter.notify_one();
+      }
+    });
+  }
+  WaitFor(mutex, waiter, [&] { return counter == count; });
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(thread_count, thread_numbers.size());
+}
+
+INSTANTIATE_TEST_CASE_P(Modes,
+                        TestThreadPool,
+                        ::testing::Values(ThreadPool::Mode::Shared,
+                                          ThreadPool::Mode::WorkStealing,
+                                          ThreadPool::Mode::Sharded));
+
+INSTANTIATE_TEST_CASE_P(Modes,
+                        TestThreadPoolBalancing,
+                        ::testing::Values(ThreadPool::Mode::Shared, ThreadPool::Mode::WorkStealing));
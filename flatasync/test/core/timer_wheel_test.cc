@@ -0,0 +1,107 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/timer_wheel.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "core/async_op_state.h"
+
+using rms::core::AsyncOpState;
+using rms::core::AsyncOpStatus;
+using rms::core::TimerWheel;
+
+namespace {
+
+using ClockType = std::chrono::steady_clock;
+
+/**
+ * Wait until operation is timed out.
+ * @param op_state State of the operation.
+ * @param max_wait Max time to wait.
+ * @return Time spent waiting.
+ */
+std::chrono::milliseconds WaitTimedout(AsyncOpState& op_state, std::chrono::milliseconds max_wait) {
+  const auto start = ClockType::now();
+  while (op_state.GetStatus() != AsyncOpStatus::Timedout && ClockType::now() - start < max_wait) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(ClockType::now() - start);
+}
+
+}  // namespace
+
+TEST(TestTimerWheel, ArmExpires) {
+  TimerWheel timer_wheel{std::chrono::milliseconds(5), 16u};
+  AsyncOpState op_state;
+  TimerWheel::Entry entry;
+  timer_wheel.Arm(entry, std::chrono::milliseconds(30), op_state);
+  ASSERT_EQ(1u, timer_wheel.GetArmedCount());
+
+  const auto waited = WaitTimedout(op_state, std::chrono::milliseconds(5000));
+  ASSERT_EQ(AsyncOpStatus::Timedout, op_state.GetStatus());
+  ASSERT_GE(waited.count(), 25);
+  ASSERT_EQ(0u, timer_wheel.GetArmedCount());
+  ASSERT_FALSE(timer_wheel.Cancel(entry));
+}
+
+TEST(TestTimerWheel, CancelPreventsExpiration) {
+  TimerWheel timer_wheel{std::chrono::milliseconds(5), 16u};
+  AsyncOpState op_state;
+  TimerWheel::Entry entry;
+  timer_wheel.Arm(entry, std::chrono::milliseconds(20), op_state);
+  ASSERT_TRUE(timer_wheel.Cancel(entry));
+  ASSERT_FALSE(timer_wheel.Cancel(entry));
+  ASSERT_EQ(0u, timer_wheel.GetArmedCount());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_EQ(AsyncOpStatus::Normal, op_state.GetStatus());
+}
+
+TEST(TestTimerWheel, TimeoutLongerThanRevolution) {
+  // Revolution is 4 * 5ms, timer stays in the slot for several revolutions
+  TimerWheel timer_wheel{std::chrono::milliseconds(5), 4u};
+  AsyncOpState short_state;
+  AsyncOpState long_state;
+  TimerWheel::Entry short_entry;
+  TimerWheel::Entry long_entry;
+  timer_wheel.Arm(short_entry, std::chrono::milliseconds(20), short_state);
+  timer_wheel.Arm(long_entry, std::chrono::milliseconds(100), long_state);
+
+  WaitTimedout(short_state, std::chrono::milliseconds(5000));
+  ASSERT_EQ(AsyncOpStatus::Timedout, short_state.GetStatus());
+  ASSERT_EQ(AsyncOpStatus::Normal, long_state.GetStatus());
+
+  WaitTimedout(long_state, std::chrono::milliseconds(5000));
+  ASSERT_EQ(AsyncOpStatus::Timedout, long_state.GetStatus());
+}
+
+TEST(TestTimerWheel, ArmWhileWheelLags) {
+  TimerWheel timer_wheel{std::chrono::milliseconds(5), 16u};
+  std::atomic_bool is_stalled{false};
+  std::atomic_bool is_armed{false};
+  // Cancel handler runs on the wheel thread, it holds the wheel until the next timer is armed
+  AsyncOpState stall_state;
+  stall_state.GetView().SetCancelHandler([&] {
+    is_stalled = true;
+    while (!is_armed) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  TimerWheel::Entry stall_entry;
+  timer_wheel.Arm(stall_entry, std::chrono::milliseconds(5), stall_state);
+  while (!is_stalled) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  AsyncOpState op_state;
+  TimerWheel::Entry entry;
+  timer_wheel.Arm(entry, std::chrono::milliseconds(30), op_state);
+  is_armed = true;
+
+  const auto waited = WaitTimedout(op_state, std::chrono::milliseconds(5000));
+  ASSERT_EQ(AsyncOpStatus::Timedout, op_state.GetStatus());
+  ASSERT_GE(waited.count(), 25);
+  stall_state.GetView().ResetCancelHandler();
+}
@@ -0,0 +1,97 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "core/work_stealing_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using rms::core::WorkStealingQueue;
+
+TEST(TestWorkStealingQueue, OwnerPopsInLifoOrder) {
+  WorkStealingQueue<int> queue;
+  ASSERT_TRUE(queue.IsEmpty());
+  queue.Push(1);
+  queue.Push(2);
+  queue.Push(3);
+  ASSERT_FALSE(queue.IsEmpty());
+
+  int item = 0;
+  ASSERT_TRUE(queue.Pop(item));
+  ASSERT_EQ(3, item);
+  ASSERT_TRUE(queue.Pop(item));
+  ASSERT_EQ(2, item);
+  ASSERT_TRUE(queue.Pop(item));
+  ASSERT_EQ(1, item);
+  ASSERT_FALSE(queue.Pop(item));
+  ASSERT_TRUE(queue.IsEmpty());
+}
+
+TEST(TestWorkStealingQueue, ThiefStealsInFifoOrder) {
+  WorkStealingQueue<int> queue;
+  queue.Push(1);
+  queue.Push(2);
+
+  int item = 0;
+  ASSERT_TRUE(queue.Steal(item));
+  ASSERT_EQ(1, item);
+  ASSERT_TRUE(queue.Pop(item));
+  ASSERT_EQ(2, item);
+  ASSERT_FALSE(queue.Steal(item));
+}
+
+TEST(TestWorkStealingQueue, GrowsWhenFull) {
+  WorkStealingQueue<int> queue{2u};
+  const int count = 100;
+  for (int i = 0; i < count; ++i) {
+    queue.Push(i);
+  }
+  int item = 0;
+  for (int i = 0; i < count; ++i) {
+    ASSERT_TRUE(queue.Steal(item));
+    ASSERT_EQ(i, item);
+  }
+  ASSERT_TRUE(queue.IsEmpty());
+}
+
+TEST(TestWorkStealingQueue, ConcurrentStealTakesEachItemOnce) {
+  WorkStealingQueue<int> queue{4u};
+  const int count = 100000;
+  const int thief_count = 3;
+  std::atomic<long long> sum{0};
+  std::atomic<int> taken{0};
+  std::atomic_bool done{false};
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < thief_count; ++i) {
+    thieves.emplace_back([&] {
+      int item = 0;
+      while (!done || !queue.IsEmpty()) {
+        if (queue.Steal(item)) {
+          sum += item;
+          ++taken;
+        }
+      }
+    });
+  }
+
+  int item = 0;
+  for (int i = 1; i <= count; ++i) {
+    queue.Push(i);
+    if (i % 3 == 0 && queue.Pop(item)) {
+      sum += item;
+      ++taken;
+    }
+  }
+  while (queue.Pop(item)) {
+    sum += item;
+    ++taken;
+  }
+  done = true;
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+
+  ASSERT_EQ(count, taken);
+  ASSERT_EQ(static_cast<long long>(count) * (count + 1) / 2, sum);
+}
@@ -0,0 +1,70 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/buffer.h"
+#include <gtest/gtest.h>
+#include <boost/asio/buffer.hpp>
+#include <string>
+
+using rms::net::Buffer;
+using rms::net::BufferBlock;
+using rms::net::BufferBlockPtr;
+using rms::net::BufferSlice;
+
+TEST(TestBuffer, CopyFromView) {
+  const std::string data(BufferBlock::kSize + 10u, 'x');
+  const Buffer buffer{data};
+  ASSERT_EQ(data.size(), buffer.GetSize());
+  ASSERT_EQ(2u, buffer.GetSlices().size());
+  ASSERT_FALSE(buffer.IsContiguous());
+  ASSERT_EQ(data, buffer);
+  ASSERT_EQ(data, buffer.ToString());
+  ASSERT_EQ(data.size(), boost::asio::buffer_size(buffer.GetConstBuffers()));
+}
+
+TEST(TestBuffer, SliceAndAppendShareBlocks) {
+  const Buffer payload{"0123456789"};
+  const auto middle = payload.Slice(2u, 5u);
+  ASSERT_EQ("23456", middle);
+  ASSERT_EQ(payload.GetSlices().front().GetBlock(), middle.GetSlices().front().GetBlock());
+  ASSERT_EQ("789", payload.Slice(7u));
+  ASSERT_TRUE(payload.Slice(10u).IsEmpty());
+
+  Buffer reply{"echo: "};
+  reply += payload;
+  ASSERT_EQ("echo: 0123456789", reply);
+  ASSERT_EQ(2u, reply.GetSlices().size());
+  ASSERT_EQ(payload.GetSlices().front().GetBlock(), reply.GetSlices().back().GetBlock());
+
+  // Shared block is never written, data is appended to a new one
+  Buffer shared = payload;
+  shared += "!";
+  ASSERT_EQ("0123456789", payload);
+  ASSERT_EQ("0123456789!", shared);
+  ASSERT_EQ(2u, shared.GetSlices().size());
+}
+
+TEST(TestBuffer, AppendMergesAdjacentSlices) {
+  auto block = BufferBlock::Create();
+  const auto* data = block->GetData();
+  Buffer buffer;
+  buffer.Append(BufferSlice(block, data, 3u));
+  buffer.Append(BufferSlice(block, data + 3u, 4u));
+  ASSERT_EQ(1u, buffer.GetSlices().size());
+  ASSERT_EQ(7u, buffer.GetSize());
+  ASSERT_TRUE(block->IsShared());
+  buffer.Clear();
+  ASSERT_FALSE(block->IsShared());
+}
+
+TEST(TestBuffer, FindAcrossSlices) {
+  Buffer buffer{"abc\r"};
+  buffer += Buffer{"\nde\r\n"};
+  ASSERT_EQ(2u, buffer.GetSlices().size());
+  ASSERT_EQ(3u, buffer.Find("\r\n"));
+  ASSERT_EQ(7u, buffer.Find("\r\n", 4u));
+  ASSERT_EQ(Buffer::npos, buffer.Find("\r\n", 8u));
+  ASSERT_EQ(Buffer::npos, buffer.Find("x"));
+  ASSERT_EQ(0u, buffer.Find(""));
+  ASSERT_EQ(Buffer{"abc\r\nde\r\n"}, buffer);
+  ASSERT_NE(Buffer{"abc\r\nde\r!"}, buffer);
+}
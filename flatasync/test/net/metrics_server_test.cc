@@ -0,0 +1,109 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/metrics_server.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "core/async.h"
+#include "core/helper.h"
+#include "net/tcp_socket.h"
+#include "util/logger.h"
+#include "util/metrics.h"
+
+DECLARE_GLOBAL_GET_LOGGER("Test.Net.MetricsServer")
+
+namespace {
+
+using rms::core::RunAsync;
+using rms::core::SchedulersInitiator;
+using rms::core::WaitAll;
+using rms::net::MetricsServer;
+using rms::net::TcpSocket;
+using rms::util::GetMetricsRegistryInstance;
+
+const char SERVER_ADDRESS[] = "127.0.0.1";
+
+const int SERVER_PORT = 10127;
+
+// Send request in parts and read response until server closes connection
+std::string Request(const std::string& request, const std::string& request_end = std::string()) {
+  auto socket = TcpSocket::Create();
+  socket->Connect(SERVER_ADDRESS, SERVER_PORT);
+  socket->Write(request);
+  if (!request_end.empty()) {
+    socket->Write(request_end);
+  }
+  std::string response;
+  while (true) {
+    const auto read_result = socket->ReadPartial();
+    if (read_result.second || read_result.first.IsEmpty()) {
+      break;
+    }
+    response += read_result.first.ToString();
+  }
+  socket->Stop();
+  return response;
+}
+
+}  // namespace
+
+TEST(TestMetricsServer, Scrape) {
+  LOG_AUTO_TRACE();
+
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+
+  GetMetricsRegistryInstance().GetCounter("test_metrics_server_total", "Test counter").Increment(5u);
+
+  std::unique_ptr<MetricsServer> metrics_server;
+  std::string metrics_response;
+  std::string not_found_response;
+  std::string wrong_method_response;
+
+  std::mutex mutex;
+  std::condition_variable waiter;
+  std::atomic_bool server_stopped{false};
+
+  RunAsync([&] {
+    metrics_server = std::make_unique<MetricsServer>(GetMetricsRegistryInstance());
+
+    metrics_server->SubscribeOnListening([&]() {
+      // End of headers is split between writes
+      metrics_response = Request("GET /metrics?name[]=all HTTP/1.1\r\nHost: localhost\r\n\r", "\n");
+      not_found_response = Request("GET / HTTP/1.1\r\n\r\n");
+      wrong_method_response = Request("POST /metrics HTTP/1.1\r\n\r\n");
+      metrics_server->Stop();
+    });
+
+    metrics_server->SubscribeOnStopped([&]() {
+      server_stopped = true;
+      waiter.notify_one();
+    });
+
+    metrics_server->Start(SERVER_ADDRESS, SERVER_PORT);
+  });
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    waiter.wait(lock, [&]() { return server_stopped.load(); });
+  }
+  WaitAll();
+
+  ASSERT_EQ(0u, metrics_response.find("HTTP/1.1 200 OK\r\n")) << metrics_response;
+  ASSERT_NE(std::string::npos, metrics_response.find("Content-Type: text/plain; version=0.0.4\r\n"));
+  ASSERT_NE(std::string::npos, metrics_response.find("\ntest_metrics_server_total 5\n"));
+  ASSERT_NE(std::string::npos, metrics_response.find("\nflatasync_tcp_server_accepted_connections_total "));
+  ASSERT_NE(std::string::npos, metrics_response.find("\nflatasync_thread_pool_queued_tasks{pool=\"net\"} "));
+  ASSERT_NE(std::string::npos, metrics_response.find("\nflatasync_async_runners "));
+
+  const auto body_position = metrics_response.find("\r\n\r\n") + 4u;
+  const auto content_length = "Content-Length: " + std::to_string(metrics_response.size() - body_position) + "\r\n";
+  ASSERT_NE(std::string::npos, metrics_response.find(content_length));
+
+  ASSERT_EQ(0u, not_found_response.find("HTTP/1.1 404 Not Found\r\n")) << not_found_response;
+  ASSERT_EQ(0u, wrong_method_response.find("HTTP/1.1 405 Method Not Allowed\r\n")) << wrong_method_response;
+}
@@ -0,0 +1,83 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/receive_buffer.h"
+#include <gtest/gtest.h>
+#include <boost/asio/buffer.hpp>
+#include <cstring>
+
+using rms::net::BufferBlock;
+using rms::net::ReceiveBuffer;
+
+namespace {
+
+char* GetData(ReceiveBuffer::MutableBuffersType buffers) {
+  return boost::asio::buffer_cast<char*>(buffers.front());
+}
+
+}  // namespace
+
+TEST(TestReceiveBuffer, ReuseReleasedMemory) {
+  ReceiveBuffer buffer{16u, 16u};
+  const auto first = GetData(buffer.Prepare());
+  std::memcpy(first, "abc", 3u);
+  {
+    const auto data = buffer.Commit(3u);
+    ASSERT_EQ("abc", data);
+    ASSERT_EQ(first, data.GetSlices().front().GetData());
+    // Data is still referenced: next read goes after it
+    ASSERT_EQ(first + 3u, GetData(buffer.Prepare()));
+    buffer.Commit(0u);
+  }
+  const auto second = buffer.Prepare();
+  ASSERT_EQ(first, GetData(second));
+  ASSERT_EQ(16u, boost::asio::buffer_size(second));
+}
+
+TEST(TestReceiveBuffer, ReadSpansBlocks) {
+  ReceiveBuffer buffer{BufferBlock::kSize * 2u, BufferBlock::kSize * 2u};
+  const auto buffers = buffer.Prepare();
+  ASSERT_EQ(2u, buffers.size());
+  const auto data = buffer.Commit(BufferBlock::kSize + 1u);
+  ASSERT_EQ(BufferBlock::kSize + 1u, data.GetSize());
+  ASSERT_EQ(2u, data.GetSlices().size());
+  ASSERT_EQ(BufferBlock::kSize * 2u, boost::asio::buffer_size(buffer.Prepare(BufferBlock::kSize * 2u)));
+}
+
+TEST(TestReceiveBuffer, GrowWhenFull) {
+  ReceiveBuffer buffer{16u, 64u};
+  for (const auto expected_capacity : {32u, 64u, 64u}) {
+    buffer.Prepare();
+    buffer.Commit(buffer.GetCapacity());
+    ASSERT_EQ(expected_capacity, buffer.GetCapacity());
+  }
+  // Exact reads don't affect adaptive size
+  buffer.Prepare(8u);
+  buffer.Commit(8u);
+  ASSERT_EQ(64u, buffer.GetCapacity());
+
+  ReceiveBuffer fixed{16u, 16u};
+  fixed.Prepare();
+  fixed.Commit(16u);
+  ASSERT_EQ(16u, fixed.GetCapacity());
+}
+
+TEST(TestReceiveBuffer, ShrinkAfterSmallReads) {
+  ReceiveBuffer buffer{16u, 64u};
+  while (buffer.GetCapacity() != 64u) {
+    buffer.Prepare();
+    buffer.Commit(buffer.GetCapacity());
+  }
+  std::size_t read_count = 0u;
+  while (buffer.GetCapacity() != 16u) {
+    buffer.Prepare();
+    buffer.Commit(1u);
+    ++read_count;
+    ASSERT_LT(read_count, 1000u);
+  }
+  // Never below the initial size
+  for (int i = 0; i < 1000; ++i) {
+    buffer.Prepare();
+    buffer.Commit(1u);
+  }
+  ASSERT_EQ(16u, buffer.GetCapacity());
+}
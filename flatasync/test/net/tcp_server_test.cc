@@ -2,6 +2,9 @@
 
 #include <memory>
 #include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "core/async.h"
 #include "core/helper.h"
@@ -28,6 +31,7 @@ using rms::core::HandlerType;
 using rms::core::RunAsync;
 using rms::core::SchedulersInitiator;
 using rms::core::SequentialScheduler;
+using rms::core::ThreadPool;
 using rms::core::WaitAll;
 using rms::net::BufferType;
 using rms::net::GetNetworkServiceAccessorInstance;
@@ -41,6 +45,56 @@ const char SERVER_ECHO_PREFIX[] = "echo: ";
 
 const char GREETING[] = "Hello World!!!";
 
+// Connect clients to the server started with given accept options, stop server when all of them are connected
+void ConnectClients(const TcpServer::AcceptOptions& accept_options, int client_count) {
+  LOG_AUTO_TRACE();
+
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+
+  std::unique_ptr<TcpServer> tcp_server;
+  std::vector<std::shared_ptr<TcpSocket>> clients;
+  std::atomic_int connected_count{0};
+
+  std::mutex mutex;
+  std::condition_variable waiter;
+  std::atomic_bool server_stopped{false};
+
+  RunAsync([&] {
+    tcp_server = std::make_unique<TcpServer>(client_count);
+    tcp_server->SetAcceptOptions(accept_options);
+
+    tcp_server->SubscribeOnConnected([&](TcpServerIdType) {
+      if (++connected_count == client_count) {
+        tcp_server->Stop();
+      }
+    });
+
+    tcp_server->SubscribeOnListening([&]() {
+      for (int i = 0; i < client_count; ++i) {
+        clients.push_back(TcpSocket::Create());
+        clients.back()->Connect("127.0.0.1", SERVER_PORT);
+        clients.back()->Start();
+      }
+    });
+
+    tcp_server->SubscribeOnStopped([&]() {
+      server_stopped = true;
+      waiter.notify_one();
+    });
+
+    tcp_server->Start(SERVER_PORT);
+  });
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    waiter.wait(lock, [&]() { return server_stopped.load(); });
+  }
+
+  WaitAll();
+
+  ASSERT_EQ(client_count, connected_count);
+}
+
 }  // namespace
 
 TEST(TestTcpServer, EchoTest) {
@@ -76,13 +130,13 @@ TEST(TestTcpServer, EchoTest) {
           socket->Connect("127.0.0.1", SERVER_PORT);
 
           for (int i = 1; i <= 3; ++i) {
-            BufferType snd_buffer{GREETING};
+            std::string snd_buffer{GREETING};
             snd_buffer += " #" + std::to_string(i);
             LOG_DEBUG("Client: sending data: " << snd_buffer);
             socket->Write(snd_buffer + "\n");
             ++execution_step;
             LOG_DEBUG("Client: reading reply from server");
-            auto rcv_buffer = socket->ReadUntil("\n");
+            auto rcv_buffer = socket->ReadUntil("\n").ToString();
             boost::algorithm::trim(rcv_buffer);
             LOG_DEBUG("Client: received data: " << rcv_buffer);
             ASSERT_EQ(SERVER_ECHO_PREFIX + snd_buffer, rcv_buffer);
@@ -99,10 +153,10 @@ TEST(TestTcpServer, EchoTest) {
         tcp_server->SubscribeOnData([&](TcpServerIdType id, const BufferType& data) {
           ASSERT_EQ(1u, id);
           ++execution_step;
-          const auto rcv_buffer = boost::algorithm::trim_copy(data);
+          const auto rcv_buffer = boost::algorithm::trim_copy(data.ToString());
           LOG_DEBUG("Server: received data: " << rcv_buffer);
           ++execution_step;
-          BufferType snd_buffer{SERVER_ECHO_PREFIX};
+          std::string snd_buffer{SERVER_ECHO_PREFIX};
           snd_buffer += rcv_buffer;
           LOG_DEBUG("Server: sending data: " << snd_buffer);
           tcp_server->Write(id, snd_buffer + "\n");
@@ -256,3 +310,245 @@ TEST(TestTcpServer, MaxConnections) {
 
   ASSERT_EQ(13, execution_step);
 }
+
+TEST(TestTcpServer, SetMaxConnections) {
+  LOG_AUTO_TRACE();
+
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+
+  SequentialScheduler net_sequential_scheduler(GetNetworkServiceAccessorInstance().GetRef(), "net_sequential");
+
+  std::unique_ptr<TcpServer> tcp_server;
+
+  std::shared_ptr<TcpSocket> client1;
+  // Refused while the limit is 1
+  std::shared_ptr<TcpSocket> client2;
+  // Accepted after the limit is raised
+  std::shared_ptr<TcpSocket> client3;
+
+  std::atomic_int connected_count{0};
+  std::atomic_bool client2_refused{false};
+
+  std::mutex mutex;
+  std::condition_variable waiter;
+  std::atomic_bool server_stopped{false};
+
+  RunAsync(
+      [&] {
+        tcp_server = std::make_unique<TcpServer>(1u);
+        ASSERT_EQ(1u, tcp_server->GetMaxConnections());
+        client1 = TcpSocket::Create();
+        client2 = TcpSocket::Create();
+        client3 = TcpSocket::Create();
+
+        client2->SubscribeOnDisconnected([&](TcpSocket&) {
+          if (server_stopped || connected_count != 1) {
+            return;
+          }
+          client2_refused = true;
+          tcp_server->SetMaxConnections(2u);
+          ASSERT_EQ(2u, tcp_server->GetMaxConnections());
+          client3->Connect("127.0.0.1", SERVER_PORT);
+          client3->Start();
+        });
+
+        tcp_server->SubscribeOnConnected([&](TcpServerIdType id) {
+          LOG_DEBUG("Server: Connected: id=" << id);
+          if (++connected_count == 2) {
+            tcp_server->Stop();
+          }
+        });
+
+        tcp_server->SubscribeOnListening([&]() {
+          client1->Connect("127.0.0.1", SERVER_PORT);
+          client1->Start();
+          client2->Connect("127.0.0.1", SERVER_PORT);
+          client2->Start();
+        });
+
+        tcp_server->SubscribeOnStopped([&]() {
+          server_stopped = true;
+          waiter.notify_one();
+        });
+
+        tcp_server->Start(SERVER_PORT);
+      },
+      net_sequential_scheduler);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    waiter.wait(lock, [&]() { return server_stopped.load(); });
+  }
+
+  WaitAll();
+
+  ASSERT_TRUE(client2_refused);
+  ASSERT_EQ(2, connected_count);
+}
+
+TEST(TestTcpServer, MultipleAcceptors) {
+  TcpServer::AcceptOptions accept_options;
+  accept_options.acceptor_count = 4u;
+  accept_options.accepts_per_acceptor = 2u;
+  ConnectClients(accept_options, 16);
+}
+
+TEST(TestTcpServer, BatchAccept) {
+  TcpServer::AcceptOptions accept_options;
+  accept_options.accept_batch_size = 8u;
+  accept_options.listen_backlog = 64;
+  ConnectClients(accept_options, 32);
+}
+
+namespace {
+
+// Clients write right after connect, stop server when all of them are received
+void RunConnectionSchedulersTest(ThreadPool::Mode mode) {
+  LOG_AUTO_TRACE();
+
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>(mode);
+
+  const int client_count = 8;
+  std::unique_ptr<TcpServer> tcp_server;
+  std::vector<std::shared_ptr<TcpSocket>> clients;
+  std::mutex connected_mutex;
+  std::set<TcpServerIdType> connected_ids;
+  std::atomic_int received_count{0};
+  std::atomic_int misordered_count{0};
+  std::atomic_int wrong_scheduler_count{0};
+  std::atomic_int wrong_shard_count{0};
+
+  std::mutex mutex;
+  std::condition_variable waiter;
+  std::atomic_bool server_stopped{false};
+
+  RunAsync([&] {
+    tcp_server = std::make_unique<TcpServer>(client_count);
+    tcp_server->SetConnectionSchedulerCount(4u);
+
+    tcp_server->SubscribeOnConnected([&](TcpServerIdType id) {
+      std::lock_guard<std::mutex> lock(connected_mutex);
+      connected_ids.insert(id);
+    });
+
+    tcp_server->SubscribeOnData([&](TcpServerIdType id, const BufferType&) {
+      if (std::string{"tcp_connection"} != rms::core::GetCurrentThreadScheduler().GetName()) {
+        ++wrong_scheduler_count;
+      }
+      // Scheduler of the client runs on the shard which completes io of its socket
+      auto* scheduler = dynamic_cast<SequentialScheduler*>(&rms::core::GetCurrentThreadScheduler());
+      const auto socket = tcp_server->GetSocket(id);
+      if (scheduler == nullptr || !socket || &scheduler->GetAsioService() != &socket->GetAsioService()) {
+        ++wrong_shard_count;
+      }
+      {
+        // Client writes right after connect, data must not overtake OnConnected
+        std::lock_guard<std::mutex> lock(connected_mutex);
+        if (connected_ids.count(id) == 0u) {
+          ++misordered_count;
+        }
+      }
+      if (++received_count == client_count) {
+        tcp_server->Stop();
+      }
+    });
+
+    tcp_server->SubscribeOnListening([&]() {
+      for (int i = 0; i < client_count; ++i) {
+        clients.push_back(TcpSocket::Create());
+        clients.back()->Connect("127.0.0.1", SERVER_PORT);
+        clients.back()->Write(GREETING);
+        clients.back()->Start();
+      }
+    });
+
+    tcp_server->SubscribeOnStopped([&]() {
+      server_stopped = true;
+      waiter.notify_one();
+    });
+
+    tcp_server->Start(SERVER_PORT);
+  });
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    waiter.wait(lock, [&]() { return server_stopped.load(); });
+  }
+
+  WaitAll();
+
+  ASSERT_EQ(client_count, received_count);
+  ASSERT_EQ(0, misordered_count);
+  ASSERT_EQ(0, wrong_scheduler_count);
+  ASSERT_EQ(0, wrong_shard_count);
+}
+
+}  // namespace
+
+TEST(TestTcpServer, ConnectionSchedulers) {
+  RunConnectionSchedulersTest(ThreadPool::Mode::Shared);
+}
+
+TEST(TestTcpServer, ConnectionSchedulersSharded) {
+  RunConnectionSchedulersTest(ThreadPool::Mode::Sharded);
+}
+
+TEST(TestTcpServer, RestartWithOtherConnectionSchedulers) {
+  LOG_AUTO_TRACE();
+
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+
+  const int client_count = 8;
+  std::unique_ptr<TcpServer> tcp_server;
+  std::vector<std::shared_ptr<TcpSocket>> clients;
+  std::atomic_int round{1};
+  std::atomic_int received_count{0};
+
+  std::mutex mutex;
+  std::condition_variable waiter;
+  std::atomic_bool server_stopped{false};
+
+  RunAsync([&] {
+    tcp_server = std::make_unique<TcpServer>(client_count);
+    tcp_server->SetConnectionSchedulerCount(2u);
+
+    tcp_server->SubscribeOnData([&](TcpServerIdType, const BufferType&) {
+      // Clients of the first round are still disconnecting from the replaced schedulers, while the second round runs
+      if (++received_count % client_count == 0) {
+        tcp_server->Stop();
+      }
+    });
+
+    tcp_server->SubscribeOnListening([&]() {
+      for (int i = 0; i < client_count; ++i) {
+        clients.push_back(TcpSocket::Create());
+        clients.back()->Connect("127.0.0.1", SERVER_PORT);
+        clients.back()->Write(GREETING);
+        clients.back()->Start();
+      }
+    });
+
+    tcp_server->SubscribeOnStopped([&]() {
+      auto expected_round = 1;
+      if (round.compare_exchange_strong(expected_round, 2)) {
+        tcp_server->SetConnectionSchedulerCount(3u);
+        tcp_server->Start(SERVER_PORT);
+      } else if (received_count == 2 * client_count) {
+        server_stopped = true;
+        waiter.notify_one();
+      }
+    });
+
+    tcp_server->Start(SERVER_PORT);
+  });
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    waiter.wait(lock, [&]() { return server_stopped.load(); });
+  }
+
+  WaitAll();
+
+  ASSERT_EQ(2, round);
+  ASSERT_EQ(2 * client_count, received_count);
+}
@@ -3,14 +3,19 @@
 #include <memory>
 
 #include "core/async.h"
+#include "core/default_scheduler_accessor.h"
 #include "core/helper.h"
 #include "net/acceptor.h"
 #include "net/tcp_socket.h"
 #include "net/util.h"
 #include "util/logger.h"
+#include "util/scope_guard.h"
+#include "util/thread_util.h"
 
 #include <gtest/gtest.h>
 #include <atomic>
+#include <chrono>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include "net/alias.h"
@@ -19,13 +24,20 @@ DECLARE_GLOBAL_GET_LOGGER("Test.Net.TcpSocket")
 
 namespace {
 
+using rms::core::AsyncOpStatus;
+using rms::core::GetTimeoutServiceAccessorInstance;
 using rms::core::RunAsync;
 using rms::core::SchedulersInitiator;
+using rms::core::ThreadPool;
+using rms::core::Timeout;
 using rms::core::WaitAll;
 using rms::net::Acceptor;
 using rms::net::BufferType;
+using rms::net::BufferViewType;
 using rms::net::GetNetworkSchedulerAccessorInstance;
 using rms::net::TcpSocket;
+using rms::util::MakeScopeGuard;
+using rms::util::SleepFor;
 
 const int SERVER_PORT = 10123;
 
@@ -33,12 +45,8 @@ const char SERVER_ECHO_PREFIX[] = "echo: ";
 
 const char GREETING[] = "Hello World!!!";
 
-}  // namespace
-
-TEST(TestTcpSocket, SocketEchoTest) {
-  LOG_AUTO_TRACE();
-
-  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+void RunSocketEchoTest(ThreadPool::Mode mode) {
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>(mode);
   std::atomic_int execution_step{0};
 
   RunAsync(
@@ -71,7 +79,7 @@ TEST(TestTcpSocket, SocketEchoTest) {
 
         auto socket = TcpSocket::Create();
         socket->Connect("127.0.0.1", SERVER_PORT);
-        BufferType snd_buffer{GREETING};
+        const std::string snd_buffer{GREETING};
         LOG_DEBUG("Client: sending data: " << snd_buffer);
         socket->Write(snd_buffer);
         ++execution_step;
@@ -90,6 +98,58 @@ TEST(TestTcpSocket, SocketEchoTest) {
   ASSERT_EQ(7, execution_step);
 }
 
+// Peer doesn't read until asked, so a write of this size stays in flight
+const std::size_t kLargeSize = 32u * 1024u * 1024u;
+
+template <typename Predicate>
+void WaitFor(Predicate predicate) {
+  while (!predicate()) {
+    SleepFor(1);
+  }
+}
+
+void ConnectSockets(std::shared_ptr<TcpSocket>& client_socket, std::shared_ptr<TcpSocket>& server_socket) {
+  RunAsync(
+      [&] {
+        Acceptor acceptor(SERVER_PORT);
+        RunAsync([&]() { acceptor.DoAccept([&](std::shared_ptr<TcpSocket> socket) { server_socket = socket; }); });
+        auto socket = TcpSocket::Create();
+        socket->Connect("127.0.0.1", SERVER_PORT);
+        client_socket = socket;
+      },
+      GetNetworkSchedulerAccessorInstance().GetRef());
+  WaitFor([&] { return client_socket && server_socket; });
+}
+
+void ReadAll(TcpSocket& socket, std::size_t size) {
+  RunAsync(
+      [&socket, size] {
+        std::size_t read_size = 0u;
+        while (read_size < size) {
+          read_size += socket.ReadPartial().first.GetSize();
+        }
+        ASSERT_EQ(size, read_size);
+      },
+      GetNetworkSchedulerAccessorInstance().GetRef());
+}
+
+}  // namespace
+
+TEST(TestTcpSocket, SocketEchoTest) {
+  LOG_AUTO_TRACE();
+  RunSocketEchoTest(ThreadPool::Mode::Shared);
+}
+
+TEST(TestTcpSocket, SocketEchoTestWorkStealing) {
+  LOG_AUTO_TRACE();
+  RunSocketEchoTest(ThreadPool::Mode::WorkStealing);
+}
+
+TEST(TestTcpSocket, SocketEchoTestSharded) {
+  LOG_AUTO_TRACE();
+  RunSocketEchoTest(ThreadPool::Mode::Sharded);
+}
+
 TEST(TestTcpSocket, SocketEchoTestReadPartial) {
   LOG_AUTO_TRACE();
 
@@ -122,7 +182,7 @@ TEST(TestTcpSocket, SocketEchoTestReadPartial) {
 
         auto socket = TcpSocket::Create();
         socket->Connect("127.0.0.1", SERVER_PORT);
-        BufferType snd_buffer{GREETING};
+        const std::string snd_buffer{GREETING};
         LOG_DEBUG("Client: sending data: " << snd_buffer);
         socket->Write(snd_buffer);
         ++execution_step;
@@ -140,3 +200,146 @@ TEST(TestTcpSocket, SocketEchoTestReadPartial) {
 
   ASSERT_EQ(7, execution_step);
 }
+
+TEST(TestTcpSocket, CancelAbortsPendingRead) {
+  LOG_AUTO_TRACE();
+
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+  std::atomic_int execution_step{0};
+  std::shared_ptr<TcpSocket> server_socket;
+
+  auto client_state = RunAsync(
+      [&] {
+        Acceptor acceptor(SERVER_PORT);
+        RunAsync([&]() {
+          // Keep connection open without sending anything
+          acceptor.DoAccept([&](std::shared_ptr<TcpSocket> accepted_socket) { server_socket = accepted_socket; });
+        });
+
+        auto socket = TcpSocket::Create();
+        socket->Connect("127.0.0.1", SERVER_PORT);
+        ++execution_step;
+        socket->ReadPartial();  // Pending until aborted by Cancel
+        ++execution_step;       // this inc should not happen
+      },
+      GetNetworkSchedulerAccessorInstance().GetRef());
+
+  while (execution_step == 0) {
+    SleepFor(1);
+  }
+  SleepFor(20);
+  ASSERT_TRUE(client_state.Cancel());
+
+  // Without abort the read would wait for data forever
+  ASSERT_TRUE(WaitAll(std::chrono::milliseconds(5000)));
+  ASSERT_EQ(1, execution_step);
+  ASSERT_EQ(rms::core::AsyncOpStatus::Cancelled, client_state.GetStatus());
+  server_socket.reset();
+}
+
+TEST(TestTcpSocket, GatheredWrite) {
+  LOG_AUTO_TRACE();
+
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+  std::atomic_int execution_step{0};
+
+  RunAsync(
+      [&] {
+        Acceptor acceptor(SERVER_PORT);
+        RunAsync([&]() {
+          acceptor.DoAccept([&](std::shared_ptr<TcpSocket> accepted_socket) {
+            const auto rcv_buffer = accepted_socket->ReadExact(sizeof(SERVER_ECHO_PREFIX) - 1 + sizeof(GREETING));
+            ASSERT_EQ(std::string(SERVER_ECHO_PREFIX) + GREETING + "\n", rcv_buffer);
+            ++execution_step;
+          });
+        });
+
+        auto socket = TcpSocket::Create();
+        socket->Connect("127.0.0.1", SERVER_PORT);
+        // Payload spans several blocks, prefix and trailer are external memory
+        BufferType payload{BufferViewType(GREETING, 5u)};
+        payload += BufferType{GREETING + 5};
+        ASSERT_EQ(2u, payload.GetSlices().size());
+        socket->Write({SERVER_ECHO_PREFIX, payload, std::string("\n")});
+        ++execution_step;
+      },
+      GetNetworkSchedulerAccessorInstance().GetRef());
+
+  WaitAll();
+  ASSERT_EQ(2, execution_step);
+}
+
+TEST(TestTcpSocket, TimedOutWriteKeepsConnection) {
+  LOG_AUTO_TRACE();
+
+  ThreadPool thread_pool_timeout{1u, "timeout"};
+  GetTimeoutServiceAccessorInstance().Attach(thread_pool_timeout);
+  const auto timeout_guard = MakeScopeGuard([] { GetTimeoutServiceAccessorInstance().Detach(); });
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+  std::shared_ptr<TcpSocket> client_socket;
+  std::shared_ptr<TcpSocket> server_socket;
+  ConnectSockets(client_socket, server_socket);
+
+  std::atomic<std::size_t> received_size{0u};
+  std::atomic_bool is_disconnected{false};
+  client_socket->SubscribeOnData([&](TcpSocket&, const BufferType& data) { received_size += data.GetSize(); });
+  client_socket->SubscribeOnDisconnected([&](TcpSocket&) { is_disconnected = true; });
+  client_socket->Start(GetNetworkSchedulerAccessorInstance().GetRef());
+
+  const std::string large_message(kLargeSize, 'x');
+  auto write_state = RunAsync(
+      [&] {
+        Timeout timeout(20);
+        client_socket->Write(large_message);
+      },
+      GetNetworkSchedulerAccessorInstance().GetRef());
+  WaitFor([&] { return write_state.GetStatus() == AsyncOpStatus::Timedout; });
+  SleepFor(20);
+
+  // Read loop keeps receiving
+  RunAsync([&] { server_socket->Write(std::string(GREETING)); }, GetNetworkSchedulerAccessorInstance().GetRef());
+  WaitFor([&] { return received_size == sizeof(GREETING) - 1u; });
+  ReadAll(*server_socket, kLargeSize);
+  WaitFor([&] { return client_socket->GetWriteQueueStats().written_bytes == kLargeSize; });
+  ASSERT_FALSE(is_disconnected);
+
+  client_socket->Stop();
+  ASSERT_TRUE(WaitAll(std::chrono::milliseconds(5000)));
+  ASSERT_EQ(AsyncOpStatus::Timedout, write_state.GetStatus());
+}
+
+TEST(TestTcpSocket, TimedOutReadKeepsWriteInFlight) {
+  LOG_AUTO_TRACE();
+
+  ThreadPool thread_pool_timeout{1u, "timeout"};
+  GetTimeoutServiceAccessorInstance().Attach(thread_pool_timeout);
+  const auto timeout_guard = MakeScopeGuard([] { GetTimeoutServiceAccessorInstance().Detach(); });
+  auto schedulers_initiator = std::make_unique<SchedulersInitiator>();
+  std::shared_ptr<TcpSocket> client_socket;
+  std::shared_ptr<TcpSocket> server_socket;
+  ConnectSockets(client_socket, server_socket);
+
+  const std::string large_message(kLargeSize, 'x');
+  std::atomic_bool is_written{false};
+  RunAsync(
+      [&] {
+        ASSERT_FALSE(client_socket->Write(large_message));
+        is_written = true;
+      },
+      GetNetworkSchedulerAccessorInstance().GetRef());
+  WaitFor([&] { return client_socket->GetWriteQueueStats().batch_count == 1u; });
+
+  auto read_state = RunAsync(
+      [&] {
+        Timeout timeout(20);
+        client_socket->ReadPartial();
+      },
+      GetNetworkSchedulerAccessorInstance().GetRef());
+  WaitFor([&] { return read_state.GetStatus() == AsyncOpStatus::Timedout; });
+
+  // Write which has been aborted along with the read is resumed, so the whole message arrives
+  ReadAll(*server_socket, kLargeSize);
+  ASSERT_TRUE(WaitAll(std::chrono::milliseconds(5000)));
+  ASSERT_TRUE(is_written);
+  ASSERT_EQ(kLargeSize, client_socket->GetWriteQueueStats().written_bytes);
+}
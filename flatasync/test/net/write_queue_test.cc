@@ -0,0 +1,183 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "net/write_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "core/async.h"
+#include "core/helper.h"
+#include "net/acceptor.h"
+#include "net/tcp_socket.h"
+#include "net/util.h"
+#include "util/thread_util.h"
+
+using rms::core::AsyncOpState;
+using rms::core::AsyncOpStatus;
+using rms::core::RunAsync;
+using rms::core::SchedulersInitiator;
+using rms::core::WaitAll;
+using rms::net::Acceptor;
+using rms::net::ErrorType;
+using rms::net::GetNetworkSchedulerAccessorInstance;
+using rms::net::TcpSocket;
+using rms::net::WriteQueue;
+using rms::util::SleepFor;
+
+namespace {
+
+const int SERVER_PORT = 10125;
+
+// Peer doesn't read until asked, so a write of this size stays in flight
+const std::size_t kLargeSize = 32u * 1024u * 1024u;
+
+const std::size_t kSmallSize = 16u;
+
+const std::size_t kSmallWriteCount = 3u;
+
+template <typename Predicate>
+void WaitFor(Predicate predicate) {
+  while (!predicate()) {
+    SleepFor(1);
+  }
+}
+
+/**
+ * Connected pair of sockets. Writes one large message which is kept in flight until ReadAll is called.
+ */
+class TestWriteQueue : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    RunAsync(
+        [this] {
+          Acceptor acceptor(SERVER_PORT);
+          RunAsync([&] { acceptor.DoAccept([this](std::shared_ptr<TcpSocket> socket) { server_ = socket; }); });
+          auto client = TcpSocket::Create();
+          client->Connect("127.0.0.1", SERVER_PORT);
+          client_ = client;
+        },
+        GetNetworkSchedulerAccessorInstance().GetRef());
+    WaitFor([this] { return server_ && client_; });
+  }
+
+  void TearDown() override {
+    client_.reset();
+    server_.reset();
+  }
+
+  AsyncOpState StartLargeWrite() {
+    auto state = RunAsync(
+        [this] {
+          const auto error = client_->Write(large_message_);
+          ASSERT_FALSE(error);
+        },
+        GetNetworkSchedulerAccessorInstance().GetRef());
+    WaitFor([this] { return client_->GetWriteQueueStats().batch_count == 1u; });
+    return state;
+  }
+
+  void StartSmallWrites(WriteQueue::OverflowPolicy policy) {
+    for (std::size_t i = 0u; i < kSmallWriteCount; ++i) {
+      RunAsync(
+          [this, policy] {
+            const auto error = client_->Write(small_message_);
+            if (policy == WriteQueue::OverflowPolicy::Reject) {
+              ASSERT_EQ(boost::asio::error::no_buffer_space, error);
+            } else {
+              ASSERT_FALSE(error);
+            }
+          },
+          GetNetworkSchedulerAccessorInstance().GetRef());
+    }
+  }
+
+  void ReadAll(std::size_t size) {
+    RunAsync(
+        [this, size] {
+          std::size_t read_size = 0u;
+          while (read_size < size) {
+            read_size += server_->ReadPartial().first.GetSize();
+          }
+          ASSERT_EQ(size, read_size);
+        },
+        GetNetworkSchedulerAccessorInstance().GetRef());
+    WaitAll();
+  }
+
+  SchedulersInitiator schedulers_initiator_;
+
+  std::shared_ptr<TcpSocket> server_;
+
+  std::shared_ptr<TcpSocket> client_;
+
+  const std::string large_message_ = std::string(kLargeSize, 'x');
+
+  const std::string small_message_ = std::string(kSmallSize, 'y');
+};
+
+}  // namespace
+
+TEST_F(TestWriteQueue, CoalesceQueuedWrites) {
+  StartLargeWrite();
+  StartSmallWrites(WriteQueue::OverflowPolicy::Suspend);
+  WaitFor([this] { return client_->GetWriteQueueStats().queue_depth == kSmallWriteCount; });
+  ReadAll(kLargeSize + kSmallWriteCount * kSmallSize);
+
+  const auto stats = client_->GetWriteQueueStats();
+  // Small writes which came while the large one was in flight are sent with one gathered write
+  ASSERT_EQ(2u, stats.batch_count);
+  ASSERT_EQ(1u + kSmallWriteCount, stats.write_count);
+  ASSERT_EQ(kLargeSize + kSmallWriteCount * kSmallSize, stats.written_bytes);
+  ASSERT_EQ(kSmallWriteCount, stats.max_queue_depth);
+  ASSERT_EQ(0u, stats.queue_depth);
+  ASSERT_EQ(0u, stats.pending_bytes);
+}
+
+TEST_F(TestWriteQueue, SuspendOverHighWaterMark) {
+  client_->SetWriteHighWaterMark(kLargeSize + kSmallSize, WriteQueue::OverflowPolicy::Suspend);
+  StartLargeWrite();
+  StartSmallWrites(WriteQueue::OverflowPolicy::Suspend);
+  WaitFor([this] { return client_->GetWriteQueueStats().queue_depth == kSmallWriteCount; });
+  // Only one small write fits under the mark
+  ASSERT_EQ(kLargeSize + kSmallSize, client_->GetWriteQueueStats().pending_bytes);
+  ReadAll(kLargeSize + kSmallWriteCount * kSmallSize);
+
+  const auto stats = client_->GetWriteQueueStats();
+  ASSERT_EQ(1u + kSmallWriteCount, stats.write_count);
+  ASSERT_EQ(0u, stats.rejected_count);
+}
+
+TEST_F(TestWriteQueue, RejectOverHighWaterMark) {
+  client_->SetWriteHighWaterMark(kLargeSize, WriteQueue::OverflowPolicy::Reject);
+  StartLargeWrite();
+  StartSmallWrites(WriteQueue::OverflowPolicy::Reject);
+  WaitFor([this] { return client_->GetWriteQueueStats().rejected_count == kSmallWriteCount; });
+  ReadAll(kLargeSize);
+
+  const auto stats = client_->GetWriteQueueStats();
+  ASSERT_EQ(1u, stats.write_count);
+  ASSERT_EQ(kLargeSize, stats.written_bytes);
+}
+
+TEST_F(TestWriteQueue, CancelInFlightWrite) {
+  std::atomic<std::size_t> received_size{0u};
+  RunAsync([this, &received_size] { received_size = client_->ReadPartial().first.GetSize(); },
+           GetNetworkSchedulerAccessorInstance().GetRef());
+  auto large_write_state = StartLargeWrite();
+  StartSmallWrites(WriteQueue::OverflowPolicy::Suspend);
+  WaitFor([this] { return client_->GetWriteQueueStats().queue_depth == kSmallWriteCount; });
+
+  ASSERT_TRUE(large_write_state.Cancel());
+  // Neither queued writers nor the pending read of the same socket are aborted
+  RunAsync([this] { ASSERT_FALSE(server_->Write(small_message_)); }, GetNetworkSchedulerAccessorInstance().GetRef());
+  WaitFor([&received_size] { return received_size != 0u; });
+  ASSERT_EQ(kSmallSize, received_size);
+  // Cancelled write completes with its batch, so the stream is not cut in the middle of it
+  ReadAll(kLargeSize + kSmallWriteCount * kSmallSize);
+
+  ASSERT_EQ(AsyncOpStatus::Cancelled, large_write_state.GetStatus());
+  const auto stats = client_->GetWriteQueueStats();
+  ASSERT_EQ(1u + kSmallWriteCount, stats.write_count);
+  ASSERT_EQ(kLargeSize + kSmallWriteCount * kSmallSize, stats.written_bytes);
+}
@@ -0,0 +1,106 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/fast_signal.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using rms::util::FastSignal;
+using rms::util::SignalConnection;
+
+TEST(TestFastSignal, CallsSlotsInConnectionOrder) {
+  FastSignal<void(std::vector<int>&, int)> signal;
+  ASSERT_TRUE(signal.IsEmpty());
+  signal.Connect([](std::vector<int>& calls, int value) { calls.push_back(value); });
+  signal.Connect([](std::vector<int>& calls, int value) { calls.push_back(value * 10); });
+  ASSERT_FALSE(signal.IsEmpty());
+
+  std::vector<int> calls;
+  signal(calls, 2);
+  ASSERT_EQ((std::vector<int>{2, 20}), calls);
+}
+
+TEST(TestFastSignal, Disconnect) {
+  FastSignal<void()> signal;
+  int first_count = 0;
+  int second_count = 0;
+  const auto first = signal.Connect([&] { ++first_count; });
+  const auto second = signal.Connect([&] { ++second_count; });
+  ASSERT_TRUE(first.IsConnected());
+
+  signal();
+  first.Disconnect();
+  ASSERT_FALSE(first.IsConnected());
+  ASSERT_TRUE(second.IsConnected());
+  signal();
+  second.Disconnect();
+  ASSERT_TRUE(signal.IsEmpty());
+  signal();
+
+  ASSERT_EQ(1, first_count);
+  ASSERT_EQ(2, second_count);
+}
+
+TEST(TestFastSignal, DisconnectWithinSlot) {
+  FastSignal<void()> signal;
+  int count = 0;
+  SignalConnection connection;
+  connection = signal.Connect([&] {
+    ++count;
+    connection.Disconnect();
+  });
+  signal();
+  signal();
+  ASSERT_EQ(1, count);
+}
+
+TEST(TestFastSignal, ConnectionOutlivesSignal) {
+  SignalConnection connection;
+  ASSERT_FALSE(connection.IsConnected());
+  connection.Disconnect();
+
+  auto value = std::make_shared<int>(0);
+  {
+    FastSignal<void()> signal;
+    connection = signal.Connect([value] { ++*value; });
+    ASSERT_TRUE(connection.IsConnected());
+    ASSERT_EQ(2, value.use_count());
+  }
+  // Slot is released with the signal
+  ASSERT_EQ(1, value.use_count());
+  ASSERT_FALSE(connection.IsConnected());
+  connection.Disconnect();
+}
+
+TEST(TestFastSignal, ConcurrentConnectAndEmit) {
+  const int thread_count = 4;
+  const int connects_per_thread = 100;
+  FastSignal<void(std::atomic_int&)> signal;
+  std::atomic_bool is_done{false};
+  std::atomic_int emitted_calls{0};
+  std::thread emitter([&] {
+    while (!is_done) {
+      signal(emitted_calls);
+    }
+  });
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < connects_per_thread; ++j) {
+        signal.Connect([](std::atomic_int& calls) { ++calls; });
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  is_done = true;
+  emitter.join();
+
+  std::atomic_int calls{0};
+  signal(calls);
+  ASSERT_EQ(thread_count * connects_per_thread, calls);
+}
@@ -0,0 +1,103 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/hdr_histogram.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using rms::util::HdrHistogram;
+
+TEST(TestHdrHistogram, Empty) {
+  HdrHistogram histogram{1000u};
+  ASSERT_EQ(0u, histogram.GetCount());
+  ASSERT_EQ(0u, histogram.GetMin());
+  ASSERT_EQ(0u, histogram.GetMax());
+  ASSERT_EQ(0.0, histogram.GetMean());
+  ASSERT_EQ(0u, histogram.GetValueAtPercentile(50.0));
+}
+
+TEST(TestHdrHistogram, SmallValuesAreExact) {
+  HdrHistogram histogram{1000u};
+  for (std::uint64_t value = 1u; value <= 100u; ++value) {
+    histogram.Record(value);
+  }
+  ASSERT_EQ(100u, histogram.GetCount());
+  ASSERT_EQ(1u, histogram.GetMin());
+  ASSERT_EQ(100u, histogram.GetMax());
+  ASSERT_DOUBLE_EQ(50.5, histogram.GetMean());
+  ASSERT_EQ(1u, histogram.GetValueAtPercentile(0.0));
+  ASSERT_EQ(50u, histogram.GetValueAtPercentile(50.0));
+  ASSERT_EQ(99u, histogram.GetValueAtPercentile(99.0));
+  ASSERT_EQ(100u, histogram.GetValueAtPercentile(100.0));
+}
+
+TEST(TestHdrHistogram, LargeValuesKeepRelativePrecision) {
+  const std::uint64_t highest_value = 3600u * 1000u * 1000u;
+  for (std::uint64_t value = 1000u; value <= highest_value; value *= 3u) {
+    HdrHistogram histogram{highest_value};
+    histogram.Record(value);
+    // Upper bound of the bucket, clamped by the max
+    histogram.Record(value + value / 128u);
+    const auto reported = histogram.GetValueAtPercentile(50.0);
+    ASSERT_GE(reported, value);
+    ASSERT_LE(reported - value, value / 64u);
+  }
+}
+
+TEST(TestHdrHistogram, Percentiles) {
+  HdrHistogram histogram{1000u * 1000u};
+  histogram.Record(1000u, 990u);
+  histogram.Record(100000u, 10u);
+  ASSERT_EQ(1000u, histogram.GetCount());
+  ASSERT_NEAR(1000.0, static_cast<double>(histogram.GetValueAtPercentile(50.0)), 1000.0 / 64.0);
+  ASSERT_NEAR(1000.0, static_cast<double>(histogram.GetValueAtPercentile(99.0)), 1000.0 / 64.0);
+  ASSERT_NEAR(100000.0, static_cast<double>(histogram.GetValueAtPercentile(99.9)), 100000.0 / 64.0);
+  ASSERT_EQ(100000u, histogram.GetMax());
+}
+
+TEST(TestHdrHistogram, ValuesOverHighestTrackableAreClamped) {
+  HdrHistogram histogram{1000u};
+  histogram.Record(5000u);
+  ASSERT_EQ(1u, histogram.GetCount());
+  ASSERT_EQ(5000u, histogram.GetMax());
+  ASSERT_LE(histogram.GetValueAtPercentile(100.0), 5000u);
+  ASSERT_GE(histogram.GetValueAtPercentile(100.0), 1000u);
+}
+
+TEST(TestHdrHistogram, AddAndReset) {
+  HdrHistogram first{1000u};
+  HdrHistogram second{1000u};
+  first.Record(10u);
+  second.Record(20u, 3u);
+  first.Add(second);
+  ASSERT_EQ(4u, first.GetCount());
+  ASSERT_EQ(10u, first.GetMin());
+  ASSERT_EQ(20u, first.GetMax());
+  ASSERT_DOUBLE_EQ(17.5, first.GetMean());
+  ASSERT_EQ(20u, first.GetValueAtPercentile(50.0));
+
+  first.Reset();
+  ASSERT_EQ(0u, first.GetCount());
+  ASSERT_EQ(0u, first.GetMax());
+}
+
+TEST(TestHdrHistogram, ConcurrentRecord) {
+  const int thread_count = 4;
+  const int records_per_thread = 10000;
+  HdrHistogram histogram{1000u * 1000u};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&histogram, i] {
+      for (int j = 0; j < records_per_thread; ++j) {
+        histogram.Record(static_cast<std::uint64_t>(i * records_per_thread + j));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(static_cast<std::uint64_t>(thread_count * records_per_thread), histogram.GetCount());
+  ASSERT_EQ(0u, histogram.GetMin());
+  ASSERT_EQ(static_cast<std::uint64_t>(thread_count * records_per_thread - 1), histogram.GetMax());
+}
@@ -0,0 +1,106 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/inplace_function.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <memory>
+#include <utility>
+
+using rms::util::InplaceFunction;
+
+namespace {
+
+class DestructionCounter {
+ public:
+  explicit DestructionCounter(int& counter) : counter_(&counter) {}
+
+  DestructionCounter(DestructionCounter&& other) noexcept : counter_(other.counter_) {
+    other.counter_ = nullptr;
+  }
+
+  ~DestructionCounter() {
+    if (counter_ != nullptr) {
+      ++*counter_;
+    }
+  }
+
+ private:
+  int* counter_;
+};
+
+}  // namespace
+
+TEST(TestInplaceFunction, EmptyByDefault) {
+  InplaceFunction<void()> function;
+  ASSERT_FALSE(function);
+  ASSERT_FALSE(function.IsInline());
+
+  InplaceFunction<void()> null_function = nullptr;
+  ASSERT_FALSE(null_function);
+}
+
+TEST(TestInplaceFunction, SmallCallableIsInline) {
+  int value = 0;
+  InplaceFunction<void()> function = [&value] { ++value; };
+  ASSERT_TRUE(function);
+  ASSERT_TRUE(function.IsInline());
+  function();
+  function();
+  ASSERT_EQ(2, value);
+}
+
+TEST(TestInplaceFunction, BigCallableIsOnHeap) {
+  std::array<char, 128> data{};
+  data[0] = 5;
+  InplaceFunction<int()> function = [data] { return data[0]; };
+  ASSERT_TRUE(function);
+  ASSERT_FALSE(function.IsInline());
+  ASSERT_EQ(5, function());
+
+  InplaceFunction<int(), 256u> big_function = [data] { return data[0]; };
+  ASSERT_TRUE(big_function.IsInline());
+  ASSERT_EQ(5, big_function());
+}
+
+TEST(TestInplaceFunction, ArgumentsAndResult) {
+  InplaceFunction<int(int, int)> function = [](int left, int right) { return left * right; };
+  ASSERT_EQ(12, function(3, 4));
+
+  InplaceFunction<void(std::unique_ptr<int>)> sink = [](std::unique_ptr<int> ptr) { ASSERT_EQ(7, *ptr); };
+  sink(std::make_unique<int>(7));
+}
+
+TEST(TestInplaceFunction, MoveOnlyCallable) {
+  auto ptr = std::make_unique<int>(42);
+  InplaceFunction<int()> function = [ptr = std::move(ptr)] { return *ptr; };
+  InplaceFunction<int()> moved = std::move(function);
+  ASSERT_FALSE(function);  // NOLINT
+  ASSERT_TRUE(moved);
+  ASSERT_EQ(42, moved());
+
+  InplaceFunction<int()> assigned;
+  assigned = std::move(moved);
+  ASSERT_FALSE(moved);  // NOLINT
+  ASSERT_EQ(42, assigned());
+}
+
+TEST(TestInplaceFunction, DestroysCallable) {
+  int destroyed = 0;
+  {
+    InplaceFunction<void()> function = [counter = DestructionCounter(destroyed)] {};
+    InplaceFunction<void()> moved = std::move(function);
+    ASSERT_EQ(0, destroyed);
+  }
+  ASSERT_EQ(1, destroyed);
+
+  std::array<char, 128> data{};
+  InplaceFunction<void()> heap_function = [counter = DestructionCounter(destroyed), data] {};
+  ASSERT_FALSE(heap_function.IsInline());
+  heap_function = nullptr;
+  ASSERT_FALSE(heap_function);
+  ASSERT_EQ(2, destroyed);
+
+  InplaceFunction<void()> function = [counter = DestructionCounter(destroyed)] {};
+  function = [] {};
+  ASSERT_EQ(3, destroyed);
+}
@@ -0,0 +1,93 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/metrics.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using rms::util::HdrHistogram;
+using rms::util::MetricCounter;
+using rms::util::MetricHistogram;
+using rms::util::MetricsRegistry;
+
+TEST(TestMetrics, CounterSumsThreads) {
+  MetricCounter counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&counter] {
+      for (int j = 0; j < 1000; ++j) {
+        counter.Increment();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  counter.Increment(10u);
+  ASSERT_EQ(4010u, counter.GetValue());
+}
+
+TEST(TestMetrics, HistogramMergesThreads) {
+  MetricHistogram histogram{1000u};
+  std::vector<std::thread> threads;
+  for (std::uint64_t i = 1u; i <= 4u; ++i) {
+    threads.emplace_back([&histogram, i] {
+      for (int j = 0; j < 100; ++j) {
+        histogram.Record(i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  HdrHistogram snapshot{1000u};
+  histogram.GetSnapshot(snapshot);
+  ASSERT_EQ(400u, snapshot.GetCount());
+  ASSERT_EQ(1000u, snapshot.GetSum());
+  ASSERT_EQ(1u, snapshot.GetMin());
+  ASSERT_EQ(4u, snapshot.GetMax());
+}
+
+TEST(TestMetrics, RegistryReturnsSameMetric) {
+  MetricsRegistry registry;
+  auto& counter = registry.GetCounter("requests_total", "Requests", {{"method", "get"}});
+  ASSERT_EQ(&counter, &registry.GetCounter("requests_total", "Requests", {{"method", "get"}}));
+  ASSERT_NE(&counter, &registry.GetCounter("requests_total", "Requests", {{"method", "put"}}));
+  auto& gauge = registry.GetGauge("connections", "Connections");
+  ASSERT_EQ(&gauge, &registry.GetGauge("connections", "Connections"));
+}
+
+TEST(TestMetrics, PrometheusText) {
+  MetricsRegistry registry;
+  registry.GetCounter("requests_total", "Handled requests", {{"method", "get"}}).Increment(3u);
+  registry.GetCounter("requests_total", "Handled requests", {{"method", "put"}}).Increment();
+  registry.GetGauge("connections", "Connected \"clients\"\nnow").Set(-2);
+  registry.SetGaugeCallback("queued", "Queued tasks", [] { return std::int64_t{7}; }, {{"pool", "a\"b"}});
+  auto& histogram = registry.GetHistogram("latency_us", "Latency", 1000u);
+  for (std::uint64_t value = 1u; value <= 100u; ++value) {
+    histogram.Record(value);
+  }
+
+  const std::string expected =
+      "# HELP connections Connected \"clients\"\\nnow\n"
+      "# TYPE connections gauge\n"
+      "connections -2\n"
+      "# HELP latency_us Latency\n"
+      "# TYPE latency_us summary\n"
+      "latency_us{quantile=\"0.5\"} 50\n"
+      "latency_us{quantile=\"0.9\"} 90\n"
+      "latency_us{quantile=\"0.99\"} 99\n"
+      "latency_us{quantile=\"0.999\"} 100\n"
+      "latency_us_sum 5050\n"
+      "latency_us_count 100\n"
+      "# HELP queued Queued tasks\n"
+      "# TYPE queued gauge\n"
+      "queued{pool=\"a\\\"b\"} 7\n"
+      "# HELP requests_total Handled requests\n"
+      "# TYPE requests_total counter\n"
+      "requests_total{method=\"get\"} 3\n"
+      "requests_total{method=\"put\"} 1\n";
+  ASSERT_EQ(expected, registry.FormatPrometheusText());
+}
@@ -0,0 +1,77 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/sharded_counter.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using rms::util::ShardedCounter;
+using rms::util::ShardedCounterSlot;
+
+namespace {
+
+class IncrementDecrementTag;
+class CrossThreadTag;
+class ManyThreadsTag;
+
+}  // namespace
+
+TEST(TestShardedCounter, IncrementDecrement) {
+  using Counter = ShardedCounter<IncrementDecrementTag>;
+  ASSERT_EQ(0, Counter::GetCount());
+
+  auto& first = Counter::Increment();
+  auto& second = Counter::Increment();
+  ASSERT_EQ(&first, &second);
+  ASSERT_EQ(2, Counter::GetCount());
+
+  ASSERT_FALSE(Counter::Decrement(first));
+  ASSERT_EQ(1, Counter::GetCount());
+  ASSERT_TRUE(Counter::Decrement(second));
+  ASSERT_EQ(0, Counter::GetCount());
+}
+
+TEST(TestShardedCounter, DecrementOnAnotherThread) {
+  using Counter = ShardedCounter<CrossThreadTag>;
+  ShardedCounterSlot* slot = nullptr;
+  std::thread([&slot] { slot = &Counter::Increment(); }).join();
+  ASSERT_EQ(1, Counter::GetCount());
+
+  // Slot outlives its owner thread
+  ASSERT_TRUE(Counter::Decrement(*slot));
+  ASSERT_EQ(0, Counter::GetCount());
+}
+
+TEST(TestShardedCounter, ManyThreads) {
+  using Counter = ShardedCounter<ManyThreadsTag>;
+  const int thread_count = 8;
+  const int count_per_thread = 1000;
+  std::vector<ShardedCounterSlot*> slots(thread_count * count_per_thread, nullptr);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&slots, i] {
+      for (int j = 0; j < count_per_thread; ++j) {
+        slots[i * count_per_thread + j] = &Counter::Increment();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(thread_count * count_per_thread, Counter::GetCount());
+
+  threads.clear();
+  for (int i = 0; i < thread_count; ++i) {
+    // Decrement values counted by another thread
+    threads.emplace_back([&slots, i] {
+      const int other = (i + 1) % thread_count;
+      for (int j = 0; j < count_per_thread; ++j) {
+        Counter::Decrement(*slots[other * count_per_thread + j]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, Counter::GetCount());
+}
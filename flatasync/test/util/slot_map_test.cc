@@ -0,0 +1,125 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/slot_map.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+using rms::util::SlotMap;
+
+TEST(TestSlotMap, InsertFindErase) {
+  SlotMap<int> slot_map{4u};
+  ASSERT_EQ(0u, slot_map.GetSize());
+  ASSERT_EQ(4u, slot_map.GetCapacity());
+
+  const auto first = slot_map.Insert(10);
+  const auto second = slot_map.Insert(20);
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  // First id is 1, ids are never 0
+  ASSERT_EQ(1u, *first);
+  ASSERT_NE(*first, *second);
+  ASSERT_EQ(2u, slot_map.GetSize());
+
+  ASSERT_NE(nullptr, slot_map.Find(*first));
+  ASSERT_EQ(10, *slot_map.Find(*first));
+  ASSERT_EQ(20, *slot_map.Find(*second));
+  ASSERT_EQ(nullptr, slot_map.Find(0u));
+  ASSERT_EQ(nullptr, slot_map.Find(100u));
+
+  const auto erased = slot_map.Erase(*first);
+  ASSERT_TRUE(erased);
+  ASSERT_EQ(10, *erased);
+  ASSERT_EQ(1u, slot_map.GetSize());
+  ASSERT_EQ(nullptr, slot_map.Find(*first));
+  ASSERT_FALSE(slot_map.Erase(*first));
+}
+
+TEST(TestSlotMap, StaleIdDoesNotHitReusedSlot) {
+  SlotMap<int> slot_map{1u};
+  const auto stale = slot_map.Insert(1);
+  ASSERT_TRUE(stale);
+  ASSERT_TRUE(slot_map.Erase(*stale));
+
+  const auto reused = slot_map.Insert(2);
+  ASSERT_TRUE(reused);
+  ASSERT_NE(*stale, *reused);
+  ASSERT_EQ(nullptr, slot_map.Find(*stale));
+  ASSERT_FALSE(slot_map.Erase(*stale));
+  ASSERT_EQ(2, *slot_map.Find(*reused));
+}
+
+TEST(TestSlotMap, Capacity) {
+  SlotMap<int> slot_map{2u};
+  const auto first = slot_map.Insert(1);
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(slot_map.Insert(2));
+  ASSERT_FALSE(slot_map.Insert(3));
+  ASSERT_EQ(2u, slot_map.GetSize());
+
+  ASSERT_TRUE(slot_map.Erase(*first));
+  ASSERT_TRUE(slot_map.Insert(3));
+  ASSERT_FALSE(slot_map.Insert(4));
+}
+
+TEST(TestSlotMap, EraseReleasesValue) {
+  SlotMap<std::shared_ptr<int>> slot_map{1u};
+  auto value = std::make_shared<int>(1);
+  const auto id = slot_map.Insert(value);
+  ASSERT_TRUE(id);
+  ASSERT_EQ(2, value.use_count());
+
+  auto erased = slot_map.Erase(*id);
+  ASSERT_TRUE(erased);
+  ASSERT_EQ(value, *erased);
+  erased = boost::none;
+  ASSERT_EQ(1, value.use_count());
+}
+
+TEST(TestSlotMap, ForEach) {
+  SlotMap<int> slot_map{8u};
+  std::vector<SlotMap<int>::IdType> ids;
+  for (int i = 0; i < 8; ++i) {
+    ids.push_back(*slot_map.Insert(i));
+  }
+  slot_map.Erase(ids[3]);
+  slot_map.Erase(ids[5]);
+
+  std::set<SlotMap<int>::IdType> visited;
+  int sum = 0;
+  slot_map.ForEach([&](SlotMap<int>::IdType id, int& value) {
+    visited.insert(id);
+    sum += value;
+  });
+  ASSERT_EQ(6u, visited.size());
+  ASSERT_EQ(0u, visited.count(ids[3]));
+  ASSERT_EQ(0u, visited.count(ids[5]));
+  ASSERT_EQ(28 - 3 - 5, sum);
+}
+
+TEST(TestSlotMap, SetCapacity) {
+  SlotMap<int> slot_map{3u};
+  std::vector<SlotMap<int>::IdType> ids;
+  for (int i = 0; i < 3; ++i) {
+    ids.push_back(*slot_map.Insert(i));
+  }
+
+  // Values over the lowered capacity are kept, inserts fail until size drops below it
+  slot_map.SetCapacity(1u);
+  ASSERT_EQ(1u, slot_map.GetCapacity());
+  ASSERT_EQ(3u, slot_map.GetSize());
+  ASSERT_EQ(2, *slot_map.Find(ids[2]));
+  ASSERT_TRUE(slot_map.Erase(ids[0]));
+  ASSERT_FALSE(slot_map.Insert(3));
+  ASSERT_TRUE(slot_map.Erase(ids[1]));
+  ASSERT_FALSE(slot_map.Insert(3));
+  ASSERT_TRUE(slot_map.Erase(ids[2]));
+  ASSERT_TRUE(slot_map.Insert(3));
+
+  slot_map.SetCapacity(4u);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(slot_map.Insert(i));
+  }
+  ASSERT_FALSE(slot_map.Insert(4));
+}
@@ -0,0 +1,56 @@
+// Copyright [2018] <Malinovsky Rodion>
+
+#include "util/thread_local_pool.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using rms::util::ThreadLocalPool;
+
+namespace {
+
+struct Item {
+  char data[40];
+};
+
+using PoolType = ThreadLocalPool<Item, 4u>;
+
+}  // namespace
+
+TEST(TestThreadLocalPool, ReusesReleasedBlock) {
+  PoolType::ReleaseCached();
+  void* ptr = PoolType::Allocate();
+  PoolType::Deallocate(ptr);
+  ASSERT_EQ(1u, PoolType::GetCachedCount());
+  ASSERT_EQ(ptr, PoolType::Allocate());
+  ASSERT_EQ(0u, PoolType::GetCachedCount());
+  PoolType::Deallocate(ptr);
+  PoolType::Deallocate(nullptr);
+  ASSERT_EQ(1u, PoolType::GetCachedCount());
+  PoolType::ReleaseCached();
+  ASSERT_EQ(0u, PoolType::GetCachedCount());
+}
+
+TEST(TestThreadLocalPool, CacheIsCapped) {
+  PoolType::ReleaseCached();
+  std::vector<void*> blocks;
+  for (int i = 0; i < 10; ++i) {
+    blocks.push_back(PoolType::Allocate());
+  }
+  for (auto* block : blocks) {
+    PoolType::Deallocate(block);
+  }
+  ASSERT_EQ(4u, PoolType::GetCachedCount());
+  PoolType::ReleaseCached();
+}
+
+TEST(TestThreadLocalPool, BlockMigratesToReleasingThread) {
+  PoolType::ReleaseCached();
+  void* ptr = PoolType::Allocate();
+  std::thread thread([ptr] {
+    PoolType::Deallocate(ptr);
+    ASSERT_EQ(1u, PoolType::GetCachedCount());
+  });
+  thread.join();
+  ASSERT_EQ(0u, PoolType::GetCachedCount());
+}